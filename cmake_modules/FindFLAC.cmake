@@ -0,0 +1,41 @@
+if(WIN32)
+	find_path(
+		FLAC_INCLUDE_DIR
+		FLAC/stream_decoder.h
+		C:/flac/include
+	)
+
+	find_library(
+		FLAC_LIBRARY
+		NAMES FLAC
+		PATHS
+		C:/flac/lib
+	)
+else(WIN32)
+	find_path(
+		FLAC_INCLUDE_DIR
+		FLAC/stream_decoder.h
+		/usr/include
+		/usr/local/include
+	)
+
+	find_library(
+		FLAC_LIBRARY
+		NAMES FLAC
+		PATHS
+		/usr/lib
+		/usr/local/lib
+	)
+endif(WIN32)
+
+if(FLAC_INCLUDE_DIR AND FLAC_LIBRARY)
+	set(FLAC_FOUND "YES")
+else(FLAC_INCLUDE_DIR AND FLAC_LIBRARY)
+	set(FLAC_FOUND "NO")
+endif(FLAC_INCLUDE_DIR AND FLAC_LIBRARY)
+
+if(FLAC_FOUND)
+	message(STATUS "Found FLAC: ${FLAC_LIBRARY}")
+else(FLAC_FOUND)
+	message(STATUS "Could not find FLAC")
+endif(FLAC_FOUND)
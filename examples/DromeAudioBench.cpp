@@ -0,0 +1,307 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <DromeAudio/DromeAudio>
+#include <DromeAudio/WavSound.h>
+#ifdef WITH_FLAC
+	#include <DromeAudio/FlacSound.h>
+#endif /* WITH_FLAC */
+
+using namespace DromeAudio;
+
+static const unsigned int SAMPLE_RATE = 44100;
+static const unsigned int BLOCK_SIZE = 256;
+
+struct Result {
+	std::string name;
+	double nsPerFrame;
+	double voicesPerCore; // 0 if not applicable
+	double megabytesPerSecond; // 0 if not applicable
+};
+
+static std::vector <Result> results;
+
+static void
+printUsageMessage(const char *executableName)
+{
+	fprintf(stderr, "Usage: %s [-s seconds] [-o output.json] [-v file.ogg] [-f file.flac]\n", executableName);
+	fprintf(stderr, "  -s  seconds of audio processed by each benchmark (default 10)\n");
+	fprintf(stderr, "  -o  file to write the JSON results to (default stdout)\n");
+	fprintf(stderr, "  -v  Ogg Vorbis file to measure decoding throughput with\n");
+	fprintf(stderr, "  -f  FLAC file to measure decoding and compressed playback with\n");
+}
+
+static double
+now()
+{
+	return std::chrono::duration <double, std::nano> (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void
+addResult(const std::string &name, double elapsed, uint64_t numFrames, unsigned int numVoices, size_t numBytes)
+{
+	Result result;
+	result.name = name;
+	result.nsPerFrame = elapsed / (double)numFrames;
+
+	// voices that one core could keep playing in real time
+	result.voicesPerCore = 0.0;
+	if(numVoices != 0)
+		result.voicesPerCore = (1e9 / SAMPLE_RATE) / result.nsPerFrame * numVoices;
+
+	result.megabytesPerSecond = 0.0;
+	if(numBytes != 0)
+		result.megabytesPerSecond = ((double)numBytes / (1024.0 * 1024.0)) / (elapsed / 1e9);
+
+	results.push_back(result);
+	fprintf(stderr, "%-32s %10.2f ns/frame\n", name.c_str(), result.nsPerFrame);
+}
+
+/*
+ * benchmarks
+ */
+static void
+benchmarkMix(const char *name, const SoundPtr &sound, unsigned int numEmitters, uint64_t numFrames)
+{
+	AudioDriverNull driver(SAMPLE_RATE, 2, 1024);
+	AudioContext context(SAMPLE_RATE, numEmitters + 16);
+	driver.setAudioContext(&context);
+
+	for(unsigned int i = 0; i < numEmitters; i++) {
+		SoundEmitterPtr emitter = context.playSound(sound);
+		emitter->setSampleIndex(i * 97);
+	}
+
+	// apply the attach requests before timing
+	driver.render(driver.getPeriodSize());
+
+	double start = now();
+	driver.render(numFrames);
+	double elapsed = now() - start;
+
+	char buffer[128];
+	snprintf(buffer, sizeof(buffer), "mix/%s/%u", name, numEmitters);
+	addResult(buffer, elapsed, numFrames, numEmitters, 0);
+
+	driver.setAudioContext(NULL);
+}
+
+static void
+benchmarkSound(const std::string &name, const SoundPtr &sound, uint64_t numFrames)
+{
+	Sample samples[BLOCK_SIZE];
+
+	double start = now();
+	for(uint64_t i = 0; i < numFrames; i += BLOCK_SIZE)
+		sound->getSamples((unsigned int)i, samples, BLOCK_SIZE);
+	double elapsed = now() - start;
+
+	addResult(name, elapsed, numFrames, 1, 0);
+}
+
+typedef SoundPtr (*LoadFunction)(const char *filename);
+
+static SoundPtr
+loadSound(const char *filename)
+{
+	return Sound::create(filename);
+}
+
+static SoundPtr
+loadMappedWavSound(const char *filename)
+{
+	return WavSound::create(filename, true);
+}
+
+static SoundPtr
+loadLazySound(const char *filename)
+{
+	return LazySound::create(filename);
+}
+
+#ifdef WITH_FLAC
+static SoundPtr
+loadFlacSoundParallel(const char *filename)
+{
+	return FlacSound::create(filename, false, ThreadPool::getShared());
+}
+
+static SoundPtr
+loadFlacSoundCompressed(const char *filename)
+{
+	// the benchmark reads samples faster than they'd be played, so
+	// frames are decoded on the reading thread instead of missed
+	FlacSoundPtr sound = FlacSound::create(filename, true);
+	sound->setBlocking(true);
+	return sound;
+}
+#endif /* WITH_FLAC */
+
+static void
+benchmarkDecode(const char *name, LoadFunction load, const char *filename, unsigned int numRuns)
+{
+	FILE *fp = fopen(filename, "rb");
+	if(!fp)
+		throw Exception("Unable to open %s", filename);
+	fseek(fp, 0, SEEK_END);
+	size_t fileSize = (size_t)ftell(fp);
+	fclose(fp);
+
+	uint64_t numFrames = 0;
+
+	double start = now();
+	for(unsigned int i = 0; i < numRuns; i++) {
+		SoundPtr sound = load(filename);
+		numFrames += sound->getNumSamples();
+	}
+	double elapsed = now() - start;
+
+	addResult(std::string("decode/") + name, elapsed, numFrames, 0, fileSize * numRuns);
+}
+
+static void
+benchmarkSave(const char *name, SoundPtr sound, const char *filename, unsigned int numFrames, SampleFormat format, bool dither)
+{
+	double start = now();
+	sound->save(filename, numFrames, format, dither);
+	double elapsed = now() - start;
+
+	size_t numBytes = (size_t)numFrames * 2 * SampleFormatGetSize(format);
+	addResult(std::string("save/") + name, elapsed, numFrames, 0, numBytes);
+}
+
+static void
+writeResults(FILE *fp, double seconds)
+{
+	fprintf(fp, "{\n");
+	fprintf(fp, "\t\"sample_rate\": %u,\n", SAMPLE_RATE);
+	fprintf(fp, "\t\"seconds\": %g,\n", seconds);
+	fprintf(fp, "\t\"results\": [\n");
+
+	for(unsigned int i = 0; i < results.size(); i++) {
+		const Result &result = results[i];
+
+		fprintf(fp, "\t\t{ \"name\": \"%s\", \"ns_per_frame\": %.3f", result.name.c_str(), result.nsPerFrame);
+		if(result.voicesPerCore != 0.0)
+			fprintf(fp, ", \"voices_per_core\": %.1f", result.voicesPerCore);
+		if(result.megabytesPerSecond != 0.0)
+			fprintf(fp, ", \"mb_per_s\": %.2f", result.megabytesPerSecond);
+		fprintf(fp, " }%s\n", (i + 1 < results.size()) ? "," : "");
+	}
+
+	fprintf(fp, "\t]\n");
+	fprintf(fp, "}\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+	double seconds = 10.0;
+	const char *outputFilename = NULL;
+	const char *vorbisFilename = NULL;
+	const char *flacFilename = NULL;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+			seconds = atof(argv[++i]);
+		} else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			outputFilename = argv[++i];
+		} else if(strcmp(argv[i], "-v") == 0 && i + 1 < argc) {
+			vorbisFilename = argv[++i];
+		} else if(strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			flacFilename = argv[++i];
+		} else {
+			printUsageMessage(argv[0]);
+			return 1;
+		}
+	}
+
+	if(seconds <= 0.0) {
+		printUsageMessage(argv[0]);
+		return 1;
+	}
+
+	uint64_t numFrames = (uint64_t)(seconds * SAMPLE_RATE);
+	const char *wavFilename = "DromeAudioBench.tmp.wav";
+
+	try {
+		// the WAV file used by the other benchmarks is written by
+		// Sound::save(), so it's measured first
+		SoundPtr sine = SineSound::create(440.0f);
+		benchmarkSave("wav16", sine, wavFilename, SAMPLE_RATE * 10, SAMPLE_FORMAT_INT16, false);
+		SoundPtr wav = Sound::create(wavFilename);
+
+		// the other output formats, which aren't read back
+		const char *saveFilename = "DromeAudioBench.save.tmp.wav";
+		benchmarkSave("wav16-dither", sine, saveFilename, SAMPLE_RATE * 10, SAMPLE_FORMAT_INT16, true);
+		benchmarkSave("wav24", sine, saveFilename, SAMPLE_RATE * 10, SAMPLE_FORMAT_INT24, false);
+		benchmarkSave("float", sine, saveFilename, SAMPLE_RATE * 10, SAMPLE_FORMAT_FLOAT32, false);
+		remove(saveFilename);
+
+		// mixing, at the context's rate, resampled and from ADPCM
+		SoundPtr resampled = BufferSound::create(wav, 22050);
+		SoundPtr adpcm = AdpcmSound::create(wav);
+		const unsigned int numEmitters[] = { 1, 16, 64, 256 };
+		for(unsigned int i = 0; i < sizeof(numEmitters) / sizeof(numEmitters[0]); i++) {
+			uint64_t n = numFrames / numEmitters[i] + BLOCK_SIZE;
+			benchmarkMix("native", wav, numEmitters[i], n);
+			benchmarkMix("resampled", resampled, numEmitters[i], n);
+			benchmarkMix("adpcm", adpcm, numEmitters[i], n);
+		}
+
+		// decoding
+		benchmarkDecode("wav", loadSound, wavFilename, 10);
+		benchmarkDecode("wav-mapped", loadMappedWavSound, wavFilename, 10);
+		benchmarkDecode("wav-lazy", loadLazySound, wavFilename, 10);
+		if(vorbisFilename)
+			benchmarkDecode("vorbis", loadSound, vorbisFilename, 3);
+		if(flacFilename) {
+			benchmarkDecode("flac", loadSound, flacFilename, 3);
+#ifdef WITH_FLAC
+			benchmarkDecode("flac-parallel", loadFlacSoundParallel, flacFilename, 3);
+			benchmarkDecode("flac-compressed", loadFlacSoundCompressed, flacFilename, 3);
+
+			// playback cost of decoding frames as they're played
+			benchmarkSound("flac/decoded", Sound::create(flacFilename), numFrames);
+			benchmarkSound("flac/compressed", loadFlacSoundCompressed(flacFilename), numFrames);
+#endif /* WITH_FLAC */
+		}
+
+		// generators
+		benchmarkSound("generator/sine", sine, numFrames);
+		benchmarkSound("generator/saw", SawSound::create(440.0f), numFrames);
+		benchmarkSound("generator/square", SquareSound::create(440.0f), numFrames);
+		benchmarkSound("generator/noise", NoiseSound::create(), numFrames);
+
+		// effects
+		benchmarkSound("effect/pitchshift", PitchShiftSoundEffect::create(wav, 1.5f), numFrames);
+		benchmarkSound("effect/oscillator", OscillatorSoundEffect::create(wav, 5.0f), numFrames);
+		benchmarkSound("effect/echo", EchoSoundEffect::create(wav, 0.25f, 0.5f, 4), numFrames);
+	} catch(Exception ex) {
+		// the exception's message has already been printed
+		remove(wavFilename);
+		return 1;
+	}
+
+	remove(wavFilename);
+
+	// write results
+	FILE *fp = stdout;
+	if(outputFilename) {
+		fp = fopen(outputFilename, "w");
+		if(!fp) {
+			fprintf(stderr, "Unable to open %s for writing\n", outputFilename);
+			return 1;
+		}
+	}
+
+	writeResults(fp, seconds);
+
+	if(fp != stdout)
+		fclose(fp);
+
+	return 0;
+}
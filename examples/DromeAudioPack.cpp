@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <dirent.h>
+	#include <sys/stat.h>
+#endif /* _WIN32 */
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/SoundBank.h>
+#include <DromeAudio/Util.h>
+
+using namespace DromeAudio;
+
+static void
+printUsageMessage(const char *executableName)
+{
+	fprintf(stderr, "Usage: %s <output.bank> <directory> [directory...]\n", executableName);
+	fprintf(stderr, "       %s -l <input.bank>\n", executableName);
+	fprintf(stderr, "Packs the .wav, .ogg and .flac files found in the directories (and their\n");
+	fprintf(stderr, "subdirectories) into a sound bank, or lists the sounds in a bank.\n");
+	fprintf(stderr, "Sounds are named by their path relative to their directory.\n");
+}
+
+static bool
+isSoundFile(const std::string &filename)
+{
+	size_t dot = filename.rfind('.');
+	if(dot == std::string::npos)
+		return false;
+
+	const char *extension = filename.c_str() + dot;
+	return (StrCaseCmp(extension, ".wav") == 0 || StrCaseCmp(extension, ".ogg") == 0 || StrCaseCmp(extension, ".flac") == 0);
+}
+
+/*
+ * Adds the sound files in a directory and its subdirectories to the
+ * lists, naming each by its path relative to the directory given on
+ * the command line (prefix).
+ */
+static void
+findSounds(const std::string &directory, const std::string &prefix, std::vector <std::string> &names, std::vector <std::string> &filenames)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &data);
+	if(find == INVALID_HANDLE_VALUE)
+		throw Exception("Unable to read directory %s", directory.c_str());
+
+	do {
+		std::string name = data.cFileName;
+		if(name == "." || name == "..")
+			continue;
+
+		std::string path = directory + "\\" + name;
+		if(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			findSounds(path, prefix + name + "/", names, filenames);
+		} else if(isSoundFile(name)) {
+			names.push_back(prefix + name);
+			filenames.push_back(path);
+		}
+	} while(FindNextFileA(find, &data));
+
+	FindClose(find);
+#else
+	DIR *dir = opendir(directory.c_str());
+	if(!dir)
+		throw Exception("Unable to read directory %s", directory.c_str());
+
+	while(struct dirent *entry = readdir(dir)) {
+		std::string name = entry->d_name;
+		if(name == "." || name == "..")
+			continue;
+
+		std::string path = directory + "/" + name;
+		struct stat st;
+		if(stat(path.c_str(), &st) != 0)
+			continue;
+
+		if(S_ISDIR(st.st_mode)) {
+			findSounds(path, prefix + name + "/", names, filenames);
+		} else if(isSoundFile(name)) {
+			names.push_back(prefix + name);
+			filenames.push_back(path);
+		}
+	}
+
+	closedir(dir);
+#endif /* _WIN32 */
+}
+
+static const char *
+getFormatName(const SoundPtr &sound)
+{
+	unsigned int bytesPerSample = (unsigned int)(sound->getDataSize() / sound->getNumSamples() / sound->getNumChannels());
+	switch(bytesPerSample) {
+		case 1:
+			return "8-bit";
+		case 2:
+			return "16-bit";
+		case 3:
+			return "24-bit";
+		default:
+			return "32-bit";
+	}
+}
+
+static int
+listBank(const char *filename)
+{
+	SoundBankPtr bank;
+	try {
+		bank = SoundBank::create(filename);
+	} catch(Exception ex) {
+		fprintf(stderr, "Couldn't open %s\n", filename);
+		return 1;
+	}
+
+	for(unsigned int i = 0; i < bank->getNumSounds(); i++) {
+		SoundPtr sound = bank->getSound(i);
+		printf("%-48s %u ch, %u Hz, %s, %.2f s\n", bank->getName(i).c_str(),
+		       sound->getNumChannels(), sound->getSampleRate(), getFormatName(sound),
+		       (double)sound->getNumSamples() / (double)sound->getSampleRate());
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+	if(argc == 3 && strcmp(argv[1], "-l") == 0)
+		return listBank(argv[2]);
+
+	if(argc < 3 || argv[1][0] == '-') {
+		printUsageMessage(argv[0]);
+		return 1;
+	}
+
+	// find sounds, sorted by name so that banks built from the same
+	// files are identical
+	std::vector <std::string> names;
+	std::vector <std::string> filenames;
+	try {
+		for(int i = 2; i < argc; i++) {
+			std::vector <std::string> dirNames, dirFilenames;
+			findSounds(argv[i], "", dirNames, dirFilenames);
+			names.insert(names.end(), dirNames.begin(), dirNames.end());
+			filenames.insert(filenames.end(), dirFilenames.begin(), dirFilenames.end());
+		}
+	} catch(Exception ex) {
+		// the exception's message has already been printed
+		return 1;
+	}
+
+	std::vector <size_t> order(names.size());
+	for(size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&names](size_t a, size_t b) { return names[a] < names[b]; });
+
+	std::vector <std::string> sortedNames, sortedFilenames;
+	for(size_t i = 0; i < order.size(); i++) {
+		sortedNames.push_back(names[order[i]]);
+		sortedFilenames.push_back(filenames[order[i]]);
+	}
+
+	// pack
+	try {
+		SoundBank::pack(argv[1], sortedNames, sortedFilenames);
+	} catch(Exception ex) {
+		return 1;
+	}
+
+	fprintf(stderr, "Packed %u sounds into %s\n", (unsigned int)sortedNames.size(), argv[1]);
+	return 0;
+}
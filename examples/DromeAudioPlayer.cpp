@@ -2,6 +2,7 @@
 #include <cstring>
 #include <DromeAudio/AudioContext.h>
 #include <DromeAudio/AudioDriver.h>
+#include <DromeAudio/ChannelLayout.h>
 #include <DromeAudio/Exception.h>
 
 using namespace DromeAudio;
@@ -31,10 +32,15 @@ main(int argc, char *argv[])
 		return 1;
 	}
 
-	// create driver
+	// create driver, with as many channels as the sound has if it
+	// has more than two and the device supports them
+	unsigned int numChannels = sound->getNumChannels();
+	if(numChannels < 2 || numChannels > MAX_CHANNELS)
+		numChannels = 2;
+
 	AudioDriver *driver;
 	try {
-		driver = AudioDriver::create();
+		driver = AudioDriver::create(numChannels);
 	} catch(Exception ex) {
 		fprintf(stderr, "Audio driver initialization failed\n");
 		return 1;
@@ -43,15 +49,17 @@ main(int argc, char *argv[])
 	printf("Using driver: %s\n", driver->getDriverName());
 
 	// create context
-	AudioContext *context = new AudioContext(driver->getSampleRate());
+	AudioContext *context = new AudioContext(driver->getSampleRate(), 1024, driver->getNumChannels());
+	context->setCompletionReporting(true);
 	driver->setAudioContext(context);
 
 	printf("Playing %s\n", filename);
 
-	// create sound emitter and loop until it's done playing
+	// create sound emitter and wait until it's done playing,
+	// updating the displayed position every quarter second
 	SoundEmitterPtr emitter = context->playSound(sound);
 	emitter->setLoop(false);
-	while(emitter->isDone() == false) {
+	while(!context->getCompletedSoundEmitter(250)) {
 		unsigned int currentSecond = emitter->getSampleIndex() / emitter->getSampleRate();
 		unsigned int numSeconds = emitter->getSound()->getNumSamples() / emitter->getSound()->getSampleRate();
 
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_ADPCMSOUND_H__
+#define __DROMEAUDIO_ADPCMSOUND_H__
+
+#include <DromeAudio/Sound.h>
+
+namespace DromeAudio {
+
+class AdpcmSound;
+typedef RefPtr <AdpcmSound> AdpcmSoundPtr;
+
+/** \brief A sound stored in memory as IMA ADPCM, which takes about a quarter of the memory of 16-bit samples.
+ *
+ * Sounds are compressed when they're created and decoded as they're played, in independent blocks of 256 samples, so playing from any position only decodes the block containing it. Decoding is cheap but lossy, which suits sound effects better than music; AudioContext's conversion cache will still store a full copy of the sound if its sample rate differs from the context's.
+ */
+class AdpcmSound : public Sound
+{
+	protected:
+		unsigned char m_numChannels;
+		unsigned int m_sampleRate;
+		unsigned int m_numSamples;
+		unsigned int m_numBlocks;
+
+		// m_numBlocks groups of one block for each channel
+		uint8_t *m_data;
+		size_t m_dataSize;
+
+		AdpcmSound(const SoundPtr &sound);
+		virtual ~AdpcmSound();
+
+		void decodeBlock(unsigned int block, unsigned int numSamples, int16_t *samples) const;
+
+	public:
+		unsigned char getNumChannels() const;
+		unsigned int getSampleRate() const;
+		unsigned int getNumSamples() const;
+		size_t getDataSize() const;
+
+		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
+		void getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const;
+
+		/**
+		 * Creates an AdpcmSound by compressing all of another sound's samples, e.g. a WavSound or VorbisSound that can be released afterwards.
+		 * @param sound Sound to compress. Its number of samples must not be 0, and it must have at most MAX_CHANNELS channels.
+		 * @return AdpcmSoundPtr to the new sound.
+		 */
+		static AdpcmSoundPtr create(const SoundPtr &sound);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_ADPCMSOUND_H__ */
@@ -26,57 +26,220 @@
 #ifndef __DROMEAUDIO_AUDIOCONTEXT_H__
 #define __DROMEAUDIO_AUDIOCONTEXT_H__
 
+#include <atomic>
+#include <cstddef>
 #include <vector>
-#include <DromeAudio/Mutex.h>
 #include <DromeAudio/AudioDriver.h>
+#include <DromeAudio/LockFreeQueue.h>
+#include <DromeAudio/Mutex.h>
+#include <DromeAudio/Semaphore.h>
 #include <DromeAudio/SoundEmitter.h>
+#include <DromeAudio/Thread.h>
 
 namespace DromeAudio {
 
 /** \brief Keeps track of SoundEmitter objects and mixes their samples.
+ *
+ * Attaching and detaching emitters never blocks. Requests are added to a lock-free queue and applied by the thread calling writeSamples() (usually the audio driver's thread) at the start of the next period, so the list of attached emitters is only touched by that thread.
+ *
+ * Emitters that finish playing are detached automatically at the end of the period. If completion reporting is turned on with setCompletionReporting(), they're handed back through a second queue, which can be polled, waited on or dispatched to a callback with getCompletedSoundEmitter() and dispatchCompletedSoundEmitters(). Otherwise they're released like detached emitters, so applications that never collect them don't keep their sounds alive.
+ *
+ * The audio thread never drops what could be the last reference to an emitter or sound. Emitters it lets go of, and sounds replaced with SoundEmitter::setSound() while playing, are passed to a housekeeping thread owned by the context, so a sound's data is never freed in the middle of a period.
+ *
+ * Optionally, sounds can be converted to the context's sample rate once, when they're preloaded, and the converted copies cached and shared by every emitter playing them. See setConversionCacheBudget().
  */
 class AudioContext
 {
+	public:
+		typedef void (*CompletionCallback)(const SoundEmitterPtr &emitter, void *userData);
+
 	protected:
-		Mutex *m_mutex;
+		struct Command {
+			enum Type {
+				ATTACH,
+				DETACH
+			};
+
+			Type type;
+			SoundEmitterPtr emitter;
+			uint64_t startTime;
+		};
+
+		// an emitter or a sound replaced by SoundEmitter::setSound()
+		struct Garbage {
+			SoundEmitterPtr emitter;
+			SoundPtr sound;
+			size_t dataSize;
+		};
+
+		struct ConversionCacheEntry {
+			SoundPtr sound;
+			SoundPtr convertedSound;
+			unsigned int sampleRate;
+			uint64_t lastUsed;
+		};
+
 		unsigned int m_targetSampleRate;
+		unsigned int m_numChannels;
+		std::atomic <uint64_t> m_sampleTime;
 		std::vector <SoundEmitterPtr> m_emitters;
+		LockFreeQueue <Command> m_commands;
+		LockFreeQueue <SoundEmitterPtr> m_completed;
+		Semaphore *m_completedSemaphore;
+		std::atomic <bool> m_completionReporting;
+
+		LockFreeQueue <Garbage> m_garbage;
+		Semaphore *m_garbageSemaphore;
+
+		// garbage that didn't fit in the queue, only touched by the
+		// audio thread and pushed again at the start of each period
+		std::vector <Garbage> m_garbageOverflow;
+		Thread *m_garbageThread;
+		std::atomic <bool> m_running;
+		std::atomic <unsigned int> m_numPendingReleases;
+		std::atomic <size_t> m_pendingReleaseDataSize;
+
+		Mutex *m_conversionCacheMutex;
+		std::vector <ConversionCacheEntry> m_conversionCache;
+		size_t m_conversionCacheSize;
+		size_t m_conversionCacheBudget;
+		uint64_t m_conversionCacheClock;
+
+		void pushCommand(Command::Type type, const SoundEmitterPtr &emitter, uint64_t startTime = 0);
+		void processCommands();
+		void reapSoundEmitters();
+
+		void pushGarbage(Garbage &garbage);
+		void retryGarbage();
+		void releaseSoundEmitter(SoundEmitterPtr &emitter);
+		void releaseSound(SoundPtr &sound);
+		bool releaseGarbage();
+		static void garbageThread(void *arg);
+
+		bool needsConversion(const SoundPtr &sound) const;
+		SoundPtr findConvertedSound(const SoundPtr &sound);
+		void trimConversionCache(size_t budget);
 
 	public:
-		AudioContext(unsigned int targetSampleRate);
+		/**
+		 * @param targetSampleRate The sample rate at which samples will be mixed.
+		 * @param commandQueueSize The maximum number of attach and detach requests that can be waiting to be applied at once. This is also the maximum number of completed emitters that can be waiting to be collected.
+		 * @param numChannels The number of channels that samples will be mixed into, from 1 to MAX_CHANNELS. This should be the number of channels of the AudioDriver that will call writeSamples(); see ChannelLayoutGetChannel() for the speaker layout used.
+		 */
+		AudioContext(unsigned int targetSampleRate, unsigned int commandQueueSize = 1024, unsigned int numChannels = 2);
 		virtual ~AudioContext();
 
 		/**
-		 * Gets the target sample rate of the audio context. This should be set to the sample rate of the AudioDriver that will be passed to WriteSamples().
+		 * Gets the target sample rate of the audio context. This should be set to the sample rate of the AudioDriver that will call writeSamples().
 		 * @return Target sample rate.
 		 */
 		unsigned int getTargetSampleRate() const;
 
 		/**
-		 * Attaches a SoundEmitter.
+		 * Gets the number of channels that the audio context mixes samples into.
+		 * @return Number of channels.
+		 */
+		unsigned int getNumChannels() const;
+
+		/**
+		 * Gets the context's clock, which is the number of samples mixed by writeSamples() so far. It only advances as samples are mixed, so start times based on it are exact even when rendering faster or slower than real time (e.g. with AudioDriverNull).
+		 * @return Number of samples mixed.
+		 */
+		uint64_t getSampleTime() const;
+
+		/**
+		 * Gets the number of emitters released by the audio thread that are still waiting to be released by the housekeeping thread.
+		 * @return Number of pending releases.
+		 */
+		unsigned int getNumPendingReleases() const;
+
+		/**
+		 * Gets the total size of the sound data referenced by emitters waiting to be released by the housekeeping thread. The data is only freed if nothing else still references it.
+		 * @return Size in bytes, as reported by Sound::getDataSize().
+		 */
+		size_t getPendingReleaseDataSize() const;
+
+		/**
+		 * Sets the memory budget of the conversion cache. While the budget isn't 0, preloadSound() converts sounds stored in memory to the context's target sample rate, and playSound() plays the converted copies instead of resampling the sounds as they're played. Converted copies are cached until the budget is exceeded, evicting the least recently used ones first, and are dropped once nothing but the cache references the original sound. The default budget is 0, which disables the cache.
+		 * @param budget Maximum total size of converted sounds in bytes.
+		 */
+		void setConversionCacheBudget(size_t budget);
+
+		/**
+		 * @return Memory budget of the conversion cache in bytes.
+		 */
+		size_t getConversionCacheBudget() const;
+
+		/**
+		 * @return Total size of the converted sounds in the conversion cache in bytes.
+		 */
+		size_t getConversionCacheSize() const;
+
+		/**
+		 * Converts a sound to the context's target sample rate and adds it to the conversion cache, if the cache is enabled and the sound needs converting and fits in the budget. The conversion happens on the calling thread and can take a while for long sounds, so this is best called ahead of time (e.g. during a loading screen or on a loading thread). Other threads can keep using the context while it runs.
+		 * @param sound SoundPtr to the sound to convert.
+		 * @return SoundPtr to the converted sound, or the sound itself if it wasn't converted.
+		 */
+		SoundPtr preloadSound(const SoundPtr &sound);
+
+		/**
+		 * Removes all sounds from the conversion cache. Emitters playing converted sounds keep playing them.
+		 */
+		void clearConversionCache();
+
+		/**
+		 * Attaches a SoundEmitter. The emitter starts playing at the given time, or at the start of the next period if that time has already passed, and is detached automatically once it's done playing.
 		 * @param emitter SoundEmitterPtr to the SoundEmitter to be attached.
+		 * @param startTime Value of getSampleTime() at which the emitter's first sample is mixed. 0 starts the emitter as soon as possible.
 		 */
-		virtual void attachSoundEmitter(SoundEmitterPtr emitter);
+		virtual void attachSoundEmitter(const SoundEmitterPtr &emitter, uint64_t startTime = 0);
 
 		/**
-		 * Detaches a SoundEmitter.
+		 * Detaches a SoundEmitter. The emitter stops playing at the start of the next period.
 		 * @param emitter SoundEmitterPtr to the SoundEmitter to be detached.
 		 */
-		virtual void detachSoundEmitter(SoundEmitterPtr emitter);
+		virtual void detachSoundEmitter(const SoundEmitterPtr &emitter);
 
 		/**
-		 * Creates a SoundEmitter to the given Sound and attaches it.
+		 * Creates a SoundEmitter to the given Sound and attaches it. If the sound has a converted copy in the conversion cache, the emitter plays the copy. Sounds are never converted here, so playing a sound that hasn't been preloaded doesn't wait for a conversion.
 		 * @param sound SoundPtr to the Sound to be used by the new SoundEmitter.
+		 * @param startTime Value of getSampleTime() at which the sound starts playing, as with attachSoundEmitter().
 		 * @return SoundEmitterPtr to the new SoundEmitter.
 		 */
-		virtual SoundEmitterPtr playSound(SoundPtr sound);
+		virtual SoundEmitterPtr playSound(const SoundPtr &sound, uint64_t startTime = 0);
+
+		/**
+		 * Sets whether emitters that finish playing are queued for getCompletedSoundEmitter() and dispatchCompletedSoundEmitters(). This is off by default. Queued emitters, and the sounds they play, are kept until they're collected, so an application that turns this on should collect them regularly. Turning it off doesn't release the emitters that are already queued.
+		 * @param value True to queue completed emitters.
+		 */
+		void setCompletionReporting(bool value);
+
+		/**
+		 * @return True if emitters that finish playing are queued for getCompletedSoundEmitter() and dispatchCompletedSoundEmitters().
+		 */
+		bool getCompletionReporting() const;
+
+		/**
+		 * Gets a SoundEmitter that finished playing and was detached, waiting for one if necessary. Emitters are only reported while completion reporting is on; see setCompletionReporting().
+		 * @param timeout Maximum number of milliseconds to wait; 0 returns immediately.
+		 * @return SoundEmitterPtr to the completed SoundEmitter, or a null SoundEmitterPtr if none finished within the timeout.
+		 */
+		SoundEmitterPtr getCompletedSoundEmitter(unsigned int timeout = 0);
+
+		/**
+		 * Calls the given function on the calling thread for each SoundEmitter that finished playing and was detached since the last call, while completion reporting was on. Meant to be called once per frame by an application's main loop.
+		 * @param callback Function to be called for each completed SoundEmitter.
+		 * @param userData Pointer passed through to the callback.
+		 * @return The number of completed SoundEmitters dispatched.
+		 */
+		unsigned int dispatchCompletedSoundEmitters(CompletionCallback callback, void *userData = NULL);
 
 		/**
-		 * Writes a number of samples to the given AudioDriver.
-		 * @param driver Pointer to the AudioDriver to write samples with.
+		 * Mixes a number of samples from all attached emitters into the given buffer and detaches the emitters that are done playing. This is called by an AudioDriver once per period with the driver's own buffer.
+		 * @param samples Buffer of interleaved floating point samples to write to, numSamples * getNumChannels() floats in length.
 		 * @param numSamples The number of samples to be written.
 		 */
-		virtual void writeSamples(AudioDriver *driver, unsigned int numSamples);
+		virtual void writeSamples(float *samples, unsigned int numSamples);
 };
 
 }
@@ -44,8 +44,16 @@ class AudioDriver
 
 	protected:
 		unsigned int m_sampleRate;
+		unsigned int m_numChannels;
 		AudioContext *m_audioContext;
 
+		/**
+		 * Fills a period buffer with samples from the associated AudioContext, or with silence if no AudioContext is set. Derived classes should call this once per period.
+		 * @param samples Buffer of interleaved floating point samples, numSamples * getNumChannels() floats in length.
+		 * @param numSamples The number of samples to be written.
+		 */
+		void renderSamples(float *samples, unsigned int numSamples);
+
 	public:
 		AudioDriver();
 		virtual ~AudioDriver();
@@ -55,13 +63,18 @@ class AudioDriver
 		 */
 		unsigned int getSampleRate() const;
 
+		/**
+		 * @return The number of channels of audio written to the driver, in the order given by ChannelLayoutGetChannel().
+		 */
+		unsigned int getNumChannels() const;
+
 		/**
 		 * @return Pointer to the AudioContext associated with the driver.
 		 */
 		AudioContext *getAudioContext() const;
 
 		/**
-		 * Sets the AudioContext associated with the driver. If not NULL, the driver will asynchronously call the AudioContext::writeSamples() function of the given AudioContext to write sample data when necessary.
+		 * Sets the AudioContext associated with the driver. If not NULL, the driver will asynchronously call the AudioContext::writeSamples() function of the given AudioContext to write sample data when necessary. The AudioContext must have the same number of channels as the driver.
 		 * @param value Pointer to the AudioContext to associate with the driver.
 		 */
 		void setAudioContext(AudioContext *value);
@@ -71,17 +84,12 @@ class AudioDriver
 		 */
 		virtual const char *getDriverName() const = 0;
 
-		/**
-		 * Writes an audio sample to be played.
-		 * @param sample Sample object.
-		 */
-		virtual void writeSample(const Sample &sample) = 0;
-
 		/**
 		 * Creates a new AudioDriver using the most appropriate derived class available.
+		 * @param numChannels The number of channels requested. Drivers that can't open a device with that many channels fall back to the nearest number available, so getNumChannels() should be checked afterwards.
 		 * @return Pointer to new AudioDriver object.
 		 */
-		static AudioDriver *create();
+		static AudioDriver *create(unsigned int numChannels = 2);
 };
 
 }
@@ -37,17 +37,17 @@ class AudioDriverALSA : public AudioDriver
 		void *m_asyncHandler;
 
 		float *m_data;
-		unsigned int m_sampleIndex;
-		unsigned int m_numSamples;
+		unsigned int m_bufferSize;
 
 	public:
-		AudioDriverALSA();
+		/**
+		 * @param numChannels The number of channels requested. The nearest number supported by the device is used.
+		 */
+		AudioDriverALSA(unsigned int numChannels = 2);
 		virtual ~AudioDriverALSA();
 
 		const char *getDriverName() const;
 
-		void writeSample(const Sample &sample);
-
 		void alsaCallback();
 };
 
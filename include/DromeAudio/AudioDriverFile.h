@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_AUDIODRIVERFILE_H__
+#define __DROMEAUDIO_AUDIODRIVERFILE_H__
+
+#include <DromeAudio/AudioDriverNull.h>
+#include <DromeAudio/SampleFormat.h>
+
+namespace DromeAudio {
+
+class WavWriter;
+
+/** \brief A driver that renders audio to a WAV file.
+ *
+ * Works like AudioDriverNull, writing each period rendered to a 16-bit, 24-bit or floating point WAV file. The file is finished when close() is called or the driver is destroyed.
+ */
+class AudioDriverFile : public AudioDriverNull
+{
+	protected:
+		WavWriter *m_writer;
+
+		void writePeriod(const float *samples, unsigned int numSamples);
+
+	public:
+		/**
+		 * @param filename Path of the WAV file to write.
+		 * @param sampleRate The sample rate to render at.
+		 * @param numChannels The number of channels to render, from 1 to MAX_CHANNELS.
+		 * @param periodSize The maximum number of samples requested from the AudioContext at a time.
+		 * @param format Format of the samples in the file: SAMPLE_FORMAT_INT16, SAMPLE_FORMAT_INT24 or SAMPLE_FORMAT_FLOAT32.
+		 * @param dither True to add TPDF dither of 1 LSB before converting to an integer format.
+		 */
+		AudioDriverFile(const char *filename, unsigned int sampleRate = 44100, unsigned int numChannels = 2, unsigned int periodSize = 1024, SampleFormat format = SAMPLE_FORMAT_INT16, bool dither = false);
+		virtual ~AudioDriverFile();
+
+		const char *getDriverName() const;
+
+		/**
+		 * Finishes writing the WAV file. Rendering afterwards throws an exception.
+		 */
+		void close();
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_AUDIODRIVERFILE_H__ */
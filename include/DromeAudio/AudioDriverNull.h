@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_AUDIODRIVERNULL_H__
+#define __DROMEAUDIO_AUDIODRIVERNULL_H__
+
+#include <DromeAudio/AudioDriver.h>
+
+namespace DromeAudio {
+
+/** \brief A driver that renders audio without an audio device.
+ *
+ * Nothing is rendered until render() is called, which pulls samples from the associated AudioContext one period at a time on the calling thread, as fast as the CPU allows. Time is measured by the number of samples rendered rather than by a wall clock, so renders with the same sounds, emitters and scheduled start times (see AudioContext::attachSoundEmitter()) always produce the same output. Useful for batch rendering, tests and benchmarks on machines with no sound card.
+ */
+class AudioDriverNull : public AudioDriver
+{
+	protected:
+		float *m_data;
+		unsigned int m_periodSize;
+		uint64_t m_sampleTime;
+
+		/**
+		 * Called with each period of samples rendered. The default implementation discards them.
+		 * @param samples Buffer of interleaved floating point samples, numSamples * getNumChannels() floats in length.
+		 * @param numSamples The number of samples in the buffer.
+		 */
+		virtual void writePeriod(const float *samples, unsigned int numSamples);
+
+	public:
+		/**
+		 * @param sampleRate The sample rate to render at.
+		 * @param numChannels The number of channels to render, from 1 to MAX_CHANNELS.
+		 * @param periodSize The maximum number of samples requested from the AudioContext at a time.
+		 */
+		AudioDriverNull(unsigned int sampleRate = 44100, unsigned int numChannels = 2, unsigned int periodSize = 1024);
+		virtual ~AudioDriverNull();
+
+		const char *getDriverName() const;
+
+		/**
+		 * @return The maximum number of samples requested from the AudioContext at a time.
+		 */
+		unsigned int getPeriodSize() const;
+
+		/**
+		 * Gets the virtual clock of the driver.
+		 * @return The number of samples rendered so far.
+		 */
+		uint64_t getSampleTime() const;
+
+		/**
+		 * Renders a number of samples on the calling thread, in periods of up to getPeriodSize() samples.
+		 * @param numSamples The number of samples to render.
+		 */
+		void render(uint64_t numSamples);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_AUDIODRIVERNULL_H__ */
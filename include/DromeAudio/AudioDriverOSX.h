@@ -39,18 +39,12 @@ class AudioDriverOSX : public AudioDriver
 		pthread_t m_thread;
 		bool m_running;
 
-		float *m_data[2];
-		unsigned int m_sampleIndex;
-		unsigned int m_numSamples;
-
 	public:
 		AudioDriverOSX();
 		virtual ~AudioDriverOSX();
 
 		const char *getDriverName() const;
 
-		void writeSample(const Sample &sample);
-
 		void runLoop();
 		void renderCallback(AudioUnitRenderActionFlags *ioActionFlags, const AudioTimeStamp *inTimeStamp, UInt32 inBusNumber, UInt32 inNumberFrames, AudioBufferList *ioData);
 };
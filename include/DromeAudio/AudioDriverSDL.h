@@ -33,9 +33,8 @@ namespace DromeAudio {
 class AudioDriverSDL : public AudioDriver
 {
 	protected:
-		int16_t *m_data;
-		unsigned int m_sampleIndex;
-		unsigned int m_numSamples;
+		float *m_data;
+		unsigned int m_bufferSize;
 
 	public:
 		AudioDriverSDL();
@@ -43,8 +42,6 @@ class AudioDriverSDL : public AudioDriver
 
 		const char *getDriverName() const;
 
-		void writeSample(const Sample &sample);
-
 		void sdlCallback(uint8_t *stream, int length);
 };
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_BUFFERSOUND_H__
+#define __DROMEAUDIO_BUFFERSOUND_H__
+
+#include <DromeAudio/ResampleQuality.h>
+#include <DromeAudio/Sound.h>
+
+namespace DromeAudio {
+
+class BufferSound;
+typedef RefPtr <BufferSound> BufferSoundPtr;
+
+/** \brief A sound stored in memory as floating point samples.
+ *
+ * Reading from a BufferSound is a plain copy, so it's the cheapest kind of sound to play. It's used by AudioContext to cache sounds converted to the context's sample rate. Sounds with up to two channels are stored as Sample objects; sounds with more are stored as interleaved floats with all of their channels, which getSamples() downmixes to stereo and getPlanarSamples() returns as they are.
+ */
+class BufferSound : public Sound
+{
+	protected:
+		unsigned char m_numChannels;
+		unsigned int m_sampleRate;
+		unsigned int m_numSamples;
+
+		// only one of these is set, depending on the number of channels
+		Sample *m_samples;
+		float *m_frames;
+
+		BufferSound(unsigned char numChannels, unsigned int sampleRate, unsigned int numSamples);
+		virtual ~BufferSound();
+
+	public:
+		unsigned char getNumChannels() const;
+		unsigned int getSampleRate() const;
+		unsigned int getNumSamples() const;
+		size_t getDataSize() const;
+
+		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
+		void getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const;
+
+		/**
+		 * @return Pointer to the sound's samples, which may be modified, or NULL if the sound has more than two channels.
+		 */
+		Sample *getData();
+
+		/**
+		 * @return Pointer to the interleaved samples of a sound with more than two channels, getNumChannels() floats per sample, which may be modified, or NULL if the sound has two channels or less.
+		 */
+		float *getFrames();
+
+		/**
+		 * Creates a silent BufferSound.
+		 * @param numChannels Number of channels reported by the sound.
+		 * @param sampleRate Sample rate of the sound.
+		 * @param numSamples Number of samples in the sound; must not be 0.
+		 * @return BufferSoundPtr to the new sound.
+		 */
+		static BufferSoundPtr create(unsigned char numChannels, unsigned int sampleRate, unsigned int numSamples);
+
+		/**
+		 * Creates a BufferSound containing all of another sound's samples, converted to the given sample rate. Sounds with more than two channels keep their speaker positions (see Sound::getChannel()); others are stored as stereo Samples, already mixed down with theirs.
+		 * @param sound Sound to convert. Its number of samples must not be 0.
+		 * @param sampleRate Sample rate to convert to.
+		 * @param quality Interpolation used if the sample rates differ.
+		 * @return BufferSoundPtr to the new sound.
+		 */
+		static BufferSoundPtr create(const SoundPtr &sound, unsigned int sampleRate, ResampleQuality quality = RESAMPLE_SINC32);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_BUFFERSOUND_H__ */
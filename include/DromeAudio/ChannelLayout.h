@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_CHANNELLAYOUT_H__
+#define __DROMEAUDIO_CHANNELLAYOUT_H__
+
+#include <stdint.h>
+
+namespace DromeAudio {
+
+/**
+ * Speaker positions of the channels in a sound or output.
+ */
+enum Channel {
+	CHANNEL_FRONT_LEFT,
+	CHANNEL_FRONT_RIGHT,
+	CHANNEL_FRONT_CENTER,
+	CHANNEL_LOW_FREQUENCY,
+	CHANNEL_BACK_LEFT,
+	CHANNEL_BACK_RIGHT,
+	CHANNEL_BACK_CENTER,
+	CHANNEL_SIDE_LEFT,
+	CHANNEL_SIDE_RIGHT,
+
+	/** First-order ambisonic B-format components, with FuMa ordering and weighting (W at -3 dB) as in .amb files. They're decoded to the speakers of the output layout; height (Z) is dropped, since every layout is horizontal. */
+	CHANNEL_AMBISONIC_W,
+	CHANNEL_AMBISONIC_X,
+	CHANNEL_AMBISONIC_Y,
+	CHANNEL_AMBISONIC_Z,
+
+	/** A channel with no speaker position, such as a higher-order ambisonic component. */
+	CHANNEL_DISCRETE
+};
+
+/**
+ * Maximum number of channels supported by AudioContext outputs and by the multichannel mixing path.
+ */
+static const unsigned int MAX_CHANNELS = 8;
+
+/**
+ * Gets the speaker position of a channel in the default layout for a number of channels, which uses the same order as WAV files: mono is a single center channel, 4 channels are quadraphonic, 6 channels are 5.1 (FL, FR, FC, LFE, BL, BR) and 8 channels are 7.1 (5.1 followed by SL, SR). Channels past the eighth, and past the last channel of the layout, are discrete.
+ * @param numChannels Number of channels in the layout.
+ * @param index Index of the channel.
+ * @return Speaker position of the channel.
+ */
+Channel ChannelLayoutGetChannel(unsigned int numChannels, unsigned int index);
+
+/**
+ * Calculates the matrix used to mix channels of one layout into another. Channels with the same position are copied, and channels missing from the output layout are folded into the nearest ones (e.g. the center channel into the front left and right channels at -3 dB). The low frequency channel is dropped if the output doesn't have one. Mono input is played at full level on the front left and right channels, matching the way mono sounds are converted to stereo Samples.
+ * @param numInputChannels Number of channels being mixed.
+ * @param numOutputChannels Number of channels being mixed into.
+ * @param matrix Array of numOutputChannels * numInputChannels gains that will be written to, with the gain from input channel i to output channel o at index o * numInputChannels + i.
+ */
+void ChannelLayoutGetMixMatrix(unsigned int numInputChannels, unsigned int numOutputChannels, float *matrix);
+
+/**
+ * Calculates the matrix used to mix channels with the given positions into the default layout for a number of channels, as with ChannelLayoutGetMixMatrix(). Discrete channels are passed through by index, except in ambisonic input, where they're higher-order components and are dropped.
+ * @param inputChannels Array of numInputChannels speaker positions, one for each channel being mixed.
+ * @param numInputChannels Number of channels being mixed.
+ * @param numOutputChannels Number of channels being mixed into.
+ * @param matrix Array of numOutputChannels * numInputChannels gains that will be written to, laid out as with ChannelLayoutGetMixMatrix().
+ */
+void ChannelLayoutGetMixMatrix(const Channel *inputChannels, unsigned int numInputChannels, unsigned int numOutputChannels, float *matrix);
+
+/**
+ * Gets the speaker positions of the channels of a WAV file from the dwChannelMask of its WAVE_FORMAT_EXTENSIBLE header. Each channel takes the next position set in the mask, in order of the bits; front left and right of center and top positions are folded into the nearest positions here, and channels past the last bit set are discrete. A mask of 0 leaves the channels in the default layout for their number.
+ * @param mask Channel mask from the file.
+ * @param numChannels Number of channels in the file.
+ * @param channels Array of numChannels speaker positions that will be written to.
+ */
+void ChannelLayoutFromWavMask(uint32_t mask, unsigned int numChannels, Channel *channels);
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_CHANNELLAYOUT_H__ */
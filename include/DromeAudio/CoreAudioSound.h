@@ -52,6 +52,7 @@ class CoreAudioSound : public Sound
 		unsigned char getNumChannels() const;
 		unsigned int getSampleRate() const;
 		unsigned int getNumSamples() const;
+		size_t getDataSize() const;
 
 		Sample getSample(unsigned int index) const;
 
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_FLACSOUND_H__
+#define __DROMEAUDIO_FLACSOUND_H__
+
+#include <atomic>
+#include <DromeAudio/Mutex.h>
+#include <DromeAudio/Semaphore.h>
+#include <DromeAudio/Sound.h>
+#include <DromeAudio/Thread.h>
+#include <DromeAudio/ThreadPool.h>
+
+namespace DromeAudio {
+
+class FlacDecoder;
+struct FlacFrame;
+
+class FlacSound;
+typedef RefPtr <FlacSound> FlacSoundPtr;
+
+/** \brief A class for loading FLAC files.
+ *
+ * The file can either be decoded completely when it's loaded, optionally on multiple threads, or kept compressed in memory with its frames decoded as they're played.
+ *
+ * In compressed mode, the sound keeps track of the positions it's played from, one for each SoundEmitter playing a different part of it, up to the number given to create(). A background thread owned by the sound decodes the frames around each position into a cache with room for four frames per position, which is read without locking. Playing the sound from more positions at once than that makes the positions take each other's frames, and most of them miss. Requesting samples never decodes them or waits for them, so the mixer can't block on the sound. Frames that haven't been decoded yet when they're needed are played as silence and counted by getNumUnderruns(), unless blocking mode is enabled; getNumFramesDecoded() tells how often frames had to be decoded.
+ */
+class FlacSound : public Sound
+{
+	protected:
+		unsigned char m_numChannels;
+		unsigned char m_bytesPerSample;
+		SampleFormat m_format;
+		unsigned int m_sampleRate;
+		unsigned int m_numSamples;
+
+		// decoded samples, or NULL in compressed mode
+		uint8_t *m_data;
+		size_t m_dataSize;
+
+		// compressed mode: the file, the location of each of its
+		// frames and the decoder, which is only used with
+		// m_decodeMutex held
+		uint8_t *m_file;
+		size_t m_fileSize;
+		FlacFrame *m_frames;
+		unsigned int m_numFrames;
+		unsigned int m_maxFrameSamples;
+		FlacDecoder *m_decoder;
+		Mutex *m_decodeMutex;
+
+		// compressed mode: cache of m_numSlots decoded frames;
+		// m_slotFrames holds the number of the frame stored in each
+		// slot, or INVALID_FRAME while it's empty or being decoded into
+		unsigned int m_numSlots;
+		uint8_t *m_slotData;
+		std::atomic <unsigned int> *m_slotFrames;
+
+		// compressed mode: index of the next sample expected at each
+		// of m_numCursors positions the sound is played from, or
+		// INVALID_CURSOR, and when each was last moved; the decoder
+		// thread keeps the frames around each position decoded
+		unsigned int m_numCursors;
+		std::atomic <unsigned int> *m_cursors;
+		std::atomic <unsigned int> *m_cursorTimes;
+		mutable std::atomic <unsigned int> m_cursorClock;
+
+		// room for m_numSlots frame numbers, used by the decoder
+		// thread and, with m_decodeMutex held, in blocking mode
+		unsigned int *m_threadWanted;
+		unsigned int *m_blockingWanted;
+
+		mutable std::atomic <unsigned int> m_numFramesDecoded;
+		mutable std::atomic <unsigned int> m_numUnderruns;
+		std::atomic <bool> m_blocking;
+
+		Semaphore *m_semaphore;
+		Thread *m_thread;
+		std::atomic <bool> m_running;
+
+		FlacSound(const char *filename, bool compressed, ThreadPool *pool, unsigned int numPositions);
+		virtual ~FlacSound();
+
+		unsigned int findFrame(unsigned int index) const;
+		int findSlot(unsigned int frame) const;
+		unsigned int getWantedFrames(unsigned int *wanted) const;
+		int decodeFrame(unsigned int frame, const unsigned int *wanted, unsigned int numWanted);
+		void decodeFrames();
+		static void decoderThread(void *arg);
+		void moveCursor(unsigned int index, unsigned int next, bool wake) const;
+
+		template <typename Output> void read(unsigned int index, unsigned int numSamples, Output &output) const;
+
+	public:
+		unsigned char getNumChannels() const;
+		unsigned int getSampleRate() const;
+		unsigned int getNumSamples() const;
+
+		/**
+		 * @return The number of bytes used by the decoded samples or, in compressed mode, by the compressed file and the frame cache.
+		 */
+		size_t getDataSize() const;
+
+		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
+		void getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const;
+		void prefetch(unsigned int index);
+
+		/**
+		 * @return True if the sound is kept compressed in memory.
+		 */
+		bool isCompressed() const;
+
+		/**
+		 * Gets the number of frames that have been decoded in compressed mode because they weren't in the cache.
+		 * @return Number of frames decoded.
+		 */
+		unsigned int getNumFramesDecoded() const;
+
+		/**
+		 * Gets the number of times that samples were requested in compressed mode from a frame that wasn't decoded yet.
+		 * @return Number of underruns.
+		 */
+		unsigned int getNumUnderruns() const;
+
+		/**
+		 * @return True if blocking mode is enabled.
+		 */
+		bool getBlocking() const;
+
+		/**
+		 * Sets blocking mode. In blocking mode, frames that aren't decoded when they're needed are decoded on the thread requesting them instead of being played as silence. This is meant for offline use (e.g. rendering with AudioDriverNull, Sound::save(), or converting to a BufferSound, which AudioContext::preloadSound() does) and shouldn't be enabled while the sound is played by an audio thread. Disabled by default; has no effect unless the sound is compressed.
+		 * @param value True to enable blocking mode.
+		 */
+		void setBlocking(bool value);
+
+		/**
+		 * Loads a FLAC file.
+		 * @param filename Path to the FLAC file to load.
+		 * @param compressed True to keep the file compressed in memory and decode its frames as they're played, which uses a little more CPU time and about half the memory of the decoded samples. Compressed sounds decode their frames on a thread of their own.
+		 * @param pool If not NULL and the file isn't kept compressed, its frames are split into ranges that are decoded in parallel on the pool's threads (e.g. ThreadPool::getShared()).
+		 * @param numPositions In compressed mode, the number of positions the sound can be played from at once, usually the number of SoundEmitter objects playing it, which the frame cache is sized for.
+		 * @return SoundPtr to the loaded sound.
+		 */
+		static FlacSoundPtr create(const char *filename, bool compressed = false, ThreadPool *pool = NULL, unsigned int numPositions = 8);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_FLACSOUND_H__ */
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_LAZYSOUND_H__
+#define __DROMEAUDIO_LAZYSOUND_H__
+
+#include <atomic>
+#include <string>
+#include <DromeAudio/Mutex.h>
+#include <DromeAudio/Sound.h>
+#include <DromeAudio/SoundLoader.h>
+
+namespace DromeAudio {
+
+class LazySound;
+typedef RefPtr <LazySound> LazySoundPtr;
+
+/** \brief A sound that only reads the header of its file when it's created and loads the rest the first time it's needed.
+ *
+ * getNumChannels(), getSampleRate() and getNumSamples() are known right away, so a large catalog of sounds can be opened at startup for the cost of reading their headers, and only the sounds that are actually played take up memory. WAV files are supported, as well as Ogg Vorbis and FLAC files when the library is built with support for them.
+ *
+ * The data is loaded by load() or prefetch(), which SoundEmitter::setSound() and SoundEmitter::setSampleIndex() call, so playing the sound with an AudioContext starts loading it on the application's thread. Without a SoundLoader, loading happens on the thread that calls them. With a SoundLoader, it happens on the loader's threads instead, which hand the data to the sound as soon as it's ready. Requesting samples never loads the sound or waits for it, so the mixer can't block on it; the sound plays silence until its data is ready.
+ *
+ * If loading fails, the sound plays silence; load() throws an exception.
+ */
+class LazySound : public Sound
+{
+	protected:
+		std::string m_filename;
+		SoundLoadFunction m_function;
+		SoundLoader *m_loader;
+
+		unsigned char m_numChannels;
+		unsigned int m_sampleRate;
+		unsigned int m_numSamples;
+
+		// m_sound is set once before m_loaded is, and isn't changed
+		// afterwards, so it can be used without the mutex once
+		// m_loaded is true
+		Mutex *m_mutex;
+		mutable SoundPtr m_sound;
+		mutable SoundLoadRequestPtr m_request;
+		mutable std::atomic <bool> m_loaded;
+		mutable std::atomic <bool> m_failed;
+
+		LazySound(const char *filename, SoundLoadFunction function, SoundLoader *loader);
+		virtual ~LazySound();
+
+		void finish(const SoundPtr &sound) const;
+		static void loadCallback(SoundLoadRequest *request, void *userData);
+		bool update(bool wait) const;
+
+	public:
+		unsigned char getNumChannels() const;
+		unsigned int getSampleRate() const;
+		unsigned int getNumSamples() const;
+
+		/**
+		 * @return The number of bytes used by the loaded sound's data, or 0 if it hasn't been loaded yet.
+		 */
+		size_t getDataSize() const;
+
+		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
+		void getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const;
+
+		/**
+		 * Starts loading the sound if it hasn't been loaded yet. Without a SoundLoader, the sound is loaded before this returns.
+		 * @param index The index of the first sample that will be requested.
+		 */
+		void prefetch(unsigned int index);
+
+		/**
+		 * Loads the sound if it hasn't been loaded yet, waiting for the SoundLoader if there is one.
+		 */
+		void load();
+
+		/**
+		 * @return True if the sound's data has been loaded.
+		 */
+		bool isLoaded() const;
+
+		/**
+		 * @return True if loading the sound's data failed.
+		 */
+		bool isFailed() const;
+
+		/**
+		 * @return The path of the sound's file.
+		 */
+		const char *getFilename() const;
+
+		/**
+		 * Opens a sound file without loading its data.
+		 * @param filename Path to the file.
+		 * @param function Function used to load the data, which must return a sound with the same format as the file's header. Sound::create() is used if NULL.
+		 * @param loader If not NULL, the data is loaded on the loader's threads. The loader must not be destroyed before the sound. Destroying the sound while its data is being decoded waits for the decoding to finish.
+		 * @return SoundPtr to the sound.
+		 */
+		static LazySoundPtr create(const char *filename, SoundLoadFunction function = NULL, SoundLoader *loader = NULL);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_LAZYSOUND_H__ */
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_LOCKFREEQUEUE_H__
+#define __DROMEAUDIO_LOCKFREEQUEUE_H__
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace DromeAudio {
+
+/** \brief Bounded queue that can be used by multiple threads without locking.
+ *
+ * Any number of threads may push and pop values concurrently. Neither operation ever blocks; push() fails when the queue is full and pop() fails when it's empty. The capacity is rounded up to a power of two.
+ */
+template <typename T> class LockFreeQueue
+{
+	protected:
+		struct Cell {
+			std::atomic <size_t> sequence;
+			T value;
+		};
+
+		Cell *m_cells;
+		size_t m_mask;
+
+		// keep the producer and consumer positions on separate cache lines
+		char m_pad0[64];
+		std::atomic <size_t> m_pushPosition;
+		char m_pad1[64];
+		std::atomic <size_t> m_popPosition;
+		char m_pad2[64];
+
+	private:
+		LockFreeQueue(const LockFreeQueue <T> &);
+		void operator = (const LockFreeQueue <T> &);
+
+	public:
+		LockFreeQueue(unsigned int capacity)
+		{
+			size_t size = 2;
+			while(size < capacity)
+				size *= 2;
+
+			m_cells = new Cell[size];
+			m_mask = size - 1;
+			for(size_t i = 0; i < size; i++)
+				m_cells[i].sequence.store(i, std::memory_order_relaxed);
+
+			m_pushPosition.store(0, std::memory_order_relaxed);
+			m_popPosition.store(0, std::memory_order_relaxed);
+		}
+
+		~LockFreeQueue()
+		{
+			delete [] m_cells;
+		}
+
+		/**
+		 * @return The maximum number of values that the queue can hold.
+		 */
+		unsigned int getCapacity() const
+		{
+			return (unsigned int)(m_mask + 1);
+		}
+
+		/**
+		 * Adds a value to the end of the queue.
+		 * @param value The value to add.
+		 * @return False if the queue is full.
+		 */
+		bool push(const T &value)
+		{
+			Cell *cell;
+			size_t position = m_pushPosition.load(std::memory_order_relaxed);
+
+			for(;;) {
+				cell = &m_cells[position & m_mask];
+				size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				ptrdiff_t diff = (ptrdiff_t)sequence - (ptrdiff_t)position;
+
+				if(diff == 0) {
+					// the cell is free; try to claim it
+					if(m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				} else if(diff < 0) {
+					// the cell still holds a value from the previous lap
+					return false;
+				} else {
+					// another thread claimed the cell first
+					position = m_pushPosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			cell->value = value;
+			cell->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * Removes the value at the front of the queue.
+		 * @param value Set to the removed value.
+		 * @return False if the queue is empty.
+		 */
+		bool pop(T &value)
+		{
+			Cell *cell;
+			size_t position = m_popPosition.load(std::memory_order_relaxed);
+
+			for(;;) {
+				cell = &m_cells[position & m_mask];
+				size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				ptrdiff_t diff = (ptrdiff_t)sequence - (ptrdiff_t)(position + 1);
+
+				if(diff == 0) {
+					// the cell holds a value; try to claim it
+					if(m_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				} else if(diff < 0) {
+					// nothing has been pushed to the cell yet
+					return false;
+				} else {
+					// another thread claimed the cell first
+					position = m_popPosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			// leave a default value in the cell so that
+			// it doesn't hold onto any resources
+			value = std::move(cell->value);
+			cell->value = T();
+			cell->sequence.store(position + m_mask + 1, std::memory_order_release);
+			return true;
+		}
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_LOCKFREEQUEUE_H__ */
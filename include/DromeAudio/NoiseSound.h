@@ -40,6 +40,7 @@ class NoiseSound : public Sound
 
 	public:
 		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
 
 		static NoiseSoundPtr create();
 };
@@ -26,23 +26,41 @@
 #ifndef __DROMEAUDIO_REF_H__
 #define __DROMEAUDIO_REF_H__
 
+#include <atomic>
+
 namespace DromeAudio {
 
 /** \brief Provides a reference counting mechanism for classes that derive from it.
  *
  * Its initial reference count is 1. When its reference count reaches 0, it will automatically delete itself. The RefPtr class should be used for pointers to RefClass-derived classes, as it will automatically increment and decrement the reference count.
+ *
+ * The reference count is atomic, so objects can be shared between threads (e.g. a sound used by the application and the audio thread at the same time), as long as each thread uses its own RefPtr.
  */
 class RefClass
 {
 	protected:
-		int m_RefCount;
+		std::atomic <int> m_RefCount;
 
 	public:
-		RefClass() { m_RefCount = 0; }
+		RefClass() { m_RefCount.store(0, std::memory_order_relaxed); }
 		virtual ~RefClass() { }
 
-		inline void Ref() { ++m_RefCount; }
-		inline void Unref() { if(--m_RefCount == 0) delete this; }
+		// taking a new reference requires an existing one, so nothing
+		// needs to be ordered; the last release has to see every
+		// write made through the other references before deleting
+		inline void Ref() { m_RefCount.fetch_add(1, std::memory_order_relaxed); }
+		inline void Unref()
+		{
+			if(m_RefCount.fetch_sub(1, std::memory_order_release) == 1) {
+				std::atomic_thread_fence(std::memory_order_acquire);
+				delete this;
+			}
+		}
+
+		// only meaningful when no other thread can take a new
+		// reference, e.g. while holding a lock that guards every
+		// existing reference
+		inline int GetRefCount() const { return m_RefCount.load(std::memory_order_acquire); }
 };
 
 /** \brief Smart pointer class template for classes that derive from RefClass.
@@ -64,6 +82,12 @@ template <typename T> class RefPtr
 				ptr->Ref();
 		}
 
+		RefPtr(RefPtr <T> &&arg)
+		{
+			ptr = arg.ptr;
+			arg.ptr = 0;
+		}
+
 		RefPtr(T *arg)
 		{
 			ptr = arg;
@@ -81,31 +105,38 @@ template <typename T> class RefPtr
 
 		inline bool operator ! () const  { return (ptr ? false : true); }
 
-		inline void operator = (RefPtr <T> arg)
+		// the new object is referenced before the old one is released
+		// in case they're the same object or one owns the other
+		inline void operator = (const RefPtr <T> &arg)
 		{
-			if(ptr)
-				ptr->Unref();
+			*this = arg.ptr;
+		}
+
+		inline void operator = (RefPtr <T> &&arg)
+		{
+			if(&arg == this)
+				return;
+
+			T *old = ptr;
 			ptr = arg.ptr;
-			if(ptr)
-				ptr->Ref();
+			arg.ptr = 0;
+			if(old)
+				old->Unref();
 		}
 
 		inline void operator = (T *arg)
 		{
-			if(ptr)
-				ptr->Unref();
+			T *old = ptr;
 			ptr = arg;
 			if(ptr)
 				ptr->Ref();
+			if(old)
+				old->Unref();
 		}
 
 		inline void operator = (T &arg)
 		{
-			if(ptr)
-				ptr->Unref();
-			ptr = &arg;
-			if(ptr)
-				ptr->Ref();
+			*this = &arg;
 		}
 
 		inline bool operator == (const RefPtr <T> &arg) const
@@ -120,7 +151,7 @@ template <typename T> class RefPtr
 
 		// cast overload
 		template <typename U>
-		inline operator RefPtr <U> ()
+		inline operator RefPtr <U> () const
 		{
 			return RefPtr <U> (static_cast <U *> (ptr));
 		}
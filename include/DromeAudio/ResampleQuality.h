@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_RESAMPLEQUALITY_H__
+#define __DROMEAUDIO_RESAMPLEQUALITY_H__
+
+namespace DromeAudio {
+
+/**
+ * Interpolation used when a sound is played at a different rate than it was recorded at, by a SoundEmitter or a PitchShiftSoundEffect. Higher qualities alias less but cost more per sample; the sinc filters are windowed-sinc FIR filters that are shared by everything resampling at similar ratios.
+ */
+enum ResampleQuality {
+	/** Nearest sample, with no interpolation. */
+	RESAMPLE_NEAREST,
+
+	/** Linear interpolation between two samples. */
+	RESAMPLE_LINEAR,
+
+	/** 8-tap windowed sinc filter. */
+	RESAMPLE_SINC8,
+
+	/** 32-tap windowed sinc filter. */
+	RESAMPLE_SINC32
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_RESAMPLEQUALITY_H__ */
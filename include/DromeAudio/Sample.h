@@ -26,7 +26,11 @@
 #ifndef __DROMEAUDIO_SAMPLE_H__
 #define __DROMEAUDIO_SAMPLE_H__
 
+#include <cstddef>
+#include <DromeAudio/ChannelLayout.h>
 #include <DromeAudio/Endian.h>
+#include <DromeAudio/SampleBuffer.h>
+#include <DromeAudio/SampleFormat.h>
 
 namespace DromeAudio {
 
@@ -93,12 +97,79 @@ class Sample
 		/**
 		 * @return Sample created from an array of 8-bit integers.
 		 */
-		static Sample fromInt8(const int8_t values[], unsigned int numChannels);
+		static Sample fromInt8(const int8_t values[], unsigned int numChannels, const Channel *channels = NULL);
+
+		/**
+		 * Converts an array of interleaved 8-bit integers to an array of samples.
+		 * @param values Interleaved values, numSamples * numChannels in length.
+		 * @param numChannels Number of channels per sample in values. Samples with more than two channels are mixed down to stereo using the default channel layout (see ChannelLayoutGetMixMatrix()).
+		 * @param samples Array that numSamples Sample objects will be written to.
+		 * @param numSamples Number of samples to convert.
+		 * @param channels Speaker positions of the channels, or NULL for the default layout. Samples with positions are always mixed down with ChannelLayoutGetMixMatrix(), whatever their number of channels.
+		 */
+		static void fromInt8(const int8_t values[], unsigned int numChannels, Sample samples[], unsigned int numSamples, const Channel *channels = NULL);
+
+		/**
+		 * Converts an array of interleaved 8-bit integers to planar floating point values, keeping every channel.
+		 * @param values Interleaved values, numSamples * numChannels in length.
+		 * @param numChannels Number of channels per sample in values.
+		 * @param buffer Buffer with at least numChannels channels to write to.
+		 * @param offset Index in the buffer to write the first sample to.
+		 * @param numSamples Number of samples to convert.
+		 */
+		static void fromInt8(const int8_t values[], unsigned int numChannels, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples);
 
 		/**
 		 * @return Sample created from an array of 16-bit integers.
 		 */
-		static Sample fromInt16(const int16_t values[], unsigned int numChannels);
+		static Sample fromInt16(const int16_t values[], unsigned int numChannels, const Channel *channels = NULL);
+
+		/**
+		 * Converts an array of interleaved 16-bit integers to an array of samples.
+		 * @param values Interleaved values, numSamples * numChannels in length.
+		 * @param numChannels Number of channels per sample in values. Samples with more than two channels are mixed down to stereo using the default channel layout (see ChannelLayoutGetMixMatrix()).
+		 * @param samples Array that numSamples Sample objects will be written to.
+		 * @param numSamples Number of samples to convert.
+		 * @param channels Speaker positions of the channels, or NULL for the default layout. Samples with positions are always mixed down with ChannelLayoutGetMixMatrix(), whatever their number of channels.
+		 */
+		static void fromInt16(const int16_t values[], unsigned int numChannels, Sample samples[], unsigned int numSamples, const Channel *channels = NULL);
+
+		/**
+		 * Converts an array of interleaved 16-bit integers to planar floating point values, keeping every channel.
+		 * @param values Interleaved values, numSamples * numChannels in length.
+		 * @param numChannels Number of channels per sample in values.
+		 * @param buffer Buffer with at least numChannels channels to write to.
+		 * @param offset Index in the buffer to write the first sample to.
+		 * @param numSamples Number of samples to convert.
+		 */
+		static void fromInt16(const int16_t values[], unsigned int numChannels, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples);
+
+		/**
+		 * @return Sample created from an array of values in the given format.
+		 */
+		static Sample fromFormat(const void *values, SampleFormat format, unsigned int numChannels, const Channel *channels = NULL);
+
+		/**
+		 * Converts interleaved values in any sample format to an array of samples. Integer formats are scaled so that their largest positive value is 1, and floating point values are copied as they are.
+		 * @param values Interleaved values, numSamples * numChannels in length.
+		 * @param format Format of the values.
+		 * @param numChannels Number of channels per sample in values. Samples with more than two channels are mixed down to stereo using the default channel layout (see ChannelLayoutGetMixMatrix()).
+		 * @param samples Array that numSamples Sample objects will be written to.
+		 * @param numSamples Number of samples to convert.
+		 * @param channels Speaker positions of the channels, or NULL for the default layout. Samples with positions are always mixed down with ChannelLayoutGetMixMatrix(), whatever their number of channels.
+		 */
+		static void fromFormat(const void *values, SampleFormat format, unsigned int numChannels, Sample samples[], unsigned int numSamples, const Channel *channels = NULL);
+
+		/**
+		 * Converts interleaved values in any sample format to planar floating point values, keeping every channel.
+		 * @param values Interleaved values, numSamples * numChannels in length.
+		 * @param format Format of the values.
+		 * @param numChannels Number of channels per sample in values.
+		 * @param buffer Buffer with at least numChannels channels to write to.
+		 * @param offset Index in the buffer to write the first sample to.
+		 * @param numSamples Number of samples to convert.
+		 */
+		static void fromFormat(const void *values, SampleFormat format, unsigned int numChannels, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples);
 };
 
 } // namespace DromeAudio
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_SAMPLEBUFFER_H__
+#define __DROMEAUDIO_SAMPLEBUFFER_H__
+
+namespace DromeAudio {
+
+/** \brief A block of multichannel audio stored in planar form.
+ *
+ * Each channel is a separate contiguous array of floating point values with a range of [-1, 1], so that channels can be mixed and converted with plain array operations regardless of how many there are.
+ */
+class SampleBuffer
+{
+	protected:
+		unsigned int m_numChannels;
+		unsigned int m_numSamples;
+		float *m_data;
+		bool m_ownsData;
+
+	private:
+		SampleBuffer(const SampleBuffer &);
+		SampleBuffer &operator = (const SampleBuffer &);
+
+	public:
+		/**
+		 * Allocates a silent buffer.
+		 * @param numChannels Number of channels.
+		 * @param numSamples Number of samples per channel.
+		 */
+		SampleBuffer(unsigned int numChannels, unsigned int numSamples);
+
+		/**
+		 * Creates a buffer that uses existing memory, which isn't freed by the buffer. This is useful for buffers on the stack of an audio thread, which shouldn't allocate memory.
+		 * @param numChannels Number of channels.
+		 * @param numSamples Number of samples per channel.
+		 * @param data Array of numChannels * numSamples floats, with each channel's values following the previous channel's.
+		 */
+		SampleBuffer(unsigned int numChannels, unsigned int numSamples, float *data);
+
+		~SampleBuffer();
+
+		unsigned int getNumChannels() const;
+		unsigned int getNumSamples() const;
+
+		/**
+		 * @param channel Index of the channel.
+		 * @return Pointer to the channel's array of getNumSamples() values.
+		 */
+		float *getChannel(unsigned int channel);
+
+		/**
+		 * @param channel Index of the channel.
+		 * @return Pointer to the channel's array of getNumSamples() values.
+		 */
+		const float *getChannel(unsigned int channel) const;
+
+		/**
+		 * Sets part of every channel to silence.
+		 * @param offset Index of the first sample to clear.
+		 * @param numSamples Number of samples to clear.
+		 */
+		void clear(unsigned int offset, unsigned int numSamples);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_SAMPLEBUFFER_H__ */
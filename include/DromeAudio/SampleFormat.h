@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_SAMPLEFORMAT_H__
+#define __DROMEAUDIO_SAMPLEFORMAT_H__
+
+namespace DromeAudio {
+
+/**
+ * Formats of the individual values of integer or floating point sample data, which are in native byte order.
+ */
+enum SampleFormat {
+	/** Signed 8-bit integers. */
+	SAMPLE_FORMAT_INT8,
+
+	/** Unsigned 8-bit integers, with silence at 128, as used by 8-bit WAV files. */
+	SAMPLE_FORMAT_UINT8,
+
+	/** Signed 16-bit integers. */
+	SAMPLE_FORMAT_INT16,
+
+	/** Signed 24-bit integers, packed into 3 bytes each. */
+	SAMPLE_FORMAT_INT24,
+
+	/** Signed 32-bit integers. */
+	SAMPLE_FORMAT_INT32,
+
+	/** 32-bit IEEE floating point values with a range of [-1, 1]. */
+	SAMPLE_FORMAT_FLOAT32
+};
+
+/**
+ * @param format Sample format.
+ * @return Size of a single value of the format in bytes.
+ */
+unsigned int SampleFormatGetSize(SampleFormat format);
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_SAMPLEFORMAT_H__ */
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_SEMAPHORE_H__
+#define __DROMEAUDIO_SEMAPHORE_H__
+
+namespace DromeAudio {
+
+class Semaphore
+{
+	public:
+		virtual ~Semaphore() {}
+
+		/**
+		 * Increments the semaphore's count, waking a waiting thread if there is one. This never blocks, so it's safe to call from an audio thread.
+		 */
+		virtual void post() = 0;
+
+		/**
+		 * Waits until the semaphore's count is greater than zero and decrements it.
+		 */
+		virtual void wait() = 0;
+
+		/**
+		 * Waits up to the given number of milliseconds for the semaphore's count to be greater than zero, and decrements it if so.
+		 * @param timeout Maximum number of milliseconds to wait; 0 returns immediately.
+		 * @return False if the timeout expired.
+		 */
+		virtual bool wait(unsigned int timeout) = 0;
+
+		static Semaphore *create();
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_SEMAPHORE_H__ */
@@ -49,6 +49,7 @@ class SineSound : public Sound
 		void setFrequency(float value);
 
 		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
 
 		static SineSoundPtr create(float frequency);
 };
@@ -26,10 +26,14 @@
 #ifndef __DROMEAUDIO_SOUND_H__
 #define __DROMEAUDIO_SOUND_H__
 
+#include <cstddef>
 #include <string>
 #include <DromeAudio/Ref.h>
+#include <DromeAudio/ChannelLayout.h>
 #include <DromeAudio/Endian.h>
 #include <DromeAudio/Sample.h>
+#include <DromeAudio/SampleBuffer.h>
+#include <DromeAudio/SampleFormat.h>
 
 namespace DromeAudio {
 
@@ -47,15 +51,37 @@ class Sound : public RefClass
 	 */
 
 	protected:
+		Channel m_channels[MAX_CHANNELS];
+		bool m_hasChannelLayout;
+
 		Sound();
 		virtual ~Sound() { }
 
+		/**
+		 * @return The speaker positions set with setChannelLayout(), or NULL if the sound uses the default layout for its number of channels. Derived classes pass this to Sample::fromFormat() so that their stereo samples are mixed down with the sound's layout.
+		 */
+		const Channel *getChannelLayout() const;
+
 	public:
 		/**
 		 * @return The number of audio channels that the sound consists of.
 		 */
 		virtual unsigned char getNumChannels() const;
 
+		/**
+		 * Gets the speaker position of one of the sound's channels, which SoundEmitter uses to mix the channel into the output. Unless a layout was set with setChannelLayout(), this is the default layout for the sound's number of channels (see ChannelLayoutGetChannel()).
+		 * @param index Index of the channel.
+		 * @return Speaker position of the channel.
+		 */
+		virtual Channel getChannel(unsigned int index) const;
+
+		/**
+		 * Sets the speaker positions of the sound's channels, e.g. to mark the channels of a 4-channel file as ambisonic B-format rather than quadraphonic. Channels past numChannels, and past MAX_CHANNELS, are discrete. Positions matching the default layout for the sound's number of channels leave it using the default layout. This should be called before the sound is played.
+		 * @param channels Array of numChannels speaker positions.
+		 * @param numChannels Number of positions in the array.
+		 */
+		void setChannelLayout(const Channel *channels, unsigned int numChannels);
+
 		/**
 		 * @return The sample rate (number of samples per second of audio) of the sound.
 		 */
@@ -66,6 +92,11 @@ class Sound : public RefClass
 		 */
 		virtual unsigned int getNumSamples() const;
 
+		/**
+		 * @return The number of bytes of memory used by the sound's audio data, or 0 if the sound doesn't store it (e.g. generated or streamed sounds).
+		 */
+		virtual size_t getDataSize() const;
+
 		/**
 		 * Retrieves one sample of audio data from the sound.
 		 * @param index The index of the Sample to retrieve. Should be less than the value returned by getNumSamples() (if getNumSamples() does not equal 0).
@@ -73,15 +104,40 @@ class Sound : public RefClass
 		 */
 		virtual Sample getSample(unsigned int index) const = 0;
 
+		/**
+		 * Retrieves a block of consecutive samples of audio data from the sound. The default implementation calls getSample() once for each sample, so derived classes should override it to avoid the per-sample virtual call.
+		 * @param index The index of the first Sample to retrieve.
+		 * @param samples Array that at least numSamples Sample objects will be written to.
+		 * @param numSamples The number of samples to retrieve.
+		 */
+		virtual void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
+
+		/**
+		 * Retrieves a block of consecutive samples with all of the sound's channels, rather than mixed down to stereo Sample objects. The default implementation converts the samples returned by getSamples(), writing the left and right channels to the first two channels of the buffer (or just the left channel for mono sounds) and silence to the rest, so sounds with more than two channels should override it.
+		 * @param index The index of the first sample to retrieve.
+		 * @param buffer Buffer with at least getNumChannels() channels; only the first getNumChannels() channels are written to.
+		 * @param offset Index in the buffer to write the first sample to.
+		 * @param numSamples The number of samples to retrieve.
+		 */
+		virtual void getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const;
+
+		/**
+		 * Hints that samples starting at the given index will be requested soon, so that sounds that read their data in the background can start reading it. Called by SoundEmitter::setSampleIndex(). The default implementation does nothing.
+		 * @param index The index of the first sample that will be requested.
+		 */
+		virtual void prefetch(unsigned int index);
+
 		virtual void setParameter(const std::string &name, float value);
-		virtual void setParameter(const std::string &name, SoundPtr value);
+		virtual void setParameter(const std::string &name, const SoundPtr &value);
 
 		/**
-		 * Saves the sound to a WAV file.
+		 * Saves the sound to a stereo WAV file. Samples are rendered and written in large blocks. Files with more than 4 GB of data are written as RF64.
 		 * @param filename The path of the file to save.
 		 * @param numSamples The number of samples (starting from the first sample in the sound) to save.
+		 * @param format Format of the samples in the file: SAMPLE_FORMAT_INT16, SAMPLE_FORMAT_INT24 or SAMPLE_FORMAT_FLOAT32. Integer formats saturate values outside of [-1, 1].
+		 * @param dither True to add TPDF dither of 1 LSB before converting to an integer format.
 		 */
-		void save(const char *filename, unsigned int numSamples = 0);
+		void save(const char *filename, unsigned int numSamples = 0, SampleFormat format = SAMPLE_FORMAT_INT16, bool dither = false);
 
 		/**
 		 * Attempts to load a sound using the appropriate format-specific class depending on the extension of the given filename. For example, the WavSound class will be used to load a file with a ".wav" extension.
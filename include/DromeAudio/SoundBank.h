@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_SOUNDBANK_H__
+#define __DROMEAUDIO_SOUNDBANK_H__
+
+#include <string>
+#include <vector>
+#include <DromeAudio/Sound.h>
+
+namespace DromeAudio {
+
+class MappedFile;
+struct SoundBankEntry;
+
+class SoundBank;
+typedef RefPtr <SoundBank> SoundBankPtr;
+
+/** \brief A file containing many sounds, which is mapped into memory once and looked up by name.
+ *
+ * A bank starts with an index holding the name, format, channel layout, sample rate and length of each sound and a hash table of the names, followed by the sounds' uncompressed samples. Opening a sound by name takes constant time and doesn't read or copy any samples; like WavSound's mapped mode, samples are played straight from the mapping and their pages are read in by the OS when they're first touched. Banks are created by pack() (see the DromeAudioPack example).
+ *
+ * Sounds keep the bank mapped while they exist, so the bank can be released as soon as its sounds have been retrieved. The file must not be modified while it's mapped.
+ */
+class SoundBank : public RefClass
+{
+	protected:
+		MappedFile *m_file;
+		const SoundBankEntry *m_entries;
+		const uint32_t *m_slots;
+		const char *m_names;
+		unsigned int m_numEntries;
+		unsigned int m_numSlots;
+
+		SoundBank(const char *filename);
+		virtual ~SoundBank();
+
+	public:
+		/**
+		 * @return The number of sounds in the bank.
+		 */
+		unsigned int getNumSounds() const;
+
+		/**
+		 * @param index Index of the sound, less than getNumSounds().
+		 * @return The name of the sound.
+		 */
+		std::string getName(unsigned int index) const;
+
+		/**
+		 * Looks up a sound by name.
+		 * @param name Name of the sound.
+		 * @return Index of the sound, or -1 if the bank has no sound with that name.
+		 */
+		int find(const char *name) const;
+
+		/**
+		 * @param index Index of the sound, less than getNumSounds().
+		 * @return SoundPtr to the sound.
+		 */
+		SoundPtr getSound(unsigned int index);
+
+		/**
+		 * Looks up a sound by name, throwing an exception if the bank has no sound with that name.
+		 * @param name Name of the sound.
+		 * @return SoundPtr to the sound.
+		 */
+		SoundPtr getSound(const char *name);
+
+		/**
+		 * Maps a bank file into memory and checks its index.
+		 * @param filename Path to the bank file.
+		 * @return SoundBankPtr to the bank.
+		 */
+		static SoundBankPtr create(const char *filename);
+
+		/**
+		 * Creates a bank file from sound files. WAV files keep the format of their samples; other files are loaded with Sound::create() and stored as 16-bit samples.
+		 * @param filename Path of the bank file to write.
+		 * @param names Names that the sounds will be looked up by; each name must be unique.
+		 * @param filenames Paths of the sound files, in the same order as names.
+		 */
+		static void pack(const char *filename, const std::vector <std::string> &names, const std::vector <std::string> &filenames);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_SOUNDBANK_H__ */
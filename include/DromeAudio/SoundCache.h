@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_SOUNDCACHE_H__
+#define __DROMEAUDIO_SOUNDCACHE_H__
+
+#include <list>
+#include <map>
+#include <string>
+#include <DromeAudio/Mutex.h>
+#include <DromeAudio/Sound.h>
+#include <DromeAudio/SoundLoader.h>
+
+namespace DromeAudio {
+
+class SoundCacheEntry;
+
+/** \brief Shares loaded sounds between everything that loads the same file.
+ *
+ * Sounds are keyed by their path and the file's modification time and size, so loading a file that's already in the cache returns the same sound instead of decoding another copy, and loading a file that has changed since it was cached loads it again. Sounds' data isn't modified after they're loaded, so a sound can be played by any number of emitters at once.
+ *
+ * The cache keeps loaded sounds until the data of all of them (as reported by Sound::getDataSize()) exceeds its budget, then drops the least recently used sounds that aren't referenced outside of the cache. Sounds that are still referenced, e.g. by a SoundEmitter, are never dropped, so eviction is safe while they're being played; the cache can go over its budget until they're released and trim() or load() is called.
+ *
+ * Every method can be called from any thread. If several threads load the same file at the same time, it's only decoded once and the other threads wait for it.
+ */
+class SoundCache
+{
+	protected:
+		SoundLoadFunction m_function;
+		size_t m_budget;
+		size_t m_numBytes;
+		uint64_t m_numHits;
+		uint64_t m_numMisses;
+
+		// entries keyed by filename, each holding a reference to its
+		// entry, and loaded entries ordered from most to least
+		// recently used
+		std::map <std::string, SoundCacheEntry *> m_entries;
+		std::list <SoundCacheEntry *> m_lru;
+		Mutex *m_mutex;
+
+		void remove(SoundCacheEntry *entry);
+		void finish(SoundCacheEntry *entry, const SoundPtr &sound);
+		void evict();
+
+	public:
+		/**
+		 * @param budget Number of bytes of sound data to keep before unreferenced sounds are dropped.
+		 * @param function Function used to load sounds; Sound::create() is used if NULL.
+		 */
+		SoundCache(size_t budget, SoundLoadFunction function = NULL);
+
+		/**
+		 * Sounds that are still referenced outside of the cache stay valid after it's destroyed.
+		 */
+		~SoundCache();
+
+		/**
+		 * Gets a sound from the cache, loading it if it isn't cached or the file has changed.
+		 * @param filename Path to the file. Different paths to the same file are cached separately.
+		 * @return SoundPtr to the sound.
+		 */
+		SoundPtr load(const char *filename);
+
+		/**
+		 * Drops unreferenced sounds until the cache's data fits within its budget.
+		 */
+		void trim();
+
+		/**
+		 * Drops every unreferenced sound.
+		 */
+		void clear();
+
+		/**
+		 * Sets the cache's budget, dropping unreferenced sounds if it's exceeded.
+		 * @param budget Number of bytes of sound data to keep before unreferenced sounds are dropped.
+		 */
+		void setBudget(size_t budget);
+
+		/**
+		 * @return The number of bytes of sound data to keep before unreferenced sounds are dropped.
+		 */
+		size_t getBudget() const;
+
+		/**
+		 * @return The number of bytes of data used by the cached sounds.
+		 */
+		size_t getNumBytes() const;
+
+		/**
+		 * @return The number of cached sounds.
+		 */
+		unsigned int getNumSounds() const;
+
+		/**
+		 * @return The number of calls to load() that returned a cached sound.
+		 */
+		uint64_t getNumHits() const;
+
+		/**
+		 * @return The number of calls to load() that loaded a sound.
+		 */
+		uint64_t getNumMisses() const;
+
+		/**
+		 * Gets the process-wide cache, which uses Sound::create() and has a budget of 128 MiB until setBudget() is called.
+		 * @return Pointer to the shared cache, which is never destroyed.
+		 */
+		static SoundCache *getShared();
+
+		/**
+		 * Loads a sound through the shared cache. This can be given to SoundLoader::load() or LazySound::create() as the load function.
+		 * @param filename Path to the file.
+		 * @return SoundPtr to the sound.
+		 */
+		static SoundPtr loadShared(const char *filename);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_SOUNDCACHE_H__ */
@@ -27,10 +27,13 @@
 #define __DROMEAUDIO_SOUNDEFFECT_H__
 
 #include <DromeAudio/Exception.h>
+#include <DromeAudio/ResampleQuality.h>
 #include <DromeAudio/Sound.h>
 
 namespace DromeAudio {
 
+class ResampleFilter;
+
 /*
  * SoundEffect
  */
@@ -43,16 +46,18 @@ class SoundEffect : public Sound
 		SoundPtr m_sound;
 
 		SoundEffect() { }
-		SoundEffect(SoundPtr sound) { setSound(sound); }
+		SoundEffect(const SoundPtr &sound) { setSound(sound); }
 		virtual ~SoundEffect() { }
 
 	public:
 		virtual unsigned char getNumChannels() const;
 		virtual unsigned int getSampleRate() const;
 		virtual unsigned int getNumSamples() const;
+		virtual size_t getDataSize() const;
+		virtual void prefetch(unsigned int index);
 
 		SoundPtr getSound() const;
-		virtual void setSound(SoundPtr value);
+		virtual void setSound(const SoundPtr &value);
 
 		virtual Sample getSample(unsigned int index) const = 0;
 };
@@ -68,7 +73,13 @@ class PitchShiftSoundEffect : public SoundEffect
 	protected:
 		float m_factor;
 
-		PitchShiftSoundEffect(SoundPtr sound, float factor);
+		// m_factor as a 32.32 fixed point step
+		uint64_t m_step;
+
+		ResampleQuality m_resampleQuality;
+		const ResampleFilter *m_filter;
+
+		PitchShiftSoundEffect(const SoundPtr &sound, float factor);
 
 	public:
 		unsigned int getNumSamples() const;
@@ -76,9 +87,22 @@ class PitchShiftSoundEffect : public SoundEffect
 		float getFactor() const;
 		void setFactor(float value);
 
+		/**
+		 * Gets the interpolation used between samples of the associated sound. The default is RESAMPLE_SINC8.
+		 * @return Resample quality.
+		 */
+		ResampleQuality getResampleQuality() const;
+
+		/**
+		 * Sets the interpolation used between samples of the associated sound.
+		 * @param value Resample quality.
+		 */
+		void setResampleQuality(ResampleQuality value);
+
 		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
 
-		static PitchShiftSoundEffectPtr create(SoundPtr sound, float factor);
+		static PitchShiftSoundEffectPtr create(const SoundPtr &sound, float factor);
 };
 
 /*
@@ -92,15 +116,16 @@ class OscillatorSoundEffect : public SoundEffect
 	protected:
 		float m_frequency;
 
-		OscillatorSoundEffect(SoundPtr sound, float frequency);
+		OscillatorSoundEffect(const SoundPtr &sound, float frequency);
 
 	public:
 		float getFrequency() const;
 		void setFrequency(float value);
 
 		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
 
-		static OscillatorSoundEffectPtr create(SoundPtr sound, float frequency);
+		static OscillatorSoundEffectPtr create(const SoundPtr &sound, float frequency);
 };
 
 /*
@@ -116,7 +141,7 @@ class EchoSoundEffect : public SoundEffect
 		float m_factor;
 		unsigned int m_count;
 
-		EchoSoundEffect(SoundPtr sound, float delay, float factor, unsigned int count);
+		EchoSoundEffect(const SoundPtr &sound, float delay, float factor, unsigned int count);
 
 	public:
 		unsigned int getNumSamples() const;
@@ -131,8 +156,9 @@ class EchoSoundEffect : public SoundEffect
 		void setCount(unsigned int value);
 
 		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
 
-		static EchoSoundEffectPtr create(SoundPtr sound, float delay, float factor, unsigned int count);
+		static EchoSoundEffectPtr create(const SoundPtr &sound, float delay, float factor, unsigned int count);
 };
 
 } // namespace DromeAudio
@@ -26,14 +26,20 @@
 #ifndef __DROMEAUDIO_SOUNDEMITTER_H__
 #define __DROMEAUDIO_SOUNDEMITTER_H__
 
+#include <atomic>
+#include <DromeAudio/ResampleQuality.h>
 #include <DromeAudio/Sound.h>
 
 namespace DromeAudio {
 
+class ResampleFilter;
+
 class SoundEmitter;
 typedef RefPtr <SoundEmitter> SoundEmitterPtr;
 
 /** \brief Plays a Sound when attached to an AudioContext.
+ *
+ * The sound, sample rate, loop, paused, volume, balance and sample index values can be changed from any thread while the emitter is playing. Changes are picked up without locking at the start of the next block of samples that the emitter plays.
  */
 class SoundEmitter : public Sound
 {
@@ -41,21 +47,89 @@ class SoundEmitter : public Sound
 	 * \example DromeAudioPlayer.cpp
 	 */
 
-	protected:
-		unsigned int m_sampleRate;
-		SoundPtr m_sound;
+	friend class AudioContext;
 
-		bool m_loop;
-		bool m_paused;
-		float m_volume;
-		float m_balance;
+	protected:
+		std::atomic <unsigned int> m_sampleRate;
 
-		unsigned int m_sampleIndex;
+		// m_sound is the sound set by setSound(), which is only used
+		// by the application's threads; the thread playing the
+		// emitter plays m_playingSound, which setSound() replaces by
+		// passing the new sound through m_pendingSound
+		SoundPtr m_sound;
+		SoundPtr m_playingSound;
+		SoundPtr m_pendingSound;
+		std::atomic <bool> m_soundPending;
+		std::atomic_flag m_pendingSoundLock;
+
+		// the sound that m_playingSound replaced, kept so that
+		// AudioContext can release it on its housekeeping thread
+		SoundPtr m_retiredSound;
+
+		// the position in the sound advances by m_step, the ratio of
+		// the sound's sample rate to the emitter's as a 32.32 fixed
+		// point number, for each sample played; it and the emitter's
+		// length are only recalculated when the sample rate or sound
+		// is changed
+		std::atomic <uint64_t> m_step;
+		std::atomic <unsigned int> m_numSamples;
+
+		// filter used when the step isn't 1, shared with other
+		// emitters and effects resampling at similar ratios
+		std::atomic <ResampleQuality> m_resampleQuality;
+		std::atomic <const ResampleFilter *> m_filter;
+
+		std::atomic <bool> m_loop;
+		std::atomic <bool> m_paused;
+		std::atomic <float> m_volume;
+		std::atomic <float> m_balance;
+
+		// gains are only updated by the thread playing the
+		// emitter, when m_gainsChanged has been set
+		std::atomic <bool> m_gainsChanged;
+		float m_leftGain;
+		float m_rightGain;
+		float m_centerGain;
+
+		// setSampleIndex() stores the new index in m_seekIndex
+		// until the thread playing the emitter applies it
+		std::atomic <unsigned int> m_sampleIndex;
+		std::atomic <unsigned int> m_seekIndex;
+		std::atomic <bool> m_seekPending;
+
+		// number of samples of silence mixed before the sound starts
+		std::atomic <unsigned int> m_startDelay;
 
 		SoundEmitter(unsigned int sampleRate);
 		virtual ~SoundEmitter() { }
 
-		float getSampleIndexFactor() const;
+		void updateStep();
+		void updateGains();
+
+		/**
+		 * Applies sound, volume, balance and sample index changes made since the last block of samples was played.
+		 */
+		void applyChanges();
+
+		/**
+		 * Same as isDone(), without checking the sound set by setSound(), so that it can be used by the thread playing the emitter.
+		 */
+		bool isFinished() const;
+
+		/**
+		 * Advances the sample index by numSamples, passing the ranges of the emitter's associated Sound to be played to the given target. The target's read(), silence() and hold() methods are called for ranges of samples to copy from the sound, ranges past the end of a sound that doesn't loop, and the sample repeated while paused.
+		 */
+		template <typename Target> void render(Target &target, unsigned int numSamples);
+
+		/**
+		 * Gets the next block of samples of the emitter's associated Sound without applying the emitter's volume and balance, advancing the sample index.
+		 */
+		void renderNextSamples(Sample *samples, unsigned int numSamples);
+
+		/**
+		 * Gets the next block of samples of the emitter's associated Sound with all of its channels, without applying the emitter's volume and balance, advancing the sample index. Only used when the sound is played at its own sample rate.
+		 */
+		void renderNextPlanarSamples(SampleBuffer &buffer, unsigned int numSamples);
 
 	public:
 		uint8_t getNumChannels() const;
@@ -79,13 +153,25 @@ class SoundEmitter : public Sound
 		SoundPtr getSound() const;
 
 		/**
-		 * Sets the Sound associated with the emitter.
+		 * Sets the Sound associated with the emitter. The sound's sample rate and number of samples are read at this point, so this should be called again if they change (e.g. when changing the factor of a PitchShiftSoundEffect). If the emitter is playing, it switches to the new sound at the start of its next block of samples, and an AudioContext releases the previous sound on its housekeeping thread.
 		 * @param value SoundPtr to the emitter's associated Sound.
 		 */
-		void setSound(SoundPtr value);
+		void setSound(const SoundPtr &value);
 
 		unsigned int getNumSamples() const;
 
+		/**
+		 * Gets the resample quality of the emitter. This is the interpolation used when the emitter's sample rate isn't the same as its Sound's sample rate. The default is RESAMPLE_SINC8.
+		 * @return Resample quality.
+		 */
+		ResampleQuality getResampleQuality() const;
+
+		/**
+		 * Sets the resample quality of the emitter. This may create the filter used for the new quality, so it's best called before the emitter is attached.
+		 * @param value Resample quality.
+		 */
+		void setResampleQuality(ResampleQuality value);
+
 		/**
 		 * Gets the loop value of the emitter. This indicates whether the emitter will loop once the end of its associated Sound has been reached.
 		 * @return True if the emitter loops.
@@ -123,7 +209,7 @@ class SoundEmitter : public Sound
 		void setVolume(float value);
 
 		/**
-		 * Gets the balance of the emitter. This is a value from -1 to 1, with -1 indicating that samples returned by the emitter will be contained completely in the left channel, 0 being normal, and 1 indicating that returned samples will be contained completely in the right channel.
+		 * Gets the balance of the emitter. This is a value from -1 to 1, with -1 indicating that samples returned by the emitter will be contained completely in the left channel, 0 being normal, and 1 indicating that returned samples will be contained completely in the right channel. Samples are positioned with a constant-power pan law, so the total power stays the same as the balance changes.
 		 * @return Balance value with a range of [-1, 1].
 		 */
 		float getBalance() const;
@@ -146,6 +232,18 @@ class SoundEmitter : public Sound
 		 */
 		void setSampleIndex(unsigned int value);
 
+		/**
+		 * Gets the start delay of the emitter. This is the number of samples that mixNextSamples() skips over before the emitter starts playing, and counts down as they're skipped. AudioContext sets it to start emitters at scheduled times.
+		 * @return Number of samples left to skip.
+		 */
+		unsigned int getStartDelay() const;
+
+		/**
+		 * Sets the start delay of the emitter. This should only be called while the emitter isn't attached to an AudioContext.
+		 * @param value Number of samples to skip.
+		 */
+		void setStartDelay(unsigned int value);
+
 		/**
 		 * Gets a value indicating whether the emitter is done playing. This usually occurs when the emitter reaches the end of its associated Sound and is not supposed to loop.
 		 * @return True if the emitter is done playing its associated Sound.
@@ -153,6 +251,7 @@ class SoundEmitter : public Sound
 		bool isDone();
 
 		virtual Sample getSample(unsigned int sampleIndex) const;
+		virtual void getSamples(unsigned int sampleIndex, Sample *samples, unsigned int numSamples) const;
 
 		/**
 		 * Gets the next Sample of the emitter's associated Sound to be played.
@@ -160,6 +259,21 @@ class SoundEmitter : public Sound
 		 */
 		virtual Sample getNextSample();
 
+		/**
+		 * Gets the next block of samples of the emitter's associated Sound to be played. This is equivalent to calling getNextSample() numSamples times.
+		 * @param samples Array that numSamples Sample objects will be written to.
+		 * @param numSamples Number of samples to retrieve.
+		 */
+		virtual void getNextSamples(Sample *samples, unsigned int numSamples);
+
+		/**
+		 * Gets the next block of samples to be played like getNextSamples() and adds them to the given buffer. When the buffer doesn't have two channels, the samples are mixed into it with ChannelLayoutGetMixMatrix(). Mono sounds and sounds with more than two channels that are played at their own sample rate are mixed from planar buffers with all of their channels, using the speaker positions returned by Sound::getChannel(); otherwise the stereo Sample objects returned by the sound are mixed. Balance is applied to left and right side output channels, and volume to all of them.
+		 * @param samples Buffer of interleaved floating point samples to add to, numSamples * numChannels floats in length.
+		 * @param numSamples Number of samples to mix.
+		 * @param numChannels Number of channels in the buffer, up to MAX_CHANNELS.
+		 */
+		virtual void mixNextSamples(float *samples, unsigned int numSamples, unsigned int numChannels = 2);
+
 		/**
 		 * Creates a new SoundEmitter.
 		 * @param sampleRate The sample rate of the emitter to be created.
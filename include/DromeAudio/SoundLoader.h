@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_SOUNDLOADER_H__
+#define __DROMEAUDIO_SOUNDLOADER_H__
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <vector>
+#include <DromeAudio/Mutex.h>
+#include <DromeAudio/Semaphore.h>
+#include <DromeAudio/Sound.h>
+#include <DromeAudio/Thread.h>
+
+namespace DromeAudio {
+
+class SoundLoader;
+
+class SoundLoadRequest;
+typedef RefPtr <SoundLoadRequest> SoundLoadRequestPtr;
+
+/**
+ * Function used to load a sound, such as Sound::create() or WavSound::create().
+ */
+typedef SoundPtr (*SoundLoadFunction)(const char *filename);
+
+/**
+ * Function called on one of a SoundLoader's threads when a request is done or has failed, before threads waiting for the request are woken. It isn't called for cancelled requests.
+ */
+typedef void (*SoundLoadCallback)(SoundLoadRequest *request, void *userData);
+
+/**
+ * States of a SoundLoadRequest.
+ */
+enum SoundLoadState {
+	/** Waiting to be read or decoded. */
+	SOUND_LOAD_QUEUED,
+
+	/** Being decoded by one of the loader's threads. */
+	SOUND_LOAD_LOADING,
+
+	/** Loaded; getSound() returns the sound. */
+	SOUND_LOAD_DONE,
+
+	/** The load function threw an exception. */
+	SOUND_LOAD_FAILED,
+
+	/** Cancelled before it started loading. */
+	SOUND_LOAD_CANCELLED
+};
+
+/** \brief A handle to a sound being loaded in the background by a SoundLoader.
+ *
+ * Every method can be called from any thread. Polling getState() or isFinished() never blocks, so a game loop can check on requests every frame.
+ */
+class SoundLoadRequest : public RefClass
+{
+	friend class SoundLoader;
+
+	protected:
+		std::string m_filename;
+		SoundLoadFunction m_function;
+		SoundLoadCallback m_callback;
+		void *m_userData;
+		std::atomic <int> m_state;
+
+		// set before the state changes to SOUND_LOAD_DONE
+		SoundPtr m_sound;
+
+		// posted once when the request finishes
+		Semaphore *m_semaphore;
+
+		SoundLoadRequest(const std::string &filename, SoundLoadFunction function, SoundLoadCallback callback, void *userData);
+		virtual ~SoundLoadRequest();
+
+		void finish(SoundLoadState state);
+
+	public:
+		/**
+		 * @return The path of the file being loaded.
+		 */
+		const char *getFilename() const;
+
+		/**
+		 * @return The request's current state.
+		 */
+		SoundLoadState getState() const;
+
+		/**
+		 * @return True if the request is done, has failed or was cancelled.
+		 */
+		bool isFinished() const;
+
+		/**
+		 * @return The loaded sound if the request is done, or an unset SoundPtr otherwise.
+		 */
+		SoundPtr getSound() const;
+
+		/**
+		 * Cancels the request if it hasn't started loading yet. Sounds that are already being decoded can't be cancelled.
+		 * @return True if the request was cancelled.
+		 */
+		bool cancel();
+
+		/**
+		 * Waits until the request is finished.
+		 */
+		void wait();
+
+		/**
+		 * Waits up to the given number of milliseconds for the request to finish.
+		 * @param timeout Maximum number of milliseconds to wait; 0 returns immediately.
+		 * @return False if the timeout expired.
+		 */
+		bool wait(unsigned int timeout);
+};
+
+/** \brief Loads sounds in the background without blocking the calling thread.
+ *
+ * Requests are handled by two stages. A read thread reads each file from start to end so that its data is in the operating system's file cache, and a set of decode threads then create the sounds with the request's load function, which reads the file again from the cache. The read thread stays a few files ahead of the decode threads, so disk I/O overlaps with decoding, and the decode threads can use every core.
+ *
+ * Requests are started in the order they're made.
+ */
+class SoundLoader
+{
+	protected:
+		std::deque <SoundLoadRequestPtr> m_readQueue;
+		std::deque <SoundLoadRequestPtr> m_decodeQueue;
+		Mutex *m_mutex;
+
+		// posted for each request added to the read or decode queue
+		Semaphore *m_readSemaphore;
+		Semaphore *m_decodeSemaphore;
+
+		// posted for each free slot for a request that has been read
+		// and is waiting to be decoded
+		Semaphore *m_readAheadSemaphore;
+
+		Thread *m_readThread;
+		std::vector <Thread *> m_decodeThreads;
+		std::atomic <bool> m_running;
+
+		std::atomic <unsigned int> m_numRequests;
+		std::atomic <unsigned int> m_numFinished;
+		std::atomic <uint64_t> m_numBytesRead;
+
+		void finishRequest(const SoundLoadRequestPtr &request, SoundLoadState state);
+		SoundLoadRequestPtr popRequest(std::deque <SoundLoadRequestPtr> &queue);
+		static void readThread(void *arg);
+		static void decodeThread(void *arg);
+
+	public:
+		/**
+		 * Starts the loader's threads.
+		 * @param numThreads Number of decode threads; 0 uses one per processor.
+		 */
+		SoundLoader(unsigned int numThreads = 0);
+
+		/**
+		 * Cancels the requests that haven't started loading and waits for the ones being decoded to finish.
+		 */
+		~SoundLoader();
+
+		/**
+		 * @return The number of decode threads.
+		 */
+		unsigned int getNumThreads() const;
+
+		/**
+		 * Starts loading a sound in the background.
+		 * @param filename Path to the file to load.
+		 * @param function Function to load the sound with; NULL uses Sound::create().
+		 * @return Handle to the request, which can be polled for the sound.
+		 */
+		SoundLoadRequestPtr load(const char *filename, SoundLoadFunction function = NULL);
+
+		/**
+		 * Starts loading a sound in the background, calling a function on the loader's thread once it's loaded.
+		 * @param filename Path to the file to load.
+		 * @param function Function to load the sound with; NULL uses Sound::create().
+		 * @param callback Function called when the request is done or has failed. Once wait() returns for the request, the callback has returned.
+		 * @param userData Pointer passed to the callback.
+		 * @return Handle to the request, which can be polled for the sound.
+		 */
+		SoundLoadRequestPtr load(const char *filename, SoundLoadFunction function, SoundLoadCallback callback, void *userData);
+
+		/**
+		 * Starts loading a list of sounds in the background.
+		 * @param filenames Paths to the files to load.
+		 * @param requests Vector that a request for each file is appended to, in the same order.
+		 * @param function Function to load the sounds with; NULL uses Sound::create().
+		 */
+		void load(const std::vector <std::string> &filenames, std::vector <SoundLoadRequestPtr> &requests, SoundLoadFunction function = NULL);
+
+		/**
+		 * Starts loading the sounds listed in a manifest file. The manifest is read on the calling thread. It has one path per line, and relative paths are relative to the directory of the manifest. Empty lines and lines starting with '#' are ignored.
+		 * @param filename Path to the manifest file.
+		 * @param requests Vector that a request for each sound is appended to, in the order they're listed.
+		 * @param function Function to load the sounds with; NULL uses Sound::create().
+		 */
+		void loadManifest(const char *filename, std::vector <SoundLoadRequestPtr> &requests, SoundLoadFunction function = NULL);
+
+		/**
+		 * Cancels every request that hasn't started loading yet.
+		 */
+		void cancelAll();
+
+		/**
+		 * @return The number of requests made since the loader was created.
+		 */
+		unsigned int getNumRequests() const;
+
+		/**
+		 * @return The number of requests that are done, have failed or were cancelled.
+		 */
+		unsigned int getNumFinished() const;
+
+		/**
+		 * @return The fraction of requests that are finished, from 0 to 1; 1 if no requests were made.
+		 */
+		float getProgress() const;
+
+		/**
+		 * @return The number of bytes read from disk by the read thread.
+		 */
+		uint64_t getNumBytesRead() const;
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_SOUNDLOADER_H__ */
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_STREAMINGSOUND_H__
+#define __DROMEAUDIO_STREAMINGSOUND_H__
+
+#include <atomic>
+#include <DromeAudio/Mutex.h>
+#include <DromeAudio/Semaphore.h>
+#include <DromeAudio/Sound.h>
+#include <DromeAudio/Thread.h>
+
+namespace DromeAudio {
+
+class StreamingSound;
+typedef RefPtr <StreamingSound> StreamingSoundPtr;
+
+/** \brief The base class for sounds that are read from disk while they play instead of being loaded into memory.
+ *
+ * Samples are read in blocks into a ring buffer of fixed size by a background thread, which keeps the blocks following the position last played loaded, along with the block before it that resampled playback reads back into, so memory use doesn't depend on the length of the sound. Blocks that haven't been read yet when they're needed (e.g. right after a seek far from the current position) are played as silence and counted by getNumUnderruns(), unless blocking mode is enabled. SoundEmitter::setSampleIndex() tells the sound to start reading the new position right away to keep this short.
+ *
+ * The sound tracks a single play position, so it should only be played by one SoundEmitter at a time. getDataSize() returns 0 so that it's never converted by an AudioContext's conversion cache.
+ */
+class StreamingSound : public Sound
+{
+	protected:
+		unsigned char m_numChannels;
+		unsigned char m_bytesPerSample;
+		SampleFormat m_format;
+		unsigned int m_sampleRate;
+		unsigned int m_numSamples;
+
+		// ring of m_numBlocks blocks of m_blockSize samples each;
+		// m_blockIndices holds the number of the block of the sound
+		// stored in each slot, or INVALID_BLOCK while it's empty or
+		// being filled
+		unsigned int m_blockSize;
+		unsigned int m_numBlocks;
+		unsigned int m_numSoundBlocks;
+		uint8_t *m_blockData;
+		std::atomic <unsigned int> *m_blockIndices;
+
+		// index of the next sample expected to be played, which the
+		// reader thread keeps the following blocks loaded for
+		mutable std::atomic <unsigned int> m_cursor;
+		mutable std::atomic <unsigned int> m_numUnderruns;
+		std::atomic <bool> m_blocking;
+
+		// held while blocks are read, since readBlock() isn't
+		// expected to be thread safe
+		Mutex *m_readMutex;
+		Semaphore *m_semaphore;
+		Thread *m_thread;
+		std::atomic <bool> m_running;
+
+		StreamingSound();
+		virtual ~StreamingSound();
+
+		/**
+		 * Allocates the ring buffer, reads the first block and starts the reader thread. Derived classes call this at the end of their constructor, once the format members and readBlock() are ready.
+		 * @param bufferSize Size of the ring buffer in bytes.
+		 */
+		void start(unsigned int bufferSize);
+
+		/**
+		 * Stops the reader thread. Derived classes call this at the start of their destructor, before releasing anything readBlock() uses.
+		 */
+		void stop();
+
+		/**
+		 * Reads samples into a block of the ring buffer. Called by the reader thread, and by the thread requesting samples in blocking mode, with m_readMutex held.
+		 * @param index Index of the first sample to read; always a multiple of the block size.
+		 * @param data Buffer to write numSamples interleaved samples of m_bytesPerSample bytes each to, in m_format.
+		 * @param numSamples Number of samples to read.
+		 */
+		virtual void readBlock(unsigned int index, uint8_t *data, unsigned int numSamples) = 0;
+
+		int findBlock(unsigned int block) const;
+		int loadBlock(unsigned int block, unsigned int first, unsigned int window);
+		void fillBlocks();
+		static void readerThread(void *arg);
+
+		template <typename Output> void read(unsigned int index, unsigned int numSamples, Output &output) const;
+
+	public:
+		unsigned char getNumChannels() const;
+		unsigned int getSampleRate() const;
+		unsigned int getNumSamples() const;
+		size_t getDataSize() const;
+
+		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
+		void getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const;
+		void prefetch(unsigned int index);
+
+		/**
+		 * @return The size of the ring buffer in bytes.
+		 */
+		size_t getBufferSize() const;
+
+		/**
+		 * Gets the number of times that samples were requested from a block that wasn't loaded yet.
+		 * @return Number of underruns.
+		 */
+		unsigned int getNumUnderruns() const;
+
+		/**
+		 * @return True if blocking mode is enabled.
+		 */
+		bool getBlocking() const;
+
+		/**
+		 * Sets blocking mode. In blocking mode, blocks that aren't loaded when they're needed are read on the thread requesting them instead of being played as silence. This is meant for offline use (e.g. rendering with AudioDriverNull, Sound::save() or converting to a BufferSound) and shouldn't be enabled while the sound is played by an audio thread. Disabled by default.
+		 * @param value True to enable blocking mode.
+		 */
+		void setBlocking(bool value);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_STREAMINGSOUND_H__ */
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_STREAMINGVORBISSOUND_H__
+#define __DROMEAUDIO_STREAMINGVORBISSOUND_H__
+
+#include <vector>
+#include <DromeAudio/StreamingSound.h>
+
+namespace DromeAudio {
+
+class StreamingVorbisSound;
+typedef RefPtr <StreamingVorbisSound> StreamingVorbisSoundPtr;
+
+/** \brief A class for playing Ogg Vorbis files by decoding them while they play.
+ *
+ * See StreamingSound for how the file is decoded. Only the first block is decoded before the sound can be played, and memory use doesn't depend on the length of the file.
+ *
+ * Seeking in a Vorbis file normally bisects the file to find the page containing the new position. The positions in the file of blocks that have been decoded are remembered, so seeking back to them (e.g. when looping) jumps straight to a nearby page and decodes from there instead.
+ */
+class StreamingVorbisSound : public StreamingSound
+{
+	protected:
+		void *m_file;
+
+		// offset in the file of the page being read when the
+		// start of each block was decoded, or -1 if not known yet
+		std::vector <int64_t> m_seekIndex;
+
+		StreamingVorbisSound(const char *filename, unsigned int bufferSize);
+		virtual ~StreamingVorbisSound();
+
+		bool seek(unsigned int index);
+		void readBlock(unsigned int index, uint8_t *data, unsigned int numSamples);
+
+	public:
+		/**
+		 * Opens an Ogg Vorbis file for streaming. The first block of the file is decoded before this returns, so the sound can be played right away.
+		 * @param filename Path to the Ogg Vorbis file to open.
+		 * @param bufferSize Size of the ring buffer of decoded samples in bytes.
+		 * @return SoundPtr to the opened sound.
+		 */
+		static StreamingVorbisSoundPtr create(const char *filename, unsigned int bufferSize = 256 * 1024);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_STREAMINGVORBISSOUND_H__ */
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_STREAMINGWAVSOUND_H__
+#define __DROMEAUDIO_STREAMINGWAVSOUND_H__
+
+#include <cstdio>
+#include <DromeAudio/StreamingSound.h>
+
+namespace DromeAudio {
+
+class StreamingWavSound;
+typedef RefPtr <StreamingWavSound> StreamingWavSoundPtr;
+
+/** \brief A class for playing uncompressed PCM WAV files without loading them into memory.
+ *
+ * See StreamingSound for how the file is read.
+ */
+class StreamingWavSound : public StreamingSound
+{
+	protected:
+		FILE *m_fp;
+		uint64_t m_dataOffset;
+
+		StreamingWavSound(const char *filename, unsigned int bufferSize);
+		virtual ~StreamingWavSound();
+
+		void readBlock(unsigned int index, uint8_t *data, unsigned int numSamples);
+
+	public:
+		/**
+		 * Opens a WAV file for streaming. The first block of the file is read before this returns, so the sound can be played right away.
+		 * @param filename Path to the WAV file to open.
+		 * @param bufferSize Size of the ring buffer in bytes.
+		 * @return SoundPtr to the opened sound.
+		 */
+		static StreamingWavSoundPtr create(const char *filename, unsigned int bufferSize = 256 * 1024);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_STREAMINGWAVSOUND_H__ */
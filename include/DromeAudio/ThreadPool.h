@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_THREADPOOL_H__
+#define __DROMEAUDIO_THREADPOOL_H__
+
+#include <atomic>
+#include <vector>
+#include <DromeAudio/Semaphore.h>
+#include <DromeAudio/Thread.h>
+
+namespace DromeAudio {
+
+/** \brief A fixed set of worker threads for splitting work into independent tasks.
+ */
+class ThreadPool
+{
+	public:
+		typedef void (*Function)(void *arg, unsigned int index);
+
+	protected:
+		std::vector <Thread *> m_threads;
+		Semaphore *m_workSemaphore;
+		Semaphore *m_doneSemaphore;
+		bool m_running;
+
+		// the job currently being run; only one job runs at a time
+		std::atomic <bool> m_busy;
+		Function m_function;
+		void *m_arg;
+		unsigned int m_numTasks;
+		std::atomic <unsigned int> m_nextTask;
+
+		static void threadFunction(void *arg);
+		void runTasks();
+
+	public:
+		/**
+		 * Starts the pool's worker threads.
+		 * @param numThreads Number of worker threads; 0 uses one per processor, minus one for the thread calling run().
+		 */
+		ThreadPool(unsigned int numThreads = 0);
+
+		/**
+		 * Stops and joins the worker threads.
+		 */
+		~ThreadPool();
+
+		/**
+		 * @return The number of worker threads, not counting the thread calling run().
+		 */
+		unsigned int getNumThreads() const;
+
+		/**
+		 * Calls function(arg, index) for each index in [0, numTasks) and waits for all of the calls to return. The calling thread runs tasks too. If the pool is already running a job (e.g. run() is called from inside a task), the tasks are run on the calling thread instead.
+		 * @param function Function to call for each task. It must not throw.
+		 * @param arg Pointer passed through to the function.
+		 * @param numTasks Number of tasks.
+		 */
+		void run(Function function, void *arg, unsigned int numTasks);
+
+		/**
+		 * @return A pool shared by the whole process, with one thread per processor. It's created on first use.
+		 */
+		static ThreadPool *getShared();
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_THREADPOOL_H__ */
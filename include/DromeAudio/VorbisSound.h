@@ -27,6 +27,7 @@
 #define __DROMEAUDIO_VORBISSOUND_H__
 
 #include <DromeAudio/Sound.h>
+#include <DromeAudio/ThreadPool.h>
 
 namespace DromeAudio {
 
@@ -46,22 +47,26 @@ class VorbisSound : public Sound
 		uint32_t m_dataSize;
 		uint8_t *m_data;
 
-		VorbisSound(const char *filename);
+		VorbisSound(const char *filename, ThreadPool *pool);
 		virtual ~VorbisSound();
 
 	public:
 		unsigned char getNumChannels() const;
 		unsigned int getSampleRate() const;
 		unsigned int getNumSamples() const;
+		size_t getDataSize() const;
 
 		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
+		void getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const;
 
 		/**
 		 * Loads an Ogg Vorbis file.
 		 * @param filename Path to the Ogg Vorbis file to load.
+		 * @param pool If not NULL, the file is split into ranges that are decoded in parallel on the pool's threads (e.g. ThreadPool::getShared()). Each range opens the file separately.
 		 * @return SoundPtr to the loaded sound.
 		 */
-		static VorbisSoundPtr create(const char *filename);
+		static VorbisSoundPtr create(const char *filename, ThreadPool *pool = NULL);
 };
 
 } // namespace DromeAudio
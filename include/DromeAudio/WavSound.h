@@ -30,38 +30,59 @@
 
 namespace DromeAudio {
 
+class MappedFile;
+
 class WavSound;
 typedef RefPtr <WavSound> WavSoundPtr;
 
-/** \brief A class for loading uncompressed PCM WAV files.
+/** \brief A class for loading uncompressed WAV files.
+ *
+ * Supports 8, 16, 24 and 32-bit integer and 32-bit floating point samples, including files using WAVE_FORMAT_EXTENSIBLE. Samples are kept in their original format and converted to floating point as they're played.
  */
 class WavSound : public Sound
 {
 	protected:
 		unsigned char m_numChannels;
 		unsigned char m_bytesPerSample;
+		SampleFormat m_format;
 		unsigned int m_sampleRate;
 		unsigned int m_numSamples;
 
 		uint32_t m_dataSize;
-		uint8_t *m_data;
+		const uint8_t *m_data;
+
+		// set if m_data points into a mapping of the file
+		// rather than to memory owned by the sound
+		MappedFile *m_file;
 
-		WavSound(const char *filename);
+		WavSound(const char *filename, bool mapped);
 		virtual ~WavSound();
 
 	public:
 		unsigned char getNumChannels() const;
 		unsigned int getSampleRate() const;
 		unsigned int getNumSamples() const;
+		size_t getDataSize() const;
 
 		Sample getSample(unsigned int index) const;
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const;
+		void getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const;
+
+		/**
+		 * Gets a value indicating whether the sound's data is read straight from a mapping of the file.
+		 * @return True if the file is mapped.
+		 */
+		bool isMapped() const;
 
 		/**
 		 * Loads a WAV file.
+		 *
+		 * If mapped is true, the file is mapped into memory and, when the data is already in the host's format (8 and 24-bit samples, or any format on little endian hosts), samples are read straight from the mapping instead of being copied. Loading then takes the same time regardless of the size of the file, and the data's pages are shared through the page cache with other processes using the same file. Pages are read in when first touched, which may happen on the audio thread, and the file must not be modified while the sound exists. Other files are loaded into memory as usual.
 		 * @param filename Path to the WAV file to load.
+		 * @param mapped True to map the file into memory.
 		 * @return SoundPtr to the loaded sound.
 		 */
-		static WavSoundPtr create(const char *filename);
+		static WavSoundPtr create(const char *filename, bool mapped = false);
 };
 
 } // namespace DromeAudio
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Adpcm.h"
+
+namespace DromeAudio {
+
+static const int16_t ADPCM_STEP_TABLE[89] = {
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+	19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+	50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+	130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+	337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+	876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+	5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t ADPCM_INDEX_TABLE[16] = {
+	-1, -1, -1, -1, 2, 4, 6, 8,
+	-1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/*
+ * Applies one code to the predictor and step index; shared by the
+ * encoder and decoder so that they always agree.
+ */
+static inline void
+AdpcmStep(unsigned int code, int &predictor, int &index)
+{
+	int step = ADPCM_STEP_TABLE[index];
+
+	int diff = step >> 3;
+	diff += step & -(int)((code >> 2) & 1);
+	diff += (step >> 1) & -(int)((code >> 1) & 1);
+	diff += (step >> 2) & -(int)(code & 1);
+
+	predictor += (code & 8) ? -diff : diff;
+	predictor = (predictor < -32768) ? -32768 : ((predictor > 32767) ? 32767 : predictor);
+
+	index += ADPCM_INDEX_TABLE[code];
+	index = (index < 0) ? 0 : ((index > 88) ? 88 : index);
+}
+
+void
+AdpcmEncodeBlock(const int16_t *samples, unsigned int stride, unsigned int numSamples, AdpcmEncoderState &state, uint8_t *block)
+{
+	// the first sample is stored exactly in the header, so errors
+	// don't carry over from the previous block
+	int predictor = samples[0];
+	int index = state.index;
+
+	block[0] = (uint8_t)(predictor & 0xff);
+	block[1] = (uint8_t)((predictor >> 8) & 0xff);
+	block[2] = (uint8_t)index;
+	block[3] = 0;
+
+	uint8_t *codes = block + 4;
+	codes[ADPCM_BLOCK_SAMPLES / 2 - 1] = 0;
+	for(unsigned int i = 1; i < ADPCM_BLOCK_SAMPLES; i++) {
+		int sample = samples[(i < numSamples ? i : numSamples - 1) * stride];
+
+		// build the code from the largest steps down
+		int diff = sample - predictor;
+		unsigned int code = 0;
+		if(diff < 0) {
+			code = 8;
+			diff = -diff;
+		}
+
+		int step = ADPCM_STEP_TABLE[index];
+		if(diff >= step) {
+			code |= 4;
+			diff -= step;
+		}
+		step >>= 1;
+		if(diff >= step) {
+			code |= 2;
+			diff -= step;
+		}
+		step >>= 1;
+		if(diff >= step)
+			code |= 1;
+
+		AdpcmStep(code, predictor, index);
+
+		unsigned int n = i - 1;
+		if(n & 1)
+			codes[n / 2] |= (uint8_t)(code << 4);
+		else
+			codes[n / 2] = (uint8_t)code;
+	}
+
+	state.index = index;
+}
+
+void
+AdpcmDecodeBlock(const uint8_t *block, unsigned int numSamples, int16_t *samples, unsigned int stride)
+{
+	int predictor = (int16_t)(block[0] | (block[1] << 8));
+	int index = (block[2] > 88) ? 88 : block[2];
+
+	if(numSamples == 0)
+		return;
+	samples[0] = (int16_t)predictor;
+
+	const uint8_t *codes = block + 4;
+	for(unsigned int i = 1; i < numSamples; i++) {
+		unsigned int n = i - 1;
+		AdpcmStep((codes[n / 2] >> ((n & 1) * 4)) & 0x0f, predictor, index);
+		samples[i * stride] = (int16_t)predictor;
+	}
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_ADPCM_H__
+#define __DROMEAUDIO_ADPCM_H__
+
+#include <stdint.h>
+
+namespace DromeAudio {
+
+/*
+ * IMA ADPCM, coded in blocks of ADPCM_BLOCK_SAMPLES samples of one
+ * channel. Each block starts with a 4 byte header holding the first
+ * sample (16-bit little endian) and the step index that decoding starts
+ * from, followed by a 4-bit code for each of the other samples, low
+ * nibble first. Blocks don't depend on each other, so any block can be
+ * decoded on its own.
+ */
+static const unsigned int ADPCM_BLOCK_SAMPLES = 256;
+static const unsigned int ADPCM_BLOCK_SIZE = 4 + ADPCM_BLOCK_SAMPLES / 2;
+
+/*
+ * Step index carried from one block to the next by the encoder, so
+ * that each block starts with a step size suited to the signal.
+ */
+struct AdpcmEncoderState {
+	int index;
+};
+
+/*
+ * Encodes numSamples (at most ADPCM_BLOCK_SAMPLES) samples, read every
+ * stride values from samples, into a block. Shorter blocks are padded
+ * with the last sample.
+ */
+void AdpcmEncodeBlock(const int16_t *samples, unsigned int stride, unsigned int numSamples, AdpcmEncoderState &state, uint8_t *block);
+
+/*
+ * Decodes the first numSamples samples of a block, writing them every
+ * stride values to samples.
+ */
+void AdpcmDecodeBlock(const uint8_t *block, unsigned int numSamples, int16_t *samples, unsigned int stride);
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_ADPCM_H__ */
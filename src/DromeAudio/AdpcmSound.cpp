@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <DromeAudio/AdpcmSound.h>
+#include <DromeAudio/ChannelLayout.h>
+#include <DromeAudio/Exception.h>
+#include "Adpcm.h"
+#include "Mix.h"
+
+namespace DromeAudio {
+
+/*
+ * AdpcmSound class
+ */
+AdpcmSound::AdpcmSound(const SoundPtr &sound)
+{
+	m_numChannels = sound->getNumChannels();
+	m_sampleRate = sound->getSampleRate();
+	m_numSamples = sound->getNumSamples();
+	if(m_numSamples == 0)
+		throw Exception("AdpcmSound::AdpcmSound(): Can't compress a sound with an unlimited number of samples");
+	if(m_numChannels == 0 || m_numChannels > MAX_CHANNELS)
+		throw Exception("AdpcmSound::AdpcmSound(): Unsupported number of channels (%u)", m_numChannels);
+
+	m_numBlocks = (m_numSamples + ADPCM_BLOCK_SAMPLES - 1) / ADPCM_BLOCK_SAMPLES;
+	m_dataSize = (size_t)m_numBlocks * m_numChannels * ADPCM_BLOCK_SIZE;
+	m_data = new uint8_t [m_dataSize];
+
+	// compress a block of every channel at a time
+	SampleBuffer buffer(m_numChannels, ADPCM_BLOCK_SAMPLES);
+	int16_t samples[ADPCM_BLOCK_SAMPLES];
+	AdpcmEncoderState states[MAX_CHANNELS];
+	for(unsigned int c = 0; c < m_numChannels; c++)
+		states[c].index = 0;
+
+	uint8_t *data = m_data;
+	for(unsigned int i = 0; i < m_numSamples; i += ADPCM_BLOCK_SAMPLES) {
+		unsigned int count = m_numSamples - i;
+		if(count > ADPCM_BLOCK_SAMPLES)
+			count = ADPCM_BLOCK_SAMPLES;
+
+		sound->getPlanarSamples(i, buffer, 0, count);
+		for(unsigned int c = 0; c < m_numChannels; c++) {
+			MixFloatToInt16(samples, buffer.getChannel(c), count);
+			AdpcmEncodeBlock(samples, 1, count, states[c], data);
+			data += ADPCM_BLOCK_SIZE;
+		}
+	}
+}
+
+AdpcmSound::~AdpcmSound()
+{
+	delete [] m_data;
+}
+
+/*
+ * Decodes the first numSamples samples of each channel of a block into
+ * interleaved 16-bit samples.
+ */
+void
+AdpcmSound::decodeBlock(unsigned int block, unsigned int numSamples, int16_t *samples) const
+{
+	const uint8_t *data = m_data + (size_t)block * m_numChannels * ADPCM_BLOCK_SIZE;
+	for(unsigned int c = 0; c < m_numChannels; c++)
+		AdpcmDecodeBlock(data + c * ADPCM_BLOCK_SIZE, numSamples, samples + c, m_numChannels);
+}
+
+unsigned char
+AdpcmSound::getNumChannels() const
+{
+	return m_numChannels;
+}
+
+unsigned int
+AdpcmSound::getSampleRate() const
+{
+	return m_sampleRate;
+}
+
+unsigned int
+AdpcmSound::getNumSamples() const
+{
+	return m_numSamples;
+}
+
+size_t
+AdpcmSound::getDataSize() const
+{
+	return m_dataSize;
+}
+
+Sample
+AdpcmSound::getSample(unsigned int index) const
+{
+	Sample sample;
+	getSamples(index, &sample, 1);
+	return sample;
+}
+
+void
+AdpcmSound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	int16_t decoded[ADPCM_BLOCK_SAMPLES * MAX_CHANNELS];
+
+	index %= m_numSamples;
+
+	while(numSamples != 0) {
+		// decode up to the last sample needed from the block, stopping
+		// at the end of the sound to wrap around
+		unsigned int first = index % ADPCM_BLOCK_SAMPLES;
+		unsigned int count = ADPCM_BLOCK_SAMPLES - first;
+		if(count > m_numSamples - index)
+			count = m_numSamples - index;
+		if(count > numSamples)
+			count = numSamples;
+
+		decodeBlock(index / ADPCM_BLOCK_SAMPLES, first + count, decoded);
+		Sample::fromFormat(decoded + first * m_numChannels, SAMPLE_FORMAT_INT16, m_numChannels, samples, count, getChannelLayout());
+
+		samples += count;
+		numSamples -= count;
+		index += count;
+		if(index == m_numSamples)
+			index = 0;
+	}
+}
+
+void
+AdpcmSound::getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const
+{
+	int16_t decoded[ADPCM_BLOCK_SAMPLES * MAX_CHANNELS];
+
+	index %= m_numSamples;
+
+	while(numSamples != 0) {
+		unsigned int first = index % ADPCM_BLOCK_SAMPLES;
+		unsigned int count = ADPCM_BLOCK_SAMPLES - first;
+		if(count > m_numSamples - index)
+			count = m_numSamples - index;
+		if(count > numSamples)
+			count = numSamples;
+
+		decodeBlock(index / ADPCM_BLOCK_SAMPLES, first + count, decoded);
+		Sample::fromFormat(decoded + first * m_numChannels, SAMPLE_FORMAT_INT16, m_numChannels, buffer, offset, count);
+
+		offset += count;
+		numSamples -= count;
+		index += count;
+		if(index == m_numSamples)
+			index = 0;
+	}
+}
+
+AdpcmSoundPtr
+AdpcmSound::create(const SoundPtr &sound)
+{
+	return AdpcmSoundPtr(new AdpcmSound(sound));
+}
+
+} // namespace DromeAudio
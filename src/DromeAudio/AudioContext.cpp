@@ -24,22 +24,61 @@
  */
 
 #include <cstdio>
+#include <cstring>
+#include <utility>
+#include <DromeAudio/Exception.h>
 #include <DromeAudio/AudioContext.h>
+#include <DromeAudio/BufferSound.h>
+#include <DromeAudio/ChannelLayout.h>
+#include "Mix.h"
 
 namespace DromeAudio {
 
 /*
  * AudioContext class
  */
-AudioContext::AudioContext(unsigned int targetSampleRate)
+AudioContext::AudioContext(unsigned int targetSampleRate, unsigned int commandQueueSize, unsigned int numChannels)
+ : m_commands(commandQueueSize), m_completed(commandQueueSize), m_garbage(commandQueueSize * 2)
 {
-	m_mutex = Mutex::create();
+	if(numChannels == 0 || numChannels > MAX_CHANNELS)
+		throw Exception("AudioContext::AudioContext(): Unsupported number of channels (%u)", numChannels);
+
 	m_targetSampleRate = targetSampleRate;
+	m_numChannels = numChannels;
+	m_sampleTime = 0;
+	m_completedSemaphore = Semaphore::create();
+	m_completionReporting = false;
+
+	m_numPendingReleases = 0;
+	m_pendingReleaseDataSize = 0;
+	m_running = true;
+	m_garbageSemaphore = Semaphore::create();
+	m_garbageThread = Thread::create(garbageThread, this);
+
+	m_conversionCacheMutex = Mutex::create();
+	m_conversionCacheSize = 0;
+	m_conversionCacheBudget = 0;
+	m_conversionCacheClock = 0;
+
+	// make room for emitters and overflowing garbage up front so
+	// that they don't usually allocate memory on the audio thread
+	m_emitters.reserve(m_commands.getCapacity());
+	m_garbageOverflow.reserve(m_commands.getCapacity());
 }
 
 AudioContext::~AudioContext()
 {
-	delete m_mutex;
+	// stop the housekeeping thread and release
+	// whatever it didn't get around to
+	m_running = false;
+	m_garbageSemaphore->post();
+	delete m_garbageThread;
+	while(releaseGarbage())
+		;
+
+	delete m_garbageSemaphore;
+	delete m_completedSemaphore;
+	delete m_conversionCacheMutex;
 }
 
 unsigned int
@@ -48,56 +87,457 @@ AudioContext::getTargetSampleRate() const
 	return m_targetSampleRate;
 }
 
+unsigned int
+AudioContext::getNumChannels() const
+{
+	return m_numChannels;
+}
+
+uint64_t
+AudioContext::getSampleTime() const
+{
+	return m_sampleTime.load(std::memory_order_relaxed);
+}
+
+unsigned int
+AudioContext::getNumPendingReleases() const
+{
+	return m_numPendingReleases;
+}
+
+size_t
+AudioContext::getPendingReleaseDataSize() const
+{
+	return m_pendingReleaseDataSize;
+}
+
+void
+AudioContext::pushGarbage(Garbage &garbage)
+{
+	m_numPendingReleases++;
+	m_pendingReleaseDataSize += garbage.dataSize;
+
+	// if the queue is full, the garbage is kept until there's room
+	// instead of being released on this thread; anything already
+	// waiting goes first
+	if(!m_garbageOverflow.empty() || !m_garbage.push(garbage)) {
+		m_garbageOverflow.push_back(std::move(garbage));
+		return;
+	}
+
+	// drop this thread's references before the housekeeping thread is
+	// told about the garbage, so that the queue's reference is the
+	// last one
+	garbage.emitter = SoundEmitterPtr();
+	garbage.sound = SoundPtr();
+	m_garbageSemaphore->post();
+}
+
 void
-AudioContext::attachSoundEmitter(SoundEmitterPtr emitter)
+AudioContext::retryGarbage()
 {
-	m_mutex->lock();
-	m_emitters.insert(m_emitters.end(), emitter);
-	m_mutex->unlock();
+	unsigned int numPushed = 0;
+	while(numPushed < m_garbageOverflow.size() && m_garbage.push(m_garbageOverflow[numPushed])) {
+		m_garbageOverflow[numPushed].emitter = SoundEmitterPtr();
+		m_garbageOverflow[numPushed].sound = SoundPtr();
+		m_garbageSemaphore->post();
+		numPushed++;
+	}
+
+	m_garbageOverflow.erase(m_garbageOverflow.begin(), m_garbageOverflow.begin() + numPushed);
 }
 
 void
-AudioContext::detachSoundEmitter(SoundEmitterPtr emitter)
+AudioContext::releaseSoundEmitter(SoundEmitterPtr &emitter)
 {
-	m_mutex->lock();
+	// the sound the emitter plays is only read here, on the
+	// thread playing it
+	Garbage garbage;
+	garbage.dataSize = emitter->m_playingSound.IsSet() ? emitter->m_playingSound->getDataSize() : 0;
+	garbage.emitter = std::move(emitter);
+	pushGarbage(garbage);
+}
 
-	for(unsigned int i = 0; i < m_emitters.size(); i++) {
-		if(m_emitters[i] == emitter) {
-			m_emitters.erase(m_emitters.begin() + i);
+void
+AudioContext::releaseSound(SoundPtr &sound)
+{
+	Garbage garbage;
+	garbage.dataSize = sound->getDataSize();
+	garbage.sound = std::move(sound);
+	pushGarbage(garbage);
+}
+
+bool
+AudioContext::releaseGarbage()
+{
+	Garbage garbage;
+	if(!m_garbage.pop(garbage))
+		return false;
+
+	// dropping the references here destroys the emitter
+	// and sound if nothing else references them
+	garbage.emitter = SoundEmitterPtr();
+	garbage.sound = SoundPtr();
+
+	m_pendingReleaseDataSize -= garbage.dataSize;
+	m_numPendingReleases--;
+	return true;
+}
+
+void
+AudioContext::garbageThread(void *arg)
+{
+	AudioContext *context = (AudioContext *)arg;
+
+	// each post corresponds to one emitter whose references on the
+	// audio thread are already gone, so only release one per post
+	for(;;) {
+		context->m_garbageSemaphore->wait();
+		if(!context->m_running)
 			break;
+
+		context->releaseGarbage();
+	}
+}
+
+void
+AudioContext::trimConversionCache(size_t budget)
+{
+	// entries whose sound is only referenced by the cache can never
+	// be looked up again, so they're always dropped; while the mutex
+	// is locked, nothing can take a new reference to such a sound
+	for(unsigned int i = 0; i < m_conversionCache.size(); ) {
+		if(m_conversionCache[i].sound->GetRefCount() != 1) {
+			i++;
+			continue;
+		}
+
+		m_conversionCacheSize -= m_conversionCache[i].convertedSound->getDataSize();
+		m_conversionCache.erase(m_conversionCache.begin() + i);
+	}
+
+	while(m_conversionCacheSize > budget) {
+		// evict the least recently used sound
+		unsigned int oldest = 0;
+		for(unsigned int i = 1; i < m_conversionCache.size(); i++) {
+			if(m_conversionCache[i].lastUsed < m_conversionCache[oldest].lastUsed)
+				oldest = i;
+		}
+
+		m_conversionCacheSize -= m_conversionCache[oldest].convertedSound->getDataSize();
+		m_conversionCache.erase(m_conversionCache.begin() + oldest);
+	}
+}
+
+void
+AudioContext::setConversionCacheBudget(size_t budget)
+{
+	m_conversionCacheMutex->lock();
+	m_conversionCacheBudget = budget;
+	trimConversionCache(budget);
+	m_conversionCacheMutex->unlock();
+}
+
+size_t
+AudioContext::getConversionCacheBudget() const
+{
+	m_conversionCacheMutex->lock();
+	size_t budget = m_conversionCacheBudget;
+	m_conversionCacheMutex->unlock();
+
+	return budget;
+}
+
+size_t
+AudioContext::getConversionCacheSize() const
+{
+	m_conversionCacheMutex->lock();
+	size_t size = m_conversionCacheSize;
+	m_conversionCacheMutex->unlock();
+
+	return size;
+}
+
+bool
+AudioContext::needsConversion(const SoundPtr &sound) const
+{
+	// only sounds with data in memory are worth converting; generated
+	// sounds are as cheap to play as a copy would be
+	return (sound.IsSet() && sound->getSampleRate() != m_targetSampleRate &&
+	        sound->getNumSamples() != 0 && sound->getDataSize() != 0);
+}
+
+/*
+ * Gets the converted copy of a sound, or an unset SoundPtr if there
+ * isn't one; the mutex must be locked.
+ */
+SoundPtr
+AudioContext::findConvertedSound(const SoundPtr &sound)
+{
+	for(unsigned int i = 0; i < m_conversionCache.size(); i++) {
+		ConversionCacheEntry &entry = m_conversionCache[i];
+		if(entry.sound == sound && entry.sampleRate == m_targetSampleRate) {
+			entry.lastUsed = ++m_conversionCacheClock;
+			return entry.convertedSound;
+		}
+	}
+
+	return SoundPtr();
+}
+
+SoundPtr
+AudioContext::preloadSound(const SoundPtr &sound)
+{
+	if(!needsConversion(sound))
+		return sound;
+
+	m_conversionCacheMutex->lock();
+
+	if(m_conversionCacheBudget == 0) {
+		m_conversionCacheMutex->unlock();
+		return sound;
+	}
+
+	trimConversionCache(m_conversionCacheBudget);
+	SoundPtr convertedSound = findConvertedSound(sound);
+	if(convertedSound.IsSet()) {
+		m_conversionCacheMutex->unlock();
+		return convertedSound;
+	}
+
+	// don't bother converting sounds that can't fit in the budget
+	uint64_t size = (uint64_t)sound->getNumSamples() * m_targetSampleRate / sound->getSampleRate() * sizeof(Sample);
+	if(size > m_conversionCacheBudget) {
+		m_conversionCacheMutex->unlock();
+		return sound;
+	}
+
+	m_conversionCacheMutex->unlock();
+
+	// convert without holding the mutex, so that playSound() and
+	// other preloads don't wait for it
+	try {
+		convertedSound = BufferSound::create(sound, m_targetSampleRate);
+	} catch(Exception ex) {
+		return sound;
+	}
+
+	m_conversionCacheMutex->lock();
+
+	// another thread may have converted the same sound meanwhile
+	SoundPtr existingSound = findConvertedSound(sound);
+	if(existingSound.IsSet()) {
+		m_conversionCacheMutex->unlock();
+		return existingSound;
+	}
+
+	// make room for the new sound before adding it; the estimate
+	// above can be off by a sample, and the budget may have changed,
+	// so check the actual size too
+	size_t convertedSize = convertedSound->getDataSize();
+	if(m_conversionCacheBudget == 0 || convertedSize > m_conversionCacheBudget) {
+		m_conversionCacheMutex->unlock();
+		return sound;
+	}
+
+	ConversionCacheEntry entry;
+	entry.sound = sound;
+	entry.convertedSound = convertedSound;
+	entry.sampleRate = m_targetSampleRate;
+	entry.lastUsed = ++m_conversionCacheClock;
+
+	trimConversionCache(m_conversionCacheBudget - convertedSize);
+	m_conversionCache.push_back(entry);
+	m_conversionCacheSize += convertedSize;
+
+	m_conversionCacheMutex->unlock();
+	return convertedSound;
+}
+
+void
+AudioContext::clearConversionCache()
+{
+	m_conversionCacheMutex->lock();
+	m_conversionCache.clear();
+	m_conversionCacheSize = 0;
+	m_conversionCacheMutex->unlock();
+}
+
+void
+AudioContext::pushCommand(Command::Type type, const SoundEmitterPtr &emitter, uint64_t startTime)
+{
+	Command command;
+	command.type = type;
+	command.emitter = emitter;
+	command.startTime = startTime;
+
+	if(!m_commands.push(command))
+		throw Exception("AudioContext::pushCommand(): Command queue is full");
+}
+
+void
+AudioContext::processCommands()
+{
+	Command command;
+
+	while(m_commands.pop(command)) {
+		switch(command.type) {
+			case Command::ATTACH: {
+				// emitters scheduled for a later period or later in
+				// this one are mixed with silence until they start
+				uint64_t sampleTime = m_sampleTime.load(std::memory_order_relaxed);
+				uint64_t delay = 0;
+				if(command.startTime > sampleTime)
+					delay = command.startTime - sampleTime;
+				if(delay > 0xffffffff)
+					delay = 0xffffffff;
+
+				command.emitter->setStartDelay((unsigned int)delay);
+				m_emitters.insert(m_emitters.end(), command.emitter);
+				break;
+			}
+			case Command::DETACH:
+				for(unsigned int i = 0; i < m_emitters.size(); i++) {
+					if(m_emitters[i] == command.emitter) {
+						m_emitters.erase(m_emitters.begin() + i);
+						break;
+					}
+				}
+
+				releaseSoundEmitter(command.emitter);
+				break;
 		}
 	}
+}
 
-	m_mutex->unlock();
+void
+AudioContext::reapSoundEmitters()
+{
+	for(unsigned int i = 0; i < m_emitters.size(); ) {
+		if(m_emitters[i]->isFinished() == false) {
+			i++;
+			continue;
+		}
+
+		// mixing order doesn't matter, so avoid shifting
+		// the rest of the emitters down
+		SoundEmitterPtr emitter = std::move(m_emitters[i]);
+		m_emitters[i] = std::move(m_emitters.back());
+		m_emitters.pop_back();
+
+		// pass the emitter back to the application if it asked for
+		// completed emitters, dropping this thread's reference first
+		// for the same reason as in releaseSoundEmitter(); otherwise,
+		// or if the queue is full, the emitter goes to the
+		// housekeeping thread so the queue doesn't keep it alive
+		if(m_completionReporting.load(std::memory_order_relaxed) && m_completed.push(emitter)) {
+			emitter = SoundEmitterPtr();
+			m_completedSemaphore->post();
+		} else {
+			releaseSoundEmitter(emitter);
+		}
+	}
+}
+
+void
+AudioContext::attachSoundEmitter(const SoundEmitterPtr &emitter, uint64_t startTime)
+{
+	pushCommand(Command::ATTACH, emitter, startTime);
+}
+
+void
+AudioContext::detachSoundEmitter(const SoundEmitterPtr &emitter)
+{
+	pushCommand(Command::DETACH, emitter);
 }
 
 SoundEmitterPtr
-AudioContext::playSound(SoundPtr sound)
+AudioContext::playSound(const SoundPtr &sound, uint64_t startTime)
 {
 	SoundEmitterPtr emitter = SoundEmitter::create(m_targetSampleRate);
-	emitter->setSound(sound);
 
-	attachSoundEmitter(emitter);
+	// only a copy converted by preloadSound() is used; the sound is
+	// resampled as it's played otherwise
+	SoundPtr convertedSound;
+	if(needsConversion(sound)) {
+		m_conversionCacheMutex->lock();
+		trimConversionCache(m_conversionCacheBudget);
+		convertedSound = findConvertedSound(sound);
+		m_conversionCacheMutex->unlock();
+	}
+
+	emitter->setSound(convertedSound.IsSet() ? convertedSound : sound);
+
+	attachSoundEmitter(emitter, startTime);
 	return emitter;
 }
 
 void
-AudioContext::writeSamples(AudioDriver *driver, unsigned int numSamples)
+AudioContext::setCompletionReporting(bool value)
 {
-	m_mutex->lock();
+	m_completionReporting.store(value, std::memory_order_relaxed);
+}
 
-	for(unsigned int i = 0; i < numSamples; i++) {
-		Sample sample;
+bool
+AudioContext::getCompletionReporting() const
+{
+	return m_completionReporting.load(std::memory_order_relaxed);
+}
 
-		// mix samples from all emitters
-		for(unsigned int j = 0; j < m_emitters.size(); j++)
-			sample += m_emitters[j]->getNextSample();
+SoundEmitterPtr
+AudioContext::getCompletedSoundEmitter(unsigned int timeout)
+{
+	SoundEmitterPtr emitter;
 
-		// write sample data
-		driver->writeSample(sample.clamp());
+	// each completed emitter posts the semaphore once,
+	// so a successful wait means the queue isn't empty
+	if(m_completedSemaphore->wait(timeout))
+		m_completed.pop(emitter);
+
+	return emitter;
+}
+
+unsigned int
+AudioContext::dispatchCompletedSoundEmitters(CompletionCallback callback, void *userData)
+{
+	unsigned int numDispatched = 0;
+
+	while(m_completedSemaphore->wait(0)) {
+		SoundEmitterPtr emitter;
+		m_completed.pop(emitter);
+
+		callback(emitter, userData);
+		numDispatched++;
 	}
 
-	m_mutex->unlock();
+	return numDispatched;
+}
+
+void
+AudioContext::writeSamples(float *samples, unsigned int numSamples)
+{
+	memset(samples, 0, sizeof(float) * numSamples * m_numChannels);
+
+	// pass on garbage that the queue had no room for last
+	// period, then apply attach and detach requests
+	if(!m_garbageOverflow.empty())
+		retryGarbage();
+	processCommands();
+
+	// mix samples from all emitters, passing sounds that they
+	// stopped playing to the housekeeping thread
+	for(unsigned int i = 0; i < m_emitters.size(); i++) {
+		m_emitters[i]->mixNextSamples(samples, numSamples, m_numChannels);
+		if(m_emitters[i]->m_retiredSound.IsSet())
+			releaseSound(m_emitters[i]->m_retiredSound);
+	}
+
+	// detach emitters that are done playing
+	reapSoundEmitters();
+
+	MixClamp(samples, numSamples * m_numChannels);
+
+	m_sampleTime.store(m_sampleTime.load(std::memory_order_relaxed) + numSamples, std::memory_order_relaxed);
 }
 
 } // namespace DromeAudio
@@ -24,6 +24,7 @@
  */
 
 #include <DromeAudio/Exception.h>
+#include <DromeAudio/AudioContext.h>
 #include <DromeAudio/AudioDriver.h>
 #ifdef WITH_ALSA
 	#include <DromeAudio/AudioDriverALSA.h>
@@ -41,6 +42,7 @@ namespace DromeAudio {
 AudioDriver::AudioDriver()
 {
 	m_sampleRate = 0;
+	m_numChannels = 2;
 	m_audioContext = 0;
 }
 
@@ -54,6 +56,12 @@ AudioDriver::getSampleRate() const
 	return m_sampleRate;
 }
 
+unsigned int
+AudioDriver::getNumChannels() const
+{
+	return m_numChannels;
+}
+
 AudioContext *
 AudioDriver::getAudioContext() const
 {
@@ -63,20 +71,39 @@ AudioDriver::getAudioContext() const
 void
 AudioDriver::setAudioContext(AudioContext *value)
 {
+	if(value && value->getNumChannels() != m_numChannels)
+		throw Exception("AudioDriver::setAudioContext(): Audio context has %u channels, driver has %u", value->getNumChannels(), m_numChannels);
+
 	m_audioContext = value;
 }
 
+void
+AudioDriver::renderSamples(float *samples, unsigned int numSamples)
+{
+	if(m_audioContext) {
+		m_audioContext->writeSamples(samples, numSamples);
+	} else {
+		for(unsigned int i = 0; i < numSamples * m_numChannels; i++)
+			samples[i] = 0.0f;
+	}
+}
+
 AudioDriver *
-AudioDriver::create()
+AudioDriver::create(unsigned int numChannels)
 {
 #ifdef WITH_ALSA
-	return new AudioDriverALSA();
+	return new AudioDriverALSA(numChannels);
 #elif WITH_OSX
+	// stereo is the only layout this driver opens, so it's the
+	// nearest available to any other number of channels
+	(void)numChannels;
 	return new AudioDriverOSX();
 #elif WITH_SDL
+	// the SDL driver only opens stereo devices too
+	(void)numChannels;
 	return new AudioDriverSDL();
 #else
-	throw Exception("AudioDriver::create(): No suitable driver available");
+	throw Exception("AudioDriver::create(): No suitable driver available for %u channels", numChannels);
 #endif
 }
 
@@ -23,7 +23,9 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <alsa/asoundlib.h>
+#include <DromeAudio/ChannelLayout.h>
 #include <DromeAudio/Exception.h>
 #include <DromeAudio/Endian.h>
 #include <DromeAudio/AudioContext.h>
@@ -44,12 +46,10 @@ static void alsaAudioCallback(snd_async_handler_t *handler)
 /*
  * AudioDriverALSA class
  */
-AudioDriverALSA::AudioDriverALSA()
+AudioDriverALSA::AudioDriverALSA(unsigned int numChannels)
 {
-	const unsigned int numChannels = 2;
-
-	m_sampleIndex = 0;
-	m_numSamples = 0;
+	m_data = NULL;
+	m_bufferSize = 0;
 
 	// open pcm device
 	if(snd_pcm_open((snd_pcm_t **)&m_handle, "default", SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK) != 0)
@@ -76,14 +76,28 @@ AudioDriverALSA::AudioDriverALSA()
 		throw Exception("AudioDriverALSA::AudioDriverALSA(): snd_pcm_hw_params_set_rate_near failed");
 
 	// set number of channels
-	if(snd_pcm_hw_params_set_channels((snd_pcm_t *)m_handle, params, numChannels) != 0)
-		throw Exception("AudioDriverALSA::AudioDriverALSA(): snd_pcm_hw_params_set_channels failed");
+	if(numChannels == 0 || numChannels > MAX_CHANNELS)
+		throw Exception("AudioDriverALSA::AudioDriverALSA(): Unsupported number of channels (%u)", numChannels);
+	if(snd_pcm_hw_params_set_channels_near((snd_pcm_t *)m_handle, params, &numChannels) != 0)
+		throw Exception("AudioDriverALSA::AudioDriverALSA(): snd_pcm_hw_params_set_channels_near failed");
+	if(numChannels > MAX_CHANNELS)
+		throw Exception("AudioDriverALSA::AudioDriverALSA(): Unsupported number of channels (%u)", numChannels);
+	m_numChannels = numChannels;
 
 	// apply parameters
 	if(snd_pcm_hw_params((snd_pcm_t *)m_handle, params) != 0)
 		throw Exception("AudioDriverALSA::AudioDriverALSA(): snd_pcm_hw_params failed");
+
+	// allocate a buffer large enough for the whole ring buffer so that
+	// any number of available frames can be written in one call
+	snd_pcm_uframes_t bufferSize;
+	if(snd_pcm_hw_params_get_buffer_size(params, &bufferSize) != 0)
+		throw Exception("AudioDriverALSA::AudioDriverALSA(): snd_pcm_hw_params_get_buffer_size failed");
 	snd_pcm_hw_params_free(params);
 
+	m_bufferSize = (unsigned int)bufferSize;
+	m_data = new float[m_bufferSize * numChannels];
+
 	// prepare PCM
 	if(snd_pcm_prepare((snd_pcm_t *)m_handle) != 0)
 		throw Exception("AudioDriverALSA::AudioDriverALSA(): snd_pcm_prepare failed");
@@ -94,18 +108,22 @@ AudioDriverALSA::AudioDriverALSA()
 
 	// the async handler will be called for the first time
 	// after we write all of the initial output frames
-	float f[2] = { 0.0f, 0.0f };
 	snd_pcm_sframes_t frames = snd_pcm_avail_update((snd_pcm_t *)m_handle);
 	if(frames < 0)
 		throw Exception("AudioDriverALSA::AudioDriverALSA(): frames < 0 (%d)", (int)frames);
-	for(snd_pcm_sframes_t i = 0; i < frames; ++i)
-		snd_pcm_writei((snd_pcm_t *)m_handle, f, 1);
+	if((snd_pcm_uframes_t)frames > bufferSize)
+		frames = (snd_pcm_sframes_t)bufferSize;
+	for(unsigned int i = 0; i < (unsigned int)frames * numChannels; i++)
+		m_data[i] = 0.0f;
+	snd_pcm_writei((snd_pcm_t *)m_handle, m_data, frames);
 }
 
 AudioDriverALSA::~AudioDriverALSA()
 {
 	snd_async_del_handler((snd_async_handler_t *)m_asyncHandler);
 	snd_pcm_drain((snd_pcm_t *)m_handle);
+
+	delete [] m_data;
 }
 
 const char *
@@ -114,18 +132,6 @@ AudioDriverALSA::getDriverName() const
 	return "AudioDriverALSA";
 }
 
-void
-AudioDriverALSA::writeSample(const Sample &sample)
-{
-	if(m_sampleIndex >= m_numSamples)
-		return;
-
-	m_data[m_sampleIndex * 2 + 0] = sample[0];
-	m_data[m_sampleIndex * 2 + 1] = sample[1];
-
-	++m_sampleIndex;
-}
-
 void
 AudioDriverALSA::alsaCallback()
 {
@@ -133,20 +139,23 @@ AudioDriverALSA::alsaCallback()
 	if(frames < 0)
 		throw Exception("AudioDriverALSA::ALSACallback(): frames < 0 (%d)", (int)frames);
 
-	m_sampleIndex = 0;
-	m_numSamples = (unsigned int)frames;
-	m_data = new float[m_numSamples * 2];
+	unsigned int numSamples = (unsigned int)frames;
+	if(numSamples > m_bufferSize)
+		numSamples = m_bufferSize;
 
-	if(m_audioContext) {
-		m_audioContext->writeSamples(this, m_numSamples);
-	} else {
-		for(unsigned int i = 0; i < m_numSamples * 2; i++)
-			m_data[i] = 0.0f;
-	}
+	renderSamples(m_data, numSamples);
 
-	snd_pcm_writei((snd_pcm_t *)m_handle, m_data, m_numSamples);
+	// ALSA puts the back channels of 5.1 and 7.1 before the
+	// center and low frequency channels, unlike WAV order
+	if(m_numChannels == 6 || m_numChannels == 8) {
+		for(unsigned int i = 0; i < numSamples; i++) {
+			float *frame = m_data + i * m_numChannels;
+			std::swap(frame[2], frame[4]);
+			std::swap(frame[3], frame[5]);
+		}
+	}
 
-	delete [] m_data;
+	snd_pcm_writei((snd_pcm_t *)m_handle, m_data, numSamples);
 }
 
 } // namespace DromeAudio
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/AudioDriverFile.h>
+#include "WavWriter.h"
+
+namespace DromeAudio {
+
+/*
+ * AudioDriverFile class
+ */
+AudioDriverFile::AudioDriverFile(const char *filename, unsigned int sampleRate, unsigned int numChannels, unsigned int periodSize, SampleFormat format, bool dither)
+ : AudioDriverNull(sampleRate, numChannels, periodSize)
+{
+	m_writer = new WavWriter(filename, sampleRate, numChannels, format, dither);
+}
+
+AudioDriverFile::~AudioDriverFile()
+{
+	delete m_writer;
+}
+
+const char *
+AudioDriverFile::getDriverName() const
+{
+	return "AudioDriverFile";
+}
+
+void
+AudioDriverFile::writePeriod(const float *samples, unsigned int numSamples)
+{
+	m_writer->write(samples, numSamples);
+}
+
+void
+AudioDriverFile::close()
+{
+	m_writer->close();
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <DromeAudio/ChannelLayout.h>
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/AudioDriverNull.h>
+
+namespace DromeAudio {
+
+/*
+ * AudioDriverNull class
+ */
+AudioDriverNull::AudioDriverNull(unsigned int sampleRate, unsigned int numChannels, unsigned int periodSize)
+{
+	if(numChannels == 0 || numChannels > MAX_CHANNELS)
+		throw Exception("AudioDriverNull::AudioDriverNull(): Unsupported number of channels (%u)", numChannels);
+	if(periodSize == 0)
+		throw Exception("AudioDriverNull::AudioDriverNull(): Period size must not be 0");
+
+	m_sampleRate = sampleRate;
+	m_numChannels = numChannels;
+	m_periodSize = periodSize;
+	m_sampleTime = 0;
+	m_data = new float[periodSize * numChannels];
+}
+
+AudioDriverNull::~AudioDriverNull()
+{
+	delete [] m_data;
+}
+
+const char *
+AudioDriverNull::getDriverName() const
+{
+	return "AudioDriverNull";
+}
+
+unsigned int
+AudioDriverNull::getPeriodSize() const
+{
+	return m_periodSize;
+}
+
+uint64_t
+AudioDriverNull::getSampleTime() const
+{
+	return m_sampleTime;
+}
+
+void
+AudioDriverNull::writePeriod(const float * /*samples*/, unsigned int /*numSamples*/)
+{
+}
+
+void
+AudioDriverNull::render(uint64_t numSamples)
+{
+	while(numSamples != 0) {
+		unsigned int count = m_periodSize;
+		if(count > numSamples)
+			count = (unsigned int)numSamples;
+
+		renderSamples(m_data, count);
+		writePeriod(m_data, count);
+
+		m_sampleTime += count;
+		numSamples -= count;
+	}
+}
+
+} // namespace DromeAudio
@@ -60,11 +60,6 @@ AudioDriverOSX::AudioDriverOSX()
 {
 	m_sampleRate = 44100.0;
 
-	m_data[0] = NULL;
-	m_data[1] = NULL;
-	m_sampleIndex = 0;
-	m_numSamples = 0;
-
 	// create AudioComponentDescription
 	AudioComponentDescription desc;
 	desc.componentType = kAudioUnitType_Output;
@@ -150,18 +145,6 @@ AudioDriverOSX::getDriverName() const
 	return "AudioDriverOSX";
 }
 
-void
-AudioDriverOSX::writeSample(const Sample &sample)
-{
-	if(m_sampleIndex >= m_numSamples)
-		return;
-
-	m_data[0][m_sampleIndex] = sample[0];
-	m_data[1][m_sampleIndex] = sample[1];
-
-	++m_sampleIndex;
-}
-
 void
 AudioDriverOSX::runLoop()
 {
@@ -176,19 +159,9 @@ AudioDriverOSX::renderCallback(AudioUnitRenderActionFlags * /*ioActionFlags*/,
                                UInt32 inNumberFrames,
                                AudioBufferList *ioData)
 {
-	m_data[0] = (float *)ioData->mBuffers[0].mData;
-	m_data[1] = (float *)ioData->mBuffers[1].mData;
-	m_sampleIndex = 0;
-	m_numSamples = inNumberFrames;
-
-	if(m_audioContext) {
-		m_audioContext->writeSamples(this, m_numSamples);
-	} else {
-		for(unsigned int i = 0; i < m_numSamples; i++) {
-			m_data[0][i] = 0.0f;
-			m_data[1][i] = 0.0f;
-		}
-	}
+	// the stream format is packed, interleaved stereo floating point,
+	// so the context can mix straight into the output buffer
+	renderSamples((float *)ioData->mBuffers[0].mData, inNumberFrames);
 }
 
 } // namespace DromeAudio
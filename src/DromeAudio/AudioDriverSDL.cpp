@@ -28,6 +28,7 @@
 #include <DromeAudio/Endian.h>
 #include <DromeAudio/AudioContext.h>
 #include <DromeAudio/AudioDriverSDL.h>
+#include "Mix.h"
 
 namespace DromeAudio
 {
@@ -36,9 +37,9 @@ static const unsigned int RATES[] = { 44100, 22050, 11025 };
 static const unsigned int NUM_RATES = sizeof(RATES) / sizeof(RATES[0]);
 
 static void
-SdlAudioCallback(void *driver, Uint8 *stream, int length)
+sdlAudioCallback(void *driver, Uint8 *stream, int length)
 {
-	((AudioDriverSDL *)driver)->SdlCallback(stream, length);
+	((AudioDriverSDL *)driver)->sdlCallback(stream, length);
 }
 
 /*
@@ -46,9 +47,8 @@ SdlAudioCallback(void *driver, Uint8 *stream, int length)
  */
 AudioDriverSDL::AudioDriverSDL()
 {
-	m_Data = NULL;
-	m_SampleIndex = 0;
-	m_NumSamples = 0;
+	m_data = NULL;
+	m_bufferSize = 0;
 
 	// initialize SDL audio if necessary
 	if(!(SDL_WasInit(0) & SDL_INIT_AUDIO)) {
@@ -61,60 +61,57 @@ AudioDriverSDL::AudioDriverSDL()
 	spec.format = AUDIO_S16SYS;
 	spec.channels = 2;
 	spec.samples = 512;
-	spec.callback = SdlAudioCallback;
+	spec.callback = sdlAudioCallback;
 	spec.userdata = this;
 
 	// find a working sample rate
-	m_SampleRate = 0;
+	m_sampleRate = 0;
 	for(unsigned int i = 0; i < NUM_RATES; i++) {
 		spec.freq = RATES[i];
 		if(SDL_OpenAudio(&spec, NULL) != -1) {
-			m_SampleRate = RATES[i];
+			m_sampleRate = RATES[i];
 			break;
 		}
 	}
 
-	if(m_SampleRate == 0)
+	if(m_sampleRate == 0)
 		throw Exception("AudioDriverSDL::AudioDriverSDL(): Couldn't find a working sample rate: %s", SDL_GetError());
 
+	// allocate a floating point buffer for one period,
+	// which is converted to 16-bit samples for SDL
+	m_bufferSize = spec.samples;
+	m_data = new float[m_bufferSize * 2];
+
 	SDL_PauseAudio(0);
 }
 
 AudioDriverSDL::~AudioDriverSDL()
 {
 	SDL_CloseAudio();
+
+	delete [] m_data;
 }
 
 const char *
-AudioDriverSDL::GetDriverName() const
+AudioDriverSDL::getDriverName() const
 {
 	return "AudioDriverSDL";
 }
 
 void
-AudioDriverSDL::WriteSample(const Sample &sample)
+AudioDriverSDL::sdlCallback(uint8_t *stream, int length)
 {
-	if(m_SampleIndex >= m_NumSamples)
-		return;
+	int16_t *data = (int16_t *)stream;
+	unsigned int numSamples = (unsigned int)length / 4;
 
-	m_Data[m_SampleIndex * 2 + 0] = (int16_t)(32767.0f * sample[0]);
-	m_Data[m_SampleIndex * 2 + 1] = (int16_t)(32767.0f * sample[1]);
+	while(numSamples != 0) {
+		unsigned int count = (numSamples < m_bufferSize) ? numSamples : m_bufferSize;
 
-	++m_SampleIndex;
-}
+		renderSamples(m_data, count);
+		MixFloatToInt16(data, m_data, count * 2);
 
-void
-AudioDriverSDL::SdlCallback(uint8_t *stream, int length)
-{
-	m_Data = (int16_t *)stream;
-	m_SampleIndex = 0;
-	m_NumSamples = length / 4;
-
-	if(m_AudioContext) {
-		m_AudioContext->WriteSamples(this, m_NumSamples);
-	} else {
-		for(unsigned int i = 0; i < m_NumSamples * 2; i++)
-			m_Data = 0;
+		data += count * 2;
+		numSamples -= count;
 	}
 }
 
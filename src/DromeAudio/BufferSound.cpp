@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <DromeAudio/ChannelLayout.h>
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/BufferSound.h>
+#include "Resample.h"
+
+namespace DromeAudio {
+
+// number of samples converted at a time by BufferSound::create()
+static const unsigned int CONVERT_BLOCK_SIZE = 256;
+
+/*
+ * ChannelPairSound class
+ *
+ * Plays two channels of a sound with more than two channels as a stereo
+ * sound, so that they can be resampled with ResampleSound().
+ */
+class ChannelPairSound : public Sound
+{
+	protected:
+		SoundPtr m_sound;
+		unsigned int m_channel;
+
+	public:
+		ChannelPairSound(const SoundPtr &sound, unsigned int channel)
+		{
+			m_sound = sound;
+			m_channel = channel;
+		}
+
+		unsigned char getNumChannels() const { return 2; }
+		unsigned int getSampleRate() const { return m_sound->getSampleRate(); }
+		unsigned int getNumSamples() const { return m_sound->getNumSamples(); }
+
+		Sample getSample(unsigned int index) const
+		{
+			Sample sample;
+			getSamples(index, &sample, 1);
+			return sample;
+		}
+
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+		{
+			unsigned int numChannels = m_sound->getNumChannels();
+			float planes[MAX_CHANNELS * CONVERT_BLOCK_SIZE];
+			SampleBuffer buffer(numChannels, CONVERT_BLOCK_SIZE, planes);
+
+			while(numSamples != 0) {
+				unsigned int count = (numSamples < CONVERT_BLOCK_SIZE) ? numSamples : CONVERT_BLOCK_SIZE;
+				m_sound->getPlanarSamples(index, buffer, 0, count);
+
+				const float *left = buffer.getChannel(m_channel);
+				for(unsigned int i = 0; i < count; i++)
+					samples[i][0] = left[i];
+
+				if(m_channel + 1 < numChannels) {
+					const float *right = buffer.getChannel(m_channel + 1);
+					for(unsigned int i = 0; i < count; i++)
+						samples[i][1] = right[i];
+				}
+
+				index += count;
+				samples += count;
+				numSamples -= count;
+			}
+		}
+};
+
+/*
+ * BufferSound class
+ */
+BufferSound::BufferSound(unsigned char numChannels, unsigned int sampleRate, unsigned int numSamples)
+{
+	if(numSamples == 0)
+		throw Exception("BufferSound::BufferSound(): Number of samples must not be 0");
+	if(numChannels == 0 || numChannels > MAX_CHANNELS)
+		throw Exception("BufferSound::BufferSound(): Unsupported number of channels (%u)", numChannels);
+
+	m_numChannels = numChannels;
+	m_sampleRate = sampleRate;
+	m_numSamples = numSamples;
+
+	m_samples = NULL;
+	m_frames = NULL;
+	if(numChannels > 2)
+		m_frames = new float[(size_t)numSamples * numChannels]();
+	else
+		m_samples = new Sample[numSamples];
+}
+
+BufferSound::~BufferSound()
+{
+	delete [] m_samples;
+	delete [] m_frames;
+}
+
+unsigned char
+BufferSound::getNumChannels() const
+{
+	return m_numChannels;
+}
+
+unsigned int
+BufferSound::getSampleRate() const
+{
+	return m_sampleRate;
+}
+
+unsigned int
+BufferSound::getNumSamples() const
+{
+	return m_numSamples;
+}
+
+size_t
+BufferSound::getDataSize() const
+{
+	if(m_frames)
+		return sizeof(float) * m_numChannels * m_numSamples;
+
+	return sizeof(Sample) * m_numSamples;
+}
+
+Sample
+BufferSound::getSample(unsigned int index) const
+{
+	index %= m_numSamples;
+
+	if(m_frames)
+		return Sample::fromFormat(m_frames + (size_t)index * m_numChannels, SAMPLE_FORMAT_FLOAT32, m_numChannels, getChannelLayout());
+
+	return m_samples[index];
+}
+
+void
+BufferSound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	index %= m_numSamples;
+
+	while(numSamples != 0) {
+		// copy as many samples as possible before wrapping around
+		unsigned int count = m_numSamples - index;
+		if(count > numSamples)
+			count = numSamples;
+
+		if(m_frames)
+			Sample::fromFormat(m_frames + (size_t)index * m_numChannels, SAMPLE_FORMAT_FLOAT32, m_numChannels, samples, count, getChannelLayout());
+		else
+			memcpy(samples, m_samples + index, sizeof(Sample) * count);
+
+		samples += count;
+		numSamples -= count;
+		index = 0;
+	}
+}
+
+void
+BufferSound::getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const
+{
+	index %= m_numSamples;
+
+	while(numSamples != 0) {
+		// copy as many samples as possible before wrapping around
+		unsigned int count = m_numSamples - index;
+		if(count > numSamples)
+			count = numSamples;
+
+		if(m_frames) {
+			Sample::fromFormat(m_frames + (size_t)index * m_numChannels, SAMPLE_FORMAT_FLOAT32, m_numChannels, buffer, offset, count);
+		} else {
+			for(unsigned int c = 0; c < m_numChannels; c++) {
+				float *channel = buffer.getChannel(c) + offset;
+				for(unsigned int i = 0; i < count; i++)
+					channel[i] = m_samples[index + i][c];
+			}
+		}
+
+		offset += count;
+		numSamples -= count;
+		index = 0;
+	}
+}
+
+Sample *
+BufferSound::getData()
+{
+	return m_samples;
+}
+
+float *
+BufferSound::getFrames()
+{
+	return m_frames;
+}
+
+BufferSoundPtr
+BufferSound::create(unsigned char numChannels, unsigned int sampleRate, unsigned int numSamples)
+{
+	return BufferSoundPtr(new BufferSound(numChannels, sampleRate, numSamples));
+}
+
+BufferSoundPtr
+BufferSound::create(const SoundPtr &sound, unsigned int sampleRate, ResampleQuality quality)
+{
+	uint64_t soundSamples = sound->getNumSamples();
+	if(soundSamples == 0)
+		throw Exception("BufferSound::create(): Can't convert a sound with an unlimited number of samples");
+	if(sampleRate == 0)
+		throw Exception("BufferSound::create(): Invalid sample rate (%u)", sampleRate);
+
+	// same step and length calculations as SoundEmitter, so
+	// that the converted sound plays exactly like the original
+	uint64_t step = (((uint64_t)sound->getSampleRate() << 32) + sampleRate - 1) / sampleRate;
+	uint64_t numSamples = ((soundSamples << 32) + step - 1) / step;
+	if(numSamples > 0xffffffff)
+		throw Exception("BufferSound::create(): Converted sound would be too long");
+
+	BufferSoundPtr buffer = create(sound->getNumChannels(), sampleRate, (unsigned int)numSamples);
+
+	if(!buffer->m_frames) {
+		if(step == ((uint64_t)1 << 32))
+			sound->getSamples(0, buffer->m_samples, buffer->m_numSamples);
+		else
+			ResampleSound(sound, false, ResampleFilter::get(quality, step), 0, step, buffer->m_samples, buffer->m_numSamples);
+
+		return buffer;
+	}
+
+	// sounds with more channels than a Sample holds are copied from
+	// planar buffers, or resampled two channels at a time, and keep
+	// their speaker positions
+	const unsigned int numChannels = buffer->m_numChannels;
+
+	Channel channels[MAX_CHANNELS];
+	for(unsigned int c = 0; c < numChannels && c < MAX_CHANNELS; c++)
+		channels[c] = sound->getChannel(c);
+	buffer->setChannelLayout(channels, (numChannels < MAX_CHANNELS) ? numChannels : MAX_CHANNELS);
+	if(step == ((uint64_t)1 << 32)) {
+		float planes[MAX_CHANNELS * CONVERT_BLOCK_SIZE];
+		SampleBuffer block(numChannels, CONVERT_BLOCK_SIZE, planes);
+
+		for(unsigned int i = 0; i < buffer->m_numSamples; i += CONVERT_BLOCK_SIZE) {
+			unsigned int count = buffer->m_numSamples - i;
+			if(count > CONVERT_BLOCK_SIZE)
+				count = CONVERT_BLOCK_SIZE;
+
+			sound->getPlanarSamples(i, block, 0, count);
+
+			float *frames = buffer->m_frames + (size_t)i * numChannels;
+			for(unsigned int c = 0; c < numChannels; c++) {
+				const float *channel = block.getChannel(c);
+				for(unsigned int j = 0; j < count; j++)
+					frames[j * numChannels + c] = channel[j];
+			}
+		}
+	} else {
+		const ResampleFilter *filter = ResampleFilter::get(quality, step);
+		Sample block[CONVERT_BLOCK_SIZE];
+
+		for(unsigned int c = 0; c < numChannels; c += 2) {
+			SoundPtr pair = new ChannelPairSound(sound, c);
+
+			for(unsigned int i = 0; i < buffer->m_numSamples; i += CONVERT_BLOCK_SIZE) {
+				unsigned int count = buffer->m_numSamples - i;
+				if(count > CONVERT_BLOCK_SIZE)
+					count = CONVERT_BLOCK_SIZE;
+
+				ResampleSound(pair, false, filter, ResampleGetPhase(i, step), step, block, count);
+
+				float *frames = buffer->m_frames + (size_t)i * numChannels + c;
+				for(unsigned int j = 0; j < count; j++) {
+					frames[j * numChannels] = block[j][0];
+					if(c + 1 < numChannels)
+						frames[j * numChannels + 1] = block[j][1];
+				}
+			}
+		}
+	}
+
+	return buffer;
+}
+
+} // namespace DromeAudio
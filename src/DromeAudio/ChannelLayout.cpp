@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <DromeAudio/ChannelLayout.h>
+
+namespace DromeAudio {
+
+static const Channel LAYOUT_1[] = {
+	CHANNEL_FRONT_CENTER
+};
+
+static const Channel LAYOUT_2[] = {
+	CHANNEL_FRONT_LEFT, CHANNEL_FRONT_RIGHT
+};
+
+static const Channel LAYOUT_3[] = {
+	CHANNEL_FRONT_LEFT, CHANNEL_FRONT_RIGHT, CHANNEL_FRONT_CENTER
+};
+
+static const Channel LAYOUT_4[] = {
+	CHANNEL_FRONT_LEFT, CHANNEL_FRONT_RIGHT, CHANNEL_BACK_LEFT, CHANNEL_BACK_RIGHT
+};
+
+static const Channel LAYOUT_5[] = {
+	CHANNEL_FRONT_LEFT, CHANNEL_FRONT_RIGHT, CHANNEL_FRONT_CENTER,
+	CHANNEL_BACK_LEFT, CHANNEL_BACK_RIGHT
+};
+
+static const Channel LAYOUT_6[] = {
+	CHANNEL_FRONT_LEFT, CHANNEL_FRONT_RIGHT, CHANNEL_FRONT_CENTER,
+	CHANNEL_LOW_FREQUENCY, CHANNEL_BACK_LEFT, CHANNEL_BACK_RIGHT
+};
+
+static const Channel LAYOUT_7[] = {
+	CHANNEL_FRONT_LEFT, CHANNEL_FRONT_RIGHT, CHANNEL_FRONT_CENTER,
+	CHANNEL_LOW_FREQUENCY, CHANNEL_BACK_CENTER, CHANNEL_SIDE_LEFT,
+	CHANNEL_SIDE_RIGHT
+};
+
+static const Channel LAYOUT_8[] = {
+	CHANNEL_FRONT_LEFT, CHANNEL_FRONT_RIGHT, CHANNEL_FRONT_CENTER,
+	CHANNEL_LOW_FREQUENCY, CHANNEL_BACK_LEFT, CHANNEL_BACK_RIGHT,
+	CHANNEL_SIDE_LEFT, CHANNEL_SIDE_RIGHT
+};
+
+static const Channel *LAYOUTS[] = {
+	0, LAYOUT_1, LAYOUT_2, LAYOUT_3, LAYOUT_4, LAYOUT_5, LAYOUT_6, LAYOUT_7, LAYOUT_8
+};
+
+// positions of the bits of a WAVE_FORMAT_EXTENSIBLE channel mask, from
+// SPEAKER_FRONT_LEFT to SPEAKER_TOP_BACK_RIGHT
+static const Channel WAV_MASK_CHANNELS[] = {
+	CHANNEL_FRONT_LEFT, CHANNEL_FRONT_RIGHT, CHANNEL_FRONT_CENTER,
+	CHANNEL_LOW_FREQUENCY, CHANNEL_BACK_LEFT, CHANNEL_BACK_RIGHT,
+	CHANNEL_FRONT_LEFT, CHANNEL_FRONT_RIGHT, CHANNEL_BACK_CENTER,
+	CHANNEL_SIDE_LEFT, CHANNEL_SIDE_RIGHT, CHANNEL_DISCRETE,
+	CHANNEL_FRONT_LEFT, CHANNEL_FRONT_CENTER, CHANNEL_FRONT_RIGHT,
+	CHANNEL_BACK_LEFT, CHANNEL_BACK_CENTER, CHANNEL_BACK_RIGHT
+};
+
+static const unsigned int NUM_WAV_MASK_CHANNELS = sizeof(WAV_MASK_CHANNELS) / sizeof(WAV_MASK_CHANNELS[0]);
+
+Channel
+ChannelLayoutGetChannel(unsigned int numChannels, unsigned int index)
+{
+	if(index >= 8 || index >= numChannels)
+		return CHANNEL_DISCRETE;
+	if(numChannels > 8)
+		numChannels = 8;
+
+	return LAYOUTS[numChannels][index];
+}
+
+static int
+findChannel(unsigned int numChannels, Channel channel)
+{
+	for(unsigned int i = 0; i < numChannels && i < 8; i++) {
+		if(ChannelLayoutGetChannel(numChannels, i) == channel)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+static void
+routeChannel(Channel channel, float gain, unsigned int input, unsigned int numInputChannels, unsigned int numOutputChannels, float *matrix)
+{
+	int output = findChannel(numOutputChannels, channel);
+	if(output >= 0) {
+		matrix[output * numInputChannels + input] += gain;
+		return;
+	}
+
+	// fold the channel into the nearest channels in the output; every
+	// layout has either front left and right channels or a center
+	// channel, so these never recurse more than a couple of times
+	const float g = gain * (float)M_SQRT1_2;
+	switch(channel) {
+		case CHANNEL_FRONT_LEFT:
+		case CHANNEL_FRONT_RIGHT:
+			routeChannel(CHANNEL_FRONT_CENTER, gain * 0.5f, input, numInputChannels, numOutputChannels, matrix);
+			break;
+		case CHANNEL_FRONT_CENTER:
+			routeChannel(CHANNEL_FRONT_LEFT, g, input, numInputChannels, numOutputChannels, matrix);
+			routeChannel(CHANNEL_FRONT_RIGHT, g, input, numInputChannels, numOutputChannels, matrix);
+			break;
+		case CHANNEL_BACK_LEFT:
+			if(findChannel(numOutputChannels, CHANNEL_SIDE_LEFT) >= 0)
+				routeChannel(CHANNEL_SIDE_LEFT, gain, input, numInputChannels, numOutputChannels, matrix);
+			else
+				routeChannel(CHANNEL_FRONT_LEFT, g, input, numInputChannels, numOutputChannels, matrix);
+			break;
+		case CHANNEL_BACK_RIGHT:
+			if(findChannel(numOutputChannels, CHANNEL_SIDE_RIGHT) >= 0)
+				routeChannel(CHANNEL_SIDE_RIGHT, gain, input, numInputChannels, numOutputChannels, matrix);
+			else
+				routeChannel(CHANNEL_FRONT_RIGHT, g, input, numInputChannels, numOutputChannels, matrix);
+			break;
+		case CHANNEL_SIDE_LEFT:
+			if(findChannel(numOutputChannels, CHANNEL_BACK_LEFT) >= 0)
+				routeChannel(CHANNEL_BACK_LEFT, gain, input, numInputChannels, numOutputChannels, matrix);
+			else
+				routeChannel(CHANNEL_FRONT_LEFT, g, input, numInputChannels, numOutputChannels, matrix);
+			break;
+		case CHANNEL_SIDE_RIGHT:
+			if(findChannel(numOutputChannels, CHANNEL_BACK_RIGHT) >= 0)
+				routeChannel(CHANNEL_BACK_RIGHT, gain, input, numInputChannels, numOutputChannels, matrix);
+			else
+				routeChannel(CHANNEL_FRONT_RIGHT, g, input, numInputChannels, numOutputChannels, matrix);
+			break;
+		case CHANNEL_BACK_CENTER:
+			routeChannel(CHANNEL_BACK_LEFT, g, input, numInputChannels, numOutputChannels, matrix);
+			routeChannel(CHANNEL_BACK_RIGHT, g, input, numInputChannels, numOutputChannels, matrix);
+			break;
+		case CHANNEL_LOW_FREQUENCY:
+		case CHANNEL_AMBISONIC_W:
+		case CHANNEL_AMBISONIC_X:
+		case CHANNEL_AMBISONIC_Y:
+		case CHANNEL_AMBISONIC_Z:
+		case CHANNEL_DISCRETE:
+			break;
+	}
+}
+
+/*
+ * Gets the direction of a speaker in radians, counterclockwise from the
+ * front. Returns false for channels that aren't speakers around the
+ * listener.
+ */
+static bool
+getAzimuth(Channel channel, float &azimuth)
+{
+	float degrees;
+	switch(channel) {
+		case CHANNEL_FRONT_LEFT: degrees = 30.0f; break;
+		case CHANNEL_FRONT_RIGHT: degrees = -30.0f; break;
+		case CHANNEL_FRONT_CENTER: degrees = 0.0f; break;
+		case CHANNEL_BACK_LEFT: degrees = 135.0f; break;
+		case CHANNEL_BACK_RIGHT: degrees = -135.0f; break;
+		case CHANNEL_BACK_CENTER: degrees = 180.0f; break;
+		case CHANNEL_SIDE_LEFT: degrees = 90.0f; break;
+		case CHANNEL_SIDE_RIGHT: degrees = -90.0f; break;
+		default: return false;
+	}
+
+	azimuth = degrees * (float)M_PI / 180.0f;
+	return true;
+}
+
+/*
+ * Decodes an ambisonic component to the speakers of the output layout,
+ * pointing a virtual cardioid microphone at each speaker. The gains are
+ * divided by the number of speakers so that a sound keeps about the same
+ * level as speakers are added, and a single speaker gets W alone.
+ */
+static void
+decodeAmbisonic(Channel channel, unsigned int input, unsigned int numInputChannels, unsigned int numOutputChannels, float *matrix)
+{
+	unsigned int numSpeakers = 0;
+	float azimuth;
+	for(unsigned int o = 0; o < numOutputChannels; o++) {
+		if(getAzimuth(ChannelLayoutGetChannel(numOutputChannels, o), azimuth))
+			numSpeakers++;
+	}
+
+	for(unsigned int o = 0; o < numOutputChannels; o++) {
+		if(!getAzimuth(ChannelLayoutGetChannel(numOutputChannels, o), azimuth))
+			continue;
+
+		float gain = 0.0f;
+		if(channel == CHANNEL_AMBISONIC_W)
+			gain = (float)M_SQRT2;
+		else if(channel == CHANNEL_AMBISONIC_X && numSpeakers > 1)
+			gain = cosf(azimuth);
+		else if(channel == CHANNEL_AMBISONIC_Y && numSpeakers > 1)
+			gain = sinf(azimuth);
+
+		matrix[o * numInputChannels + input] = gain / (float)numSpeakers;
+	}
+}
+
+/*
+ * Calculates a mix matrix for input channels with the given positions,
+ * or in the default layout for their number if inputChannels is NULL.
+ */
+static void
+getMixMatrix(const Channel *inputChannels, unsigned int numInputChannels, unsigned int numOutputChannels, float *matrix)
+{
+	for(unsigned int i = 0; i < numInputChannels * numOutputChannels; i++)
+		matrix[i] = 0.0f;
+
+	bool ambisonic = false;
+	for(unsigned int i = 0; i < numInputChannels; i++) {
+		Channel channel = inputChannels ? inputChannels[i] : ChannelLayoutGetChannel(numInputChannels, i);
+		if(channel == CHANNEL_AMBISONIC_W)
+			ambisonic = true;
+	}
+
+	for(unsigned int i = 0; i < numInputChannels; i++) {
+		Channel channel = inputChannels ? inputChannels[i] : ChannelLayoutGetChannel(numInputChannels, i);
+
+		if(channel == CHANNEL_DISCRETE) {
+			// discrete channels are passed through by index, unless
+			// they're higher-order ambisonic components
+			if(!ambisonic && i < numOutputChannels)
+				matrix[i * numInputChannels + i] = 1.0f;
+		} else if(channel >= CHANNEL_AMBISONIC_W && channel <= CHANNEL_AMBISONIC_Z) {
+			decodeAmbisonic(channel, i, numInputChannels, numOutputChannels, matrix);
+		} else if(numInputChannels == 1 && numOutputChannels >= 2 && channel == CHANNEL_FRONT_CENTER) {
+			// mono sounds are played on both front channels at full level
+			matrix[0] = 1.0f;
+			matrix[1] = 1.0f;
+		} else {
+			routeChannel(channel, 1.0f, i, numInputChannels, numOutputChannels, matrix);
+		}
+	}
+}
+
+void
+ChannelLayoutGetMixMatrix(unsigned int numInputChannels, unsigned int numOutputChannels, float *matrix)
+{
+	getMixMatrix(NULL, numInputChannels, numOutputChannels, matrix);
+}
+
+void
+ChannelLayoutGetMixMatrix(const Channel *inputChannels, unsigned int numInputChannels, unsigned int numOutputChannels, float *matrix)
+{
+	getMixMatrix(inputChannels, numInputChannels, numOutputChannels, matrix);
+}
+
+void
+ChannelLayoutFromWavMask(uint32_t mask, unsigned int numChannels, Channel *channels)
+{
+	if(mask == 0) {
+		for(unsigned int i = 0; i < numChannels; i++)
+			channels[i] = ChannelLayoutGetChannel(numChannels, i);
+		return;
+	}
+
+	// each channel takes the next bit set in the mask
+	unsigned int bit = 0;
+	for(unsigned int i = 0; i < numChannels; i++) {
+		while(bit < NUM_WAV_MASK_CHANNELS && (mask & (1u << bit)) == 0)
+			bit++;
+
+		if(bit < NUM_WAV_MASK_CHANNELS)
+			channels[i] = WAV_MASK_CHANNELS[bit++];
+		else
+			channels[i] = CHANNEL_DISCRETE;
+	}
+}
+
+} // namespace DromeAudio
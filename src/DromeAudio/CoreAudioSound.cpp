@@ -143,6 +143,12 @@ CoreAudioSound::getNumSamples() const
 	return m_numSamples;
 }
 
+size_t
+CoreAudioSound::getDataSize() const
+{
+	return sizeof(Sample) * m_numSamples;
+}
+
 Sample
 CoreAudioSound::getSample(unsigned int index) const
 {
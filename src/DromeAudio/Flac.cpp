@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <DromeAudio/Exception.h>
+#include "Flac.h"
+
+using namespace std;
+
+namespace DromeAudio {
+
+static const unsigned int FLAC_METADATA_STREAMINFO = 0;
+static const unsigned int FLAC_STREAMINFO_SIZE = 34;
+
+// smallest possible frame header: sync code, block size and sample
+// rate, channels and sample size, a one byte number and the CRC
+static const size_t FLAC_MIN_HEADER_SIZE = 6;
+
+void
+FlacReadHeader(FILE *fp, FlacStreamInfo &info)
+{
+	uint8_t header[10];
+	if(fread(header, 4, 1, fp) != 1)
+		throw Exception("FlacReadHeader(): fread failed");
+
+	// skip an ID3v2 tag, whose size is stored 7 bits per byte
+	if(header[0] == 'I' && header[1] == 'D' && header[2] == '3') {
+		if(fread(header + 4, 6, 1, fp) != 1)
+			throw Exception("FlacReadHeader(): fread failed");
+
+		long tagSize = ((long)(header[6] & 0x7f) << 21) | ((header[7] & 0x7f) << 14) | ((header[8] & 0x7f) << 7) | (header[9] & 0x7f);
+		if(header[5] & 0x10)
+			tagSize += 10;
+
+		if(fseek(fp, tagSize, SEEK_CUR) != 0 || fread(header, 4, 1, fp) != 1)
+			throw Exception("FlacReadHeader(): Invalid file [1]");
+	}
+
+	if(header[0] != 'f' || header[1] != 'L' || header[2] != 'a' || header[3] != 'C')
+		throw Exception("FlacReadHeader(): Invalid file [2]");
+
+	// read metadata blocks until the last one
+	bool found = false;
+	bool last = false;
+	while(!last) {
+		uint8_t block[4];
+		if(fread(block, sizeof(block), 1, fp) != 1)
+			throw Exception("FlacReadHeader(): fread failed");
+
+		last = (block[0] & 0x80) != 0;
+		unsigned int type = block[0] & 0x7f;
+		long length = ((long)block[1] << 16) | (block[2] << 8) | block[3];
+
+		if(type == FLAC_METADATA_STREAMINFO && length >= (long)FLAC_STREAMINFO_SIZE) {
+			uint8_t si[FLAC_STREAMINFO_SIZE];
+			if(fread(si, sizeof(si), 1, fp) != 1)
+				throw Exception("FlacReadHeader(): fread failed");
+			length -= sizeof(si);
+
+			info.min_block_size = (si[0] << 8) | si[1];
+			info.max_block_size = (si[2] << 8) | si[3];
+			info.sample_rate = (si[10] << 12) | (si[11] << 4) | (si[12] >> 4);
+			info.channels = ((si[12] >> 1) & 0x07) + 1;
+			info.bits_per_sample = (((si[12] & 0x01) << 4) | (si[13] >> 4)) + 1;
+			info.total_samples = ((uint64_t)(si[13] & 0x0f) << 32) | ((uint32_t)si[14] << 24) | (si[15] << 16) | (si[16] << 8) | si[17];
+			found = true;
+		}
+
+		if(length != 0 && fseek(fp, length, SEEK_CUR) != 0)
+			throw Exception("FlacReadHeader(): Invalid file [3]");
+	}
+
+	if(!found)
+		throw Exception("FlacReadHeader(): No STREAMINFO block found");
+	if(info.sample_rate == 0 || info.bits_per_sample < 4)
+		throw Exception("FlacReadHeader(): Unsupported format (%u Hz, %u bits per sample)", info.sample_rate, info.bits_per_sample);
+
+	info.frames_offset = (uint64_t)ftell(fp);
+}
+
+/*
+ * CRC-8 with polynomial x^8 + x^2 + x + 1, which protects frame headers.
+ */
+static uint8_t
+FlacCrc8(const uint8_t *data, size_t size)
+{
+	uint8_t crc = 0;
+	for(size_t i = 0; i < size; i++) {
+		crc ^= data[i];
+		for(unsigned int bit = 0; bit < 8; bit++)
+			crc = (uint8_t)((crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1));
+	}
+
+	return crc;
+}
+
+/*
+ * Checks for a frame header at the start of data, returning the frame's
+ * number of samples or 0 if there isn't a valid header. number is set to
+ * the frame number for fixed block size streams or to the number of the
+ * frame's first sample for variable block size streams.
+ */
+static unsigned int
+FlacParseFrameHeader(const uint8_t *data, size_t size, bool variable, uint64_t &number)
+{
+	if(size < FLAC_MIN_HEADER_SIZE || data[0] != 0xff || data[1] != (variable ? 0xf9 : 0xf8))
+		return 0;
+
+	unsigned int blockSizeCode = data[2] >> 4;
+	unsigned int rateCode = data[2] & 0x0f;
+	unsigned int channelCode = data[3] >> 4;
+	unsigned int sizeCode = (data[3] >> 1) & 0x07;
+	if(blockSizeCode == 0 || rateCode == 15 || channelCode > 10 || sizeCode == 3 || (data[3] & 0x01))
+		return 0;
+
+	// the number is coded like a UTF-8 character of up to 7 bytes,
+	// with the number of leading ones giving the length
+	size_t pos = 4;
+	unsigned int numOnes = 0;
+	while(numOnes < 8 && (data[pos] & (0x80 >> numOnes)))
+		numOnes++;
+	if(numOnes == 1 || numOnes == 8)
+		return 0;
+
+	unsigned int numExtra = numOnes ? numOnes - 1 : 0;
+	number = data[pos++] & (0x7f >> numOnes);
+	if(pos + numExtra >= size)
+		return 0;
+	for(unsigned int i = 0; i < numExtra; i++, pos++) {
+		if((data[pos] & 0xc0) != 0x80)
+			return 0;
+		number = (number << 6) | (data[pos] & 0x3f);
+	}
+
+	// block sizes and sample rates that don't have a code are stored
+	// after the number
+	unsigned int blockSize = 0;
+	size_t blockSizePos = pos;
+	if(blockSizeCode == 1)
+		blockSize = 192;
+	else if(blockSizeCode <= 5)
+		blockSize = 576 << (blockSizeCode - 2);
+	else if(blockSizeCode == 6)
+		pos += 1;
+	else if(blockSizeCode == 7)
+		pos += 2;
+	else
+		blockSize = 256 << (blockSizeCode - 8);
+
+	if(rateCode == 12)
+		pos += 1;
+	else if(rateCode == 13 || rateCode == 14)
+		pos += 2;
+
+	// the header is followed by its CRC
+	if(pos >= size || FlacCrc8(data, pos) != data[pos])
+		return 0;
+
+	if(blockSizeCode == 6)
+		blockSize = data[blockSizePos] + 1;
+	else if(blockSizeCode == 7)
+		blockSize = ((data[blockSizePos] << 8) | data[blockSizePos + 1]) + 1;
+
+	return blockSize;
+}
+
+void
+FlacFindFrames(const uint8_t *data, size_t size, const FlacStreamInfo &info, vector <FlacFrame> &frames)
+{
+	size_t pos = (size_t)info.frames_offset;
+	if(info.frames_offset >= size || size - pos < FLAC_MIN_HEADER_SIZE)
+		return;
+
+	// the blocking strategy bit of the first frame applies to all of them
+	bool variable = (data[pos + 1] == 0xf9);
+
+	uint64_t number;
+	unsigned int numSamples = FlacParseFrameHeader(data + pos, size - pos, variable, number);
+	if(numSamples == 0 || number != 0)
+		return;
+
+	FlacFrame frame;
+	frame.first_sample = 0;
+	uint64_t frameNumber = 0;
+	while(numSamples != 0) {
+		frame.offset = pos;
+		frame.num_samples = numSamples;
+		frames.push_back(frame);
+
+		// sounds are limited to 2^32 samples
+		if(frame.first_sample + (uint64_t)numSamples > 0xffffffffu)
+			break;
+
+		frame.first_sample += numSamples;
+		frameNumber++;
+
+		// the next frame starts at the next valid header with the next
+		// number, which rules out sync codes that happen to appear in
+		// the frame's data
+		uint64_t expected = variable ? frame.first_sample : frameNumber;
+		numSamples = 0;
+		for(pos += 2; pos + FLAC_MIN_HEADER_SIZE <= size; pos++) {
+			const uint8_t *next = (const uint8_t *)memchr(data + pos, 0xff, size - pos);
+			if(!next)
+				break;
+
+			pos = (size_t)(next - data);
+			numSamples = FlacParseFrameHeader(next, size - pos, variable, number);
+			if(numSamples != 0 && number == expected)
+				break;
+			numSamples = 0;
+		}
+	}
+}
+
+SampleFormat
+FlacGetSampleFormat(unsigned int bitsPerSample)
+{
+	if(bitsPerSample <= 8)
+		return SAMPLE_FORMAT_UINT8;
+	else if(bitsPerSample <= 16)
+		return SAMPLE_FORMAT_INT16;
+	else if(bitsPerSample <= 24)
+		return SAMPLE_FORMAT_INT24;
+	else
+		return SAMPLE_FORMAT_INT32;
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_FLAC_H__
+#define __DROMEAUDIO_FLAC_H__
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include <stdint.h>
+#include <DromeAudio/SampleFormat.h>
+
+namespace DromeAudio {
+
+struct FlacStreamInfo {
+	unsigned int min_block_size;
+	unsigned int max_block_size;
+	unsigned int sample_rate;
+	unsigned int channels;
+	unsigned int bits_per_sample;
+	uint64_t total_samples;
+
+	// offset of the first frame in the file
+	uint64_t frames_offset;
+};
+
+struct FlacFrame {
+	uint64_t offset;
+	unsigned int first_sample;
+	unsigned int num_samples;
+};
+
+/*
+ * Reads the metadata of a FLAC file (skipping an ID3v2 tag in front of
+ * it), leaving the file positioned at the first frame. Throws an
+ * exception for invalid files or ones without a STREAMINFO block; the
+ * caller is responsible for closing the file.
+ */
+void FlacReadHeader(FILE *fp, FlacStreamInfo &info);
+
+/*
+ * Finds the frames of a FLAC file held in memory by checking the
+ * header of each frame (including its CRC and its frame or sample
+ * number) and searching for the next one after it, without decoding
+ * anything. Stops at the first byte that doesn't start the expected
+ * frame, e.g. at a trailing tag or the end of a truncated file.
+ */
+void FlacFindFrames(const uint8_t *data, size_t size, const FlacStreamInfo &info, std::vector <FlacFrame> &frames);
+
+/*
+ * @return The format that samples of the given number of bits are
+ * stored in once decoded; the samples fill its most significant bits.
+ * Samples of up to 8 bits are stored unsigned, like in WAV files.
+ */
+SampleFormat FlacGetSampleFormat(unsigned int bitsPerSample);
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_FLAC_H__ */
@@ -0,0 +1,827 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/FlacSound.h>
+#include <FLAC/stream_decoder.h>
+#include "Flac.h"
+
+namespace DromeAudio {
+
+// number of frames decoded around each position a sound in compressed
+// mode is played from: the one before the position (which resampling
+// reads back into), the one containing it and the two after it
+static const unsigned int FLAC_FRAMES_PER_CURSOR = 4;
+
+static const unsigned int INVALID_FRAME = 0xffffffff;
+static const unsigned int INVALID_CURSOR = 0xffffffff;
+
+// ranges shorter than this aren't worth the extra decoder
+static const unsigned int FLAC_MIN_RANGE_SAMPLES = 65536;
+
+/*
+ * FlacDecoder class
+ *
+ * A libFLAC decoder reading a file held in memory. Frames are decoded
+ * individually by flushing the decoder and pointing it at the frame,
+ * which works because FLAC frames don't depend on each other; the
+ * decoder only has to have read the file's metadata first.
+ */
+class FlacDecoder
+{
+	protected:
+		FLAC__StreamDecoder *m_decoder;
+		const uint8_t *m_file;
+		size_t m_position;
+		size_t m_end;
+
+		SampleFormat m_format;
+		unsigned int m_numChannels;
+		unsigned int m_frameSize;
+		unsigned int m_shift;
+
+		// samples of the frames being decoded, starting at m_firstSample
+		uint8_t *m_output;
+		unsigned int m_firstSample;
+		unsigned int m_numSamples;
+
+		static FLAC__StreamDecoderReadStatus readCallback(const FLAC__StreamDecoder * /*decoder*/, FLAC__byte buffer[], size_t *bytes, void *clientData)
+		{
+			FlacDecoder *self = (FlacDecoder *)clientData;
+			size_t available = self->m_end - self->m_position;
+			if(available == 0) {
+				*bytes = 0;
+				return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+			}
+
+			if(*bytes > available)
+				*bytes = available;
+			memcpy(buffer, self->m_file + self->m_position, *bytes);
+			self->m_position += *bytes;
+
+			return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+		}
+
+		static FLAC__StreamDecoderWriteStatus writeCallback(const FLAC__StreamDecoder * /*decoder*/, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *clientData)
+		{
+			FlacDecoder *self = (FlacDecoder *)clientData;
+			if(frame->header.channels != self->m_numChannels)
+				return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+			// place the frame by its own sample number (which libFLAC
+			// works out for fixed block size streams too), so a frame
+			// that fails to decode leaves a gap instead of moving the rest
+			uint64_t first = frame->header.number.sample_number;
+			if(first < self->m_firstSample || first >= (uint64_t)self->m_firstSample + self->m_numSamples)
+				return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+
+			unsigned int offset = (unsigned int)(first - self->m_firstSample);
+			unsigned int count = frame->header.blocksize;
+			if(count > self->m_numSamples - offset)
+				count = self->m_numSamples - offset;
+
+			uint8_t *output = self->m_output + (size_t)offset * self->m_frameSize;
+			const unsigned int numChannels = self->m_numChannels;
+			const unsigned int shift = self->m_shift;
+
+			switch(self->m_format) {
+				case SAMPLE_FORMAT_UINT8:
+					for(unsigned int c = 0; c < numChannels; c++)
+						for(unsigned int i = 0; i < count; i++)
+							output[i * numChannels + c] = (uint8_t)((buffer[c][i] << shift) + 128);
+					break;
+				case SAMPLE_FORMAT_INT16:
+					for(unsigned int c = 0; c < numChannels; c++)
+						for(unsigned int i = 0; i < count; i++)
+							((int16_t *)output)[i * numChannels + c] = (int16_t)(buffer[c][i] << shift);
+					break;
+				case SAMPLE_FORMAT_INT24:
+					for(unsigned int c = 0; c < numChannels; c++) {
+						for(unsigned int i = 0; i < count; i++) {
+							uint32_t value = (uint32_t)buffer[c][i] << shift;
+							uint8_t *p = output + (i * numChannels + c) * 3;
+							p[0] = (uint8_t)value;
+							p[1] = (uint8_t)(value >> 8);
+							p[2] = (uint8_t)(value >> 16);
+						}
+					}
+					break;
+				default:
+					for(unsigned int c = 0; c < numChannels; c++)
+						for(unsigned int i = 0; i < count; i++)
+							((int32_t *)output)[i * numChannels + c] = (int32_t)((uint32_t)buffer[c][i] << shift);
+					break;
+			}
+
+			return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+		}
+
+		static void errorCallback(const FLAC__StreamDecoder * /*decoder*/, FLAC__StreamDecoderErrorStatus /*status*/, void * /*clientData*/)
+		{
+			// frames with errors are left as silence
+		}
+
+	public:
+		FlacDecoder(const uint8_t *file, const FlacStreamInfo &info)
+		{
+			m_file = file;
+			m_position = 0;
+			m_end = (size_t)info.frames_offset;
+
+			m_format = FlacGetSampleFormat(info.bits_per_sample);
+			m_numChannels = info.channels;
+			m_frameSize = m_numChannels * SampleFormatGetSize(m_format);
+			m_shift = SampleFormatGetSize(m_format) * 8 - info.bits_per_sample;
+
+			m_decoder = FLAC__stream_decoder_new();
+			if(!m_decoder)
+				throw Exception("FlacDecoder::FlacDecoder(): FLAC__stream_decoder_new failed");
+
+			// read the metadata, which the decoder needs to know the
+			// format of frames that refer to it
+			if(FLAC__stream_decoder_init_stream(m_decoder, readCallback, NULL, NULL, NULL, NULL, writeCallback, NULL, errorCallback, this) != FLAC__STREAM_DECODER_INIT_STATUS_OK ||
+			   !FLAC__stream_decoder_process_until_end_of_metadata(m_decoder)) {
+				FLAC__stream_decoder_delete(m_decoder);
+				throw Exception("FlacDecoder::FlacDecoder(): Unable to read metadata");
+			}
+		}
+
+		~FlacDecoder()
+		{
+			FLAC__stream_decoder_finish(m_decoder);
+			FLAC__stream_decoder_delete(m_decoder);
+		}
+
+		/*
+		 * Decodes consecutive frames into output, reading no further than
+		 * end. Samples of frames that fail to decode are set to silence.
+		 * Returns false if the decoder failed.
+		 */
+		bool decode(const FlacFrame *frames, unsigned int numFrames, size_t end, uint8_t *output)
+		{
+			m_output = output;
+			m_firstSample = frames[0].first_sample;
+			m_numSamples = frames[numFrames - 1].first_sample + frames[numFrames - 1].num_samples - m_firstSample;
+			memset(output, (m_format == SAMPLE_FORMAT_UINT8) ? 0x80 : 0, (size_t)m_numSamples * m_frameSize);
+
+			if(!FLAC__stream_decoder_flush(m_decoder))
+				return false;
+			m_position = (size_t)frames[0].offset;
+			m_end = end;
+
+			for(unsigned int i = 0; i < numFrames; i++) {
+				if(!FLAC__stream_decoder_process_single(m_decoder))
+					return false;
+				if(FLAC__stream_decoder_get_state(m_decoder) == FLAC__STREAM_DECODER_END_OF_STREAM)
+					break;
+			}
+
+			return true;
+		}
+};
+
+/*
+ * FlacDecodeJob struct
+ */
+struct FlacDecodeJob {
+	const uint8_t *file;
+	size_t fileSize;
+	const FlacStreamInfo *info;
+	const FlacFrame *frames;
+	unsigned int numFrames;
+	unsigned int numRanges;
+	uint8_t *data;
+	unsigned int frameSize;
+	std::atomic <bool> failed;
+};
+
+/*
+ * Decodes one range of frames of a FlacDecodeJob with its own decoder,
+ * so ranges can be decoded concurrently.
+ */
+static void
+FlacDecodeRange(void *arg, unsigned int index)
+{
+	FlacDecodeJob *job = (FlacDecodeJob *)arg;
+	unsigned int start = (unsigned int)((uint64_t)job->numFrames * index / job->numRanges);
+	unsigned int end = (unsigned int)((uint64_t)job->numFrames * (index + 1) / job->numRanges);
+	if(start == end)
+		return;
+
+	size_t endOffset = (end < job->numFrames) ? (size_t)job->frames[end].offset : job->fileSize;
+	uint8_t *data = job->data + (size_t)job->frames[start].first_sample * job->frameSize;
+
+	try {
+		FlacDecoder decoder(job->file, *job->info);
+		if(!decoder.decode(job->frames + start, end - start, endOffset, data))
+			job->failed = true;
+	} catch(Exception ex) {
+		job->failed = true;
+	}
+}
+
+/*
+ * Outputs for FlacSound::read()
+ */
+struct FlacStereoOutput {
+	Sample *samples;
+	const Channel *channels;
+
+	void convert(const uint8_t *data, unsigned int numChannels, SampleFormat format, unsigned int count) {
+		Sample::fromFormat(data, format, numChannels, samples, count, channels);
+	}
+
+	void silence(unsigned int count) {
+		for(unsigned int i = 0; i < count; i++)
+			samples[i] = Sample();
+	}
+
+	void advance(unsigned int count) {
+		samples += count;
+	}
+};
+
+struct FlacPlanarOutput {
+	SampleBuffer *buffer;
+	unsigned int offset;
+
+	void convert(const uint8_t *data, unsigned int numChannels, SampleFormat format, unsigned int count) {
+		Sample::fromFormat(data, format, numChannels, *buffer, offset, count);
+	}
+
+	void silence(unsigned int count) {
+		buffer->clear(offset, count);
+	}
+
+	void advance(unsigned int count) {
+		offset += count;
+	}
+};
+
+/*
+ * FlacSound class
+ */
+FlacSound::FlacSound(const char *filename, bool compressed, ThreadPool *pool, unsigned int numPositions)
+{
+	if(compressed && numPositions == 0)
+		throw Exception("FlacSound::FlacSound(): numPositions must be at least 1");
+
+	FILE *fp = fopen(filename, "rb");
+	if(!fp)
+		throw Exception("FlacSound::FlacSound(): Unable to open %s for reading", filename);
+
+	// read the whole file, which is kept in compressed mode
+	FlacStreamInfo info;
+	uint8_t *file = NULL;
+	size_t fileSize = 0;
+	try {
+		FlacReadHeader(fp, info);
+
+		if(fseek(fp, 0, SEEK_END) != 0)
+			throw Exception("FlacSound::FlacSound(): fseek failed");
+		fileSize = (size_t)ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+
+		file = new uint8_t [fileSize];
+		fileSize = fread(file, sizeof(uint8_t), fileSize, fp);
+	} catch(Exception ex) {
+		fclose(fp);
+		throw;
+	}
+	fclose(fp);
+
+	std::vector <FlacFrame> frames;
+	FlacFindFrames(file, fileSize, info, frames);
+	if(frames.empty()) {
+		delete [] file;
+		throw Exception("FlacSound::FlacSound(): No frames found in %s", filename);
+	}
+
+	m_numChannels = (unsigned char)info.channels;
+	m_format = FlacGetSampleFormat(info.bits_per_sample);
+	m_bytesPerSample = (unsigned char)SampleFormatGetSize(m_format);
+	m_sampleRate = info.sample_rate;
+	m_numSamples = frames.back().first_sample + frames.back().num_samples;
+
+	m_data = NULL;
+	m_file = NULL;
+	m_fileSize = 0;
+	m_frames = NULL;
+	m_numFrames = 0;
+	m_maxFrameSamples = 0;
+	m_decoder = NULL;
+	m_decodeMutex = NULL;
+	m_numSlots = 0;
+	m_slotData = NULL;
+	m_slotFrames = NULL;
+	m_numCursors = 0;
+	m_cursors = NULL;
+	m_cursorTimes = NULL;
+	m_threadWanted = NULL;
+	m_blockingWanted = NULL;
+	m_cursorClock = 0;
+	m_numFramesDecoded = 0;
+	m_numUnderruns = 0;
+	m_blocking = false;
+	m_semaphore = NULL;
+	m_thread = NULL;
+	m_running = false;
+
+	unsigned int frameSize = m_numChannels * m_bytesPerSample;
+	if(compressed) {
+		m_file = file;
+		m_fileSize = fileSize;
+		m_numFrames = (unsigned int)frames.size();
+		m_frames = new FlacFrame [m_numFrames];
+		memcpy(m_frames, &frames[0], m_numFrames * sizeof(FlacFrame));
+
+		m_maxFrameSamples = 0;
+		for(unsigned int i = 0; i < m_numFrames; i++) {
+			if(m_frames[i].num_samples > m_maxFrameSamples)
+				m_maxFrameSamples = m_frames[i].num_samples;
+		}
+
+		try {
+			m_decoder = new FlacDecoder(m_file, info);
+		} catch(Exception ex) {
+			delete [] m_frames;
+			delete [] m_file;
+			throw;
+		}
+
+		// short sounds don't need more slots than they have frames
+		m_numSlots = numPositions * FLAC_FRAMES_PER_CURSOR;
+		if(m_numSlots > m_numFrames)
+			m_numSlots = m_numFrames;
+
+		m_slotData = new uint8_t [(size_t)m_numSlots * m_maxFrameSamples * frameSize];
+		m_slotFrames = new std::atomic <unsigned int> [m_numSlots];
+		for(unsigned int i = 0; i < m_numSlots; i++)
+			m_slotFrames[i] = INVALID_FRAME;
+
+		m_threadWanted = new unsigned int [m_numSlots];
+		m_blockingWanted = new unsigned int [m_numSlots];
+
+		m_numCursors = numPositions;
+		m_cursors = new std::atomic <unsigned int> [m_numCursors];
+		m_cursorTimes = new std::atomic <unsigned int> [m_numCursors];
+		for(unsigned int i = 0; i < m_numCursors; i++) {
+			m_cursors[i] = INVALID_CURSOR;
+			m_cursorTimes[i] = 0;
+		}
+
+		m_dataSize = m_fileSize + (size_t)m_numSlots * m_maxFrameSamples * frameSize;
+
+		// decode the first frame so the sound can be played right
+		// away, and leave the rest to the decoder thread
+		m_cursors[0] = 0;
+		decodeFrame(0, NULL, 0);
+
+		m_decodeMutex = Mutex::create();
+		m_semaphore = Semaphore::create();
+		m_running = true;
+		m_thread = Thread::create(decoderThread, this);
+		m_semaphore->post();
+		return;
+	}
+
+	// split the frames into ranges if there's a pool to decode them on
+	unsigned int numRanges = 1;
+	if(pool) {
+		numRanges = pool->getNumThreads() + 1;
+		if(numRanges > m_numSamples / FLAC_MIN_RANGE_SAMPLES)
+			numRanges = m_numSamples / FLAC_MIN_RANGE_SAMPLES;
+		if(numRanges > frames.size())
+			numRanges = (unsigned int)frames.size();
+		if(numRanges == 0)
+			numRanges = 1;
+	}
+
+	m_dataSize = (size_t)m_numSamples * frameSize;
+	m_data = new uint8_t [m_dataSize];
+
+	FlacDecodeJob job;
+	job.file = file;
+	job.fileSize = fileSize;
+	job.info = &info;
+	job.frames = &frames[0];
+	job.numFrames = (unsigned int)frames.size();
+	job.numRanges = numRanges;
+	job.data = m_data;
+	job.frameSize = frameSize;
+	job.failed = false;
+	if(numRanges == 1)
+		FlacDecodeRange(&job, 0);
+	else
+		pool->run(FlacDecodeRange, &job, numRanges);
+
+	delete [] file;
+
+	if(job.failed) {
+		delete [] m_data;
+		throw Exception("FlacSound::FlacSound(): Failed to decode %s", filename);
+	}
+}
+
+FlacSound::~FlacSound()
+{
+	if(m_thread) {
+		m_running = false;
+		m_semaphore->post();
+		delete m_thread;
+	}
+
+	delete [] m_data;
+	delete [] m_file;
+	delete [] m_frames;
+	delete m_decoder;
+	delete m_decodeMutex;
+	delete [] m_slotData;
+	delete [] m_slotFrames;
+	delete [] m_cursors;
+	delete [] m_cursorTimes;
+	delete [] m_threadWanted;
+	delete [] m_blockingWanted;
+	delete m_semaphore;
+}
+
+/*
+ * Returns the number of the frame containing the sample at the given
+ * index. Only used in compressed mode.
+ */
+unsigned int
+FlacSound::findFrame(unsigned int index) const
+{
+	unsigned int low = 0;
+	unsigned int high = m_numFrames - 1;
+	while(low < high) {
+		unsigned int mid = (low + high + 1) / 2;
+		if(m_frames[mid].first_sample <= index)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+
+	return low;
+}
+
+int
+FlacSound::findSlot(unsigned int frame) const
+{
+	for(unsigned int i = 0; i < m_numSlots; i++) {
+		if(m_slotFrames[i].load(std::memory_order_acquire) == frame)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+/*
+ * Fills wanted with the frames that should be decoded for the current
+ * positions, most urgent first, and returns how many there are. wanted
+ * must have room for m_numSlots frames.
+ */
+unsigned int
+FlacSound::getWantedFrames(unsigned int *wanted) const
+{
+	// each position's own frame comes first, then the ones
+	// around it, wrapping around in case the sound is looped
+	static const int offsets[FLAC_FRAMES_PER_CURSOR] = { 0, 1, -1, 2 };
+
+	unsigned int numWanted = 0;
+	for(unsigned int i = 0; i < FLAC_FRAMES_PER_CURSOR; i++) {
+		for(unsigned int j = 0; j < m_numCursors && numWanted < m_numSlots; j++) {
+			unsigned int cursor = m_cursors[j].load(std::memory_order_relaxed);
+			if(cursor == INVALID_CURSOR)
+				continue;
+
+			unsigned int frame = (findFrame(cursor) + m_numFrames + offsets[i]) % m_numFrames;
+
+			bool found = false;
+			for(unsigned int k = 0; k < numWanted && !found; k++)
+				found = (wanted[k] == frame);
+			if(!found)
+				wanted[numWanted++] = frame;
+		}
+	}
+
+	return numWanted;
+}
+
+/*
+ * Decodes a frame into a slot that doesn't hold one of the wanted
+ * frames, and returns the slot, or -1 if every slot is wanted. Called
+ * with m_decodeMutex held, or before the decoder thread is started.
+ */
+int
+FlacSound::decodeFrame(unsigned int frame, const unsigned int *wanted, unsigned int numWanted)
+{
+	int slot = -1;
+	for(unsigned int i = 0; i < m_numSlots && slot == -1; i++) {
+		unsigned int current = m_slotFrames[i].load(std::memory_order_relaxed);
+
+		bool found = false;
+		for(unsigned int j = 0; j < numWanted && !found && current != INVALID_FRAME; j++)
+			found = (wanted[j] == current);
+		if(!found)
+			slot = (int)i;
+	}
+
+	if(slot == -1)
+		return -1;
+
+	// the slot is marked as invalid while it's written to, so
+	// readers that copied from it in the meantime will notice
+	m_slotFrames[slot].store(INVALID_FRAME, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	// frames that fail to decode are left as silence
+	const unsigned int frameSize = m_numChannels * m_bytesPerSample;
+	size_t end = (frame + 1 < m_numFrames) ? (size_t)m_frames[frame + 1].offset : m_fileSize;
+	m_decoder->decode(&m_frames[frame], 1, end, m_slotData + (size_t)slot * m_maxFrameSamples * frameSize);
+	m_numFramesDecoded.fetch_add(1, std::memory_order_relaxed);
+
+	m_slotFrames[slot].store(frame, std::memory_order_release);
+	return slot;
+}
+
+void
+FlacSound::decodeFrames()
+{
+	unsigned int *wanted = m_threadWanted;
+	unsigned int numWanted = getWantedFrames(wanted);
+
+	for(unsigned int i = 0; i < numWanted && m_running; i++) {
+		if(findSlot(wanted[i]) != -1)
+			continue;
+
+		m_decodeMutex->lock();
+		int slot = findSlot(wanted[i]);
+		if(slot == -1)
+			slot = decodeFrame(wanted[i], wanted, numWanted);
+		m_decodeMutex->unlock();
+
+		if(slot == -1)
+			break;
+	}
+}
+
+void
+FlacSound::decoderThread(void *arg)
+{
+	FlacSound *sound = (FlacSound *)arg;
+
+	while(sound->m_running) {
+		sound->m_semaphore->wait();
+		sound->decodeFrames();
+	}
+}
+
+/*
+ * Moves the position that a read starting at index continues to next,
+ * or takes over the least recently moved position if the read doesn't
+ * continue any of them. Wakes the decoder thread if wake is true or
+ * the position moved to another frame.
+ */
+void
+FlacSound::moveCursor(unsigned int index, unsigned int next, bool wake) const
+{
+	// reads continue a position if they start close to it in either
+	// direction, since resampling reads back a little
+	int cursor = -1;
+	int unused = -1;
+	int oldest = 0;
+	unsigned int distance = m_maxFrameSamples;
+	for(unsigned int i = 0; i < m_numCursors; i++) {
+		unsigned int value = m_cursors[i].load(std::memory_order_relaxed);
+		if(value == INVALID_CURSOR) {
+			if(unused == -1)
+				unused = (int)i;
+			continue;
+		}
+
+		unsigned int forward = (index + m_numSamples - value) % m_numSamples;
+		unsigned int backward = (value + m_numSamples - index) % m_numSamples;
+		unsigned int d = (forward < backward) ? forward : backward;
+		if(d <= distance) {
+			cursor = (int)i;
+			distance = d;
+		}
+
+		if(m_cursorTimes[i].load(std::memory_order_relaxed) < m_cursorTimes[oldest].load(std::memory_order_relaxed))
+			oldest = (int)i;
+	}
+
+	if(cursor == -1) {
+		cursor = (unused != -1) ? unused : oldest;
+		wake = true;
+	}
+
+	unsigned int previous = m_cursors[cursor].exchange(next, std::memory_order_relaxed);
+	m_cursorTimes[cursor].store(m_cursorClock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	if(wake || previous == INVALID_CURSOR || findFrame(previous) != findFrame(next))
+		m_semaphore->post();
+}
+
+template <typename Output> void
+FlacSound::read(unsigned int index, unsigned int numSamples, Output &output) const
+{
+	const unsigned int frameSize = m_numChannels * m_bytesPerSample;
+
+	index %= m_numSamples;
+
+	if(m_data) {
+		while(numSamples != 0) {
+			// copy as many samples as possible before wrapping around
+			unsigned int count = m_numSamples - index;
+			if(count > numSamples)
+				count = numSamples;
+
+			output.convert(m_data + (size_t)index * frameSize, m_numChannels, m_format, count);
+
+			output.advance(count);
+			numSamples -= count;
+			index += count;
+			if(index == m_numSamples)
+				index = 0;
+		}
+
+		return;
+	}
+
+	unsigned int start = index;
+	bool missed = false;
+
+	while(numSamples != 0) {
+		unsigned int frame = findFrame(index);
+		unsigned int offset = index - m_frames[frame].first_sample;
+
+		// copy as many samples as possible from the frame
+		// before moving to the next one or wrapping around
+		unsigned int count = m_frames[frame].num_samples - offset;
+		if(count > numSamples)
+			count = numSamples;
+
+		bool copied = false;
+		int slot = findSlot(frame);
+		if(slot != -1) {
+			const uint8_t *data = m_slotData + ((size_t)slot * m_maxFrameSamples + offset) * frameSize;
+			output.convert(data, m_numChannels, m_format, count);
+
+			// make sure the frame wasn't replaced while copying
+			std::atomic_thread_fence(std::memory_order_acquire);
+			copied = (m_slotFrames[slot].load(std::memory_order_relaxed) == frame);
+		}
+
+		if(!copied && m_blocking.load(std::memory_order_relaxed)) {
+			// decode the frame on this thread, holding the lock while
+			// copying so that the decoder thread can't replace it
+			FlacSound *self = const_cast <FlacSound *> (this);
+			m_decodeMutex->lock();
+			slot = findSlot(frame);
+			if(slot == -1) {
+				unsigned int numWanted = getWantedFrames(m_blockingWanted);
+				slot = self->decodeFrame(frame, m_blockingWanted, numWanted);
+				if(slot == -1)
+					slot = self->decodeFrame(frame, NULL, 0);
+			}
+			const uint8_t *data = m_slotData + ((size_t)slot * m_maxFrameSamples + offset) * frameSize;
+			output.convert(data, m_numChannels, m_format, count);
+			copied = true;
+			m_decodeMutex->unlock();
+		}
+
+		if(!copied) {
+			output.silence(count);
+			missed = true;
+		}
+
+		output.advance(count);
+		numSamples -= count;
+		index += count;
+		if(index == m_numSamples)
+			index = 0;
+	}
+
+	if(missed)
+		m_numUnderruns.fetch_add(1, std::memory_order_relaxed);
+	moveCursor(start, index, missed);
+}
+
+unsigned char
+FlacSound::getNumChannels() const
+{
+	return m_numChannels;
+}
+
+unsigned int
+FlacSound::getSampleRate() const
+{
+	return m_sampleRate;
+}
+
+unsigned int
+FlacSound::getNumSamples() const
+{
+	return m_numSamples;
+}
+
+size_t
+FlacSound::getDataSize() const
+{
+	return m_dataSize;
+}
+
+Sample
+FlacSound::getSample(unsigned int index) const
+{
+	Sample sample;
+	getSamples(index, &sample, 1);
+	return sample;
+}
+
+void
+FlacSound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	FlacStereoOutput output = { samples, getChannelLayout() };
+	read(index, numSamples, output);
+}
+
+void
+FlacSound::getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const
+{
+	FlacPlanarOutput output = { &buffer, offset };
+	read(index, numSamples, output);
+}
+
+void
+FlacSound::prefetch(unsigned int index)
+{
+	if(m_file)
+		moveCursor(index % m_numSamples, index % m_numSamples, true);
+}
+
+bool
+FlacSound::isCompressed() const
+{
+	return (m_file != NULL);
+}
+
+unsigned int
+FlacSound::getNumFramesDecoded() const
+{
+	return m_numFramesDecoded.load(std::memory_order_relaxed);
+}
+
+unsigned int
+FlacSound::getNumUnderruns() const
+{
+	return m_numUnderruns.load(std::memory_order_relaxed);
+}
+
+bool
+FlacSound::getBlocking() const
+{
+	return m_blocking;
+}
+
+void
+FlacSound::setBlocking(bool value)
+{
+	m_blocking = value;
+}
+
+FlacSoundPtr
+FlacSound::create(const char *filename, bool compressed, ThreadPool *pool, unsigned int numPositions)
+{
+	return FlacSoundPtr(new FlacSound(filename, compressed, pool, numPositions));
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/LazySound.h>
+#include <DromeAudio/Util.h>
+#ifdef WITH_VORBIS
+	#include <vorbisfile.h>
+#endif /* WITH_VORBIS */
+#include "Flac.h"
+#include "Wav.h"
+
+namespace DromeAudio {
+
+/*
+ * Reads the format of a sound file from its header, based on the
+ * extension of its filename. The speaker positions of the first
+ * MAX_CHANNELS channels are written to channels.
+ */
+static void
+ReadSoundInfo(const char *filename, unsigned char &numChannels, unsigned int &sampleRate, unsigned int &numSamples, Channel channels[MAX_CHANNELS])
+{
+	// look for file extension
+	const char *tmp = filename + strlen(filename);
+	while(tmp != filename && *tmp != '.')
+		--tmp;
+	if(tmp == filename)
+		throw Exception("LazySound::LazySound(): filename has no extension");
+
+#ifdef WITH_VORBIS
+	if(StrCaseCmp(tmp, ".ogg") == 0) {
+		OggVorbis_File vf;
+		if(ov_fopen((char *)filename, &vf) != 0)
+			throw Exception("LazySound::LazySound(): ov_fopen failed");
+
+		vorbis_info *info = ov_info(&vf, 0);
+		numChannels = (unsigned char)info->channels;
+		sampleRate = (unsigned int)info->rate;
+		numSamples = (unsigned int)ov_pcm_total(&vf, 0);
+		for(unsigned int i = 0; i < numChannels && i < MAX_CHANNELS; i++)
+			channels[i] = ChannelLayoutGetChannel(numChannels, i);
+
+		ov_clear(&vf);
+		return;
+	}
+#endif /* WITH_VORBIS */
+#ifdef WITH_FLAC
+	if(StrCaseCmp(tmp, ".flac") == 0) {
+		FILE *fp = fopen(filename, "rb");
+		if(!fp)
+			throw Exception("LazySound::LazySound(): Unable to open %s for reading", filename);
+
+		FlacStreamInfo info;
+		try {
+			FlacReadHeader(fp, info);
+		} catch(Exception ex) {
+			fclose(fp);
+			throw;
+		}
+		fclose(fp);
+
+		// streams that don't give their length would need every
+		// frame to be found, which is what loading them does
+		if(info.total_samples == 0 || info.total_samples > 0xffffffffu)
+			throw Exception("LazySound::LazySound(): %s doesn't give its length", filename);
+
+		numChannels = (unsigned char)info.channels;
+		sampleRate = info.sample_rate;
+		numSamples = (unsigned int)info.total_samples;
+		for(unsigned int i = 0; i < numChannels && i < MAX_CHANNELS; i++)
+			channels[i] = ChannelLayoutGetChannel(numChannels, i);
+		return;
+	}
+#endif /* WITH_FLAC */
+
+	if(StrCaseCmp(tmp, ".wav") == 0) {
+		FILE *fp = fopen(filename, "rb");
+		if(!fp)
+			throw Exception("LazySound::LazySound(): Unable to open %s for reading", filename);
+
+		WavFmtChunk fmt;
+		SampleFormat format;
+		uint32_t dataSize;
+		try {
+			WavReadHeader(fp, fmt, format, dataSize, channels);
+		} catch(Exception ex) {
+			fclose(fp);
+			throw;
+		}
+
+		// truncated files have less data than the header says
+		long dataOffset = ftell(fp);
+		fseek(fp, 0, SEEK_END);
+		long fileSize = ftell(fp);
+		fclose(fp);
+
+		if(dataOffset >= 0 && fileSize >= dataOffset && (uint32_t)(fileSize - dataOffset) < dataSize)
+			dataSize = (uint32_t)(fileSize - dataOffset);
+
+		numChannels = (unsigned char)fmt.channels;
+		sampleRate = fmt.rate;
+		numSamples = dataSize / fmt.channels / (unsigned int)SampleFormatGetSize(format);
+		return;
+	}
+
+	throw Exception("LazySound::LazySound(): Unsupported file extension (%s)", tmp);
+}
+
+/*
+ * LazySound class
+ */
+LazySound::LazySound(const char *filename, SoundLoadFunction function, SoundLoader *loader)
+{
+	Channel channels[MAX_CHANNELS];
+	ReadSoundInfo(filename, m_numChannels, m_sampleRate, m_numSamples, channels);
+	setChannelLayout(channels, (m_numChannels < MAX_CHANNELS) ? m_numChannels : MAX_CHANNELS);
+
+	m_filename = filename;
+	m_function = function ? function : Sound::create;
+	m_loader = loader;
+
+	m_mutex = Mutex::create();
+	m_loaded.store(false, std::memory_order_relaxed);
+	m_failed.store(false, std::memory_order_relaxed);
+}
+
+LazySound::~LazySound()
+{
+	// nobody is waiting for a request that hasn't started yet; one
+	// that's being decoded has to finish before its callback can
+	// no longer use this sound
+	if(m_request.IsSet() && !m_request->cancel())
+		m_request->wait();
+
+	delete m_mutex;
+}
+
+/*
+ * Stores the result of loading the sound. Called with m_mutex held.
+ */
+void
+LazySound::finish(const SoundPtr &sound) const
+{
+	// the loader's callback and update() can both see the same request
+	if(m_loaded.load(std::memory_order_relaxed) || m_failed.load(std::memory_order_relaxed))
+		return;
+
+	if(sound.IsSet()) {
+		// the loaded sound is mixed down with this sound's layout,
+		// which may have been set by the application
+		m_sound = sound;
+		if(m_hasChannelLayout)
+			m_sound->setChannelLayout(m_channels, MAX_CHANNELS);
+		m_loaded.store(true, std::memory_order_release);
+	} else {
+		m_failed.store(true, std::memory_order_relaxed);
+	}
+}
+
+/*
+ * Called on the loader's thread when a request is done or has failed,
+ * so that the sound can be played without another call to prefetch().
+ */
+void
+LazySound::loadCallback(SoundLoadRequest *request, void *userData)
+{
+	const LazySound *sound = (const LazySound *)userData;
+
+	sound->m_mutex->lock();
+	sound->finish(request->getSound());
+	sound->m_mutex->unlock();
+}
+
+/*
+ * Starts loading the sound if it isn't loaded yet, and forgets a request
+ * made to the loader once it has finished. If wait is true, returns only
+ * once the sound has been loaded or loading has failed. This can block,
+ * so it's never called while mixing.
+ */
+bool
+LazySound::update(bool wait) const
+{
+	if(m_loaded.load(std::memory_order_acquire))
+		return true;
+	if(m_failed.load(std::memory_order_relaxed))
+		return false;
+
+	m_mutex->lock();
+
+	if(!m_loaded.load(std::memory_order_relaxed) && !m_failed.load(std::memory_order_relaxed)) {
+		if(m_loader) {
+			if(!m_request)
+				m_request = m_loader->load(m_filename.c_str(), m_function, loadCallback, (void *)this);
+		} else {
+			// load on this thread; the exception's message has
+			// already been printed
+			SoundPtr sound;
+			try {
+				sound = m_function(m_filename.c_str());
+			} catch(Exception ex) {
+			}
+
+			finish(sound);
+		}
+	}
+
+	SoundLoadRequestPtr request = m_request;
+	m_mutex->unlock();
+
+	// the request's semaphore is posted after the callback has
+	// stored its sound
+	if(request.IsSet()) {
+		bool finished;
+		if(wait) {
+			request->wait();
+			finished = true;
+		} else {
+			finished = request->wait(0);
+		}
+
+		if(finished) {
+			m_mutex->lock();
+
+			// the request may have been handled by another thread;
+			// cancelled requests are made again the next time
+			if(m_request == request)
+				m_request = SoundLoadRequestPtr();
+
+			m_mutex->unlock();
+		}
+	}
+
+	return m_loaded.load(std::memory_order_acquire);
+}
+
+unsigned char
+LazySound::getNumChannels() const
+{
+	return m_numChannels;
+}
+
+unsigned int
+LazySound::getSampleRate() const
+{
+	return m_sampleRate;
+}
+
+unsigned int
+LazySound::getNumSamples() const
+{
+	return m_numSamples;
+}
+
+size_t
+LazySound::getDataSize() const
+{
+	if(!m_loaded.load(std::memory_order_acquire))
+		return 0;
+
+	return m_sound->getDataSize();
+}
+
+Sample
+LazySound::getSample(unsigned int index) const
+{
+	if(!m_loaded.load(std::memory_order_acquire))
+		return Sample();
+
+	return m_sound->getSample(index);
+}
+
+void
+LazySound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	if(!m_loaded.load(std::memory_order_acquire)) {
+		for(unsigned int i = 0; i < numSamples; i++)
+			samples[i] = Sample();
+		return;
+	}
+
+	m_sound->getSamples(index, samples, numSamples);
+}
+
+void
+LazySound::getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const
+{
+	if(!m_loaded.load(std::memory_order_acquire)) {
+		for(unsigned int c = 0; c < m_numChannels; c++)
+			memset(buffer.getChannel(c) + offset, 0, numSamples * sizeof(float));
+		return;
+	}
+
+	m_sound->getPlanarSamples(index, buffer, offset, numSamples);
+}
+
+void
+LazySound::prefetch(unsigned int index)
+{
+	if(update(false))
+		m_sound->prefetch(index);
+}
+
+void
+LazySound::load()
+{
+	if(!update(true))
+		throw Exception("LazySound::load(): Unable to load %s", m_filename.c_str());
+}
+
+bool
+LazySound::isLoaded() const
+{
+	return m_loaded.load(std::memory_order_acquire);
+}
+
+bool
+LazySound::isFailed() const
+{
+	return m_failed.load(std::memory_order_relaxed);
+}
+
+const char *
+LazySound::getFilename() const
+{
+	return m_filename.c_str();
+}
+
+LazySoundPtr
+LazySound::create(const char *filename, SoundLoadFunction function, SoundLoader *loader)
+{
+	return LazySoundPtr(new LazySound(filename, function, loader));
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif /* _WIN32 */
+#include <DromeAudio/Exception.h>
+#include "MappedFile.h"
+
+namespace DromeAudio {
+
+#ifndef _WIN32
+class PosixMappedFile : public MappedFile
+{
+	protected:
+		void *m_data;
+		size_t m_size;
+
+	public:
+		PosixMappedFile(const char *filename)
+		{
+			int fd = open(filename, O_RDONLY);
+			if(fd == -1)
+				throw Exception("PosixMappedFile::PosixMappedFile(): Unable to open %s for reading", filename);
+
+			struct stat st;
+			if(fstat(fd, &st) != 0) {
+				close(fd);
+				throw Exception("PosixMappedFile::PosixMappedFile(): fstat failed for %s", filename);
+			}
+
+			m_size = (size_t)st.st_size;
+			m_data = NULL;
+
+			// empty files can't be mapped, but they're valid
+			if(m_size != 0) {
+				m_data = mmap(NULL, m_size, PROT_READ, MAP_SHARED, fd, 0);
+				if(m_data == MAP_FAILED) {
+					close(fd);
+					throw Exception("PosixMappedFile::PosixMappedFile(): mmap failed for %s", filename);
+				}
+			}
+
+			// the mapping stays valid after the descriptor is closed
+			close(fd);
+		}
+
+		~PosixMappedFile()
+		{
+			if(m_data)
+				munmap(m_data, m_size);
+		}
+
+		const uint8_t *getData() const
+		{
+			return (const uint8_t *)m_data;
+		}
+
+		size_t getSize() const
+		{
+			return m_size;
+		}
+};
+#endif
+
+#ifdef _WIN32
+class WinMappedFile : public MappedFile
+{
+	protected:
+		HANDLE m_mapping;
+		void *m_data;
+		size_t m_size;
+
+	public:
+		WinMappedFile(const char *filename)
+		{
+			HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if(file == INVALID_HANDLE_VALUE)
+				throw Exception("WinMappedFile::WinMappedFile(): Unable to open %s for reading", filename);
+
+			LARGE_INTEGER size;
+			if(!GetFileSizeEx(file, &size)) {
+				CloseHandle(file);
+				throw Exception("WinMappedFile::WinMappedFile(): GetFileSizeEx failed for %s", filename);
+			}
+
+			m_size = (size_t)size.QuadPart;
+			m_mapping = NULL;
+			m_data = NULL;
+
+			// empty files can't be mapped, but they're valid
+			if(m_size != 0) {
+				m_mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+				if(m_mapping)
+					m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+				if(!m_data) {
+					if(m_mapping)
+						CloseHandle(m_mapping);
+					CloseHandle(file);
+					throw Exception("WinMappedFile::WinMappedFile(): Unable to map %s", filename);
+				}
+			}
+
+			// the mapping stays valid after the file is closed
+			CloseHandle(file);
+		}
+
+		~WinMappedFile()
+		{
+			if(m_data)
+				UnmapViewOfFile(m_data);
+			if(m_mapping)
+				CloseHandle(m_mapping);
+		}
+
+		const uint8_t *getData() const
+		{
+			return (const uint8_t *)m_data;
+		}
+
+		size_t getSize() const
+		{
+			return m_size;
+		}
+};
+#endif
+
+MappedFile *
+MappedFile::create(const char *filename)
+{
+#if _WIN32
+	return new WinMappedFile(filename);
+#else
+	return new PosixMappedFile(filename);
+#endif /* _WIN32 */
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_MAPPEDFILE_H__
+#define __DROMEAUDIO_MAPPEDFILE_H__
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace DromeAudio {
+
+/*
+ * A read-only view of a whole file mapped into memory. Pages are read
+ * in by the OS when they're first touched and are shared through the
+ * page cache with any other process mapping the same file.
+ */
+class MappedFile
+{
+	public:
+		virtual ~MappedFile() {}
+
+		virtual const uint8_t *getData() const = 0;
+		virtual size_t getSize() const = 0;
+
+		/**
+		 * Maps a file into memory, throwing an exception if it can't be opened or mapped.
+		 * @param filename Path to the file to map.
+		 */
+		static MappedFile *create(const char *filename);
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_MAPPEDFILE_H__ */
@@ -0,0 +1,937 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <cstring>
+#include "Mix.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define MIX_SSE2
+	#include <emmintrin.h>
+	#ifdef __GNUC__
+		#define MIX_AVX2
+		#include <immintrin.h>
+		#define MIX_TARGET_SSE2 __attribute__((target("sse2")))
+		#define MIX_TARGET_AVX2 __attribute__((target("avx2")))
+	#else
+		#define MIX_TARGET_SSE2
+	#endif /* __GNUC__ */
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define MIX_NEON
+	#include <arm_neon.h>
+#endif
+
+namespace DromeAudio {
+
+static const float INT16_SCALE = 32767.0f;
+static const float INV_INT16_SCALE = 1.0f / 32767.0f;
+static const float INV_INT8_SCALE = 1.0f / 127.0f;
+static const float INV_INT24_SCALE = 1.0f / 8388607.0f;
+static const float INT24_SCALE = 8388607.0f;
+static const float INV_INT32_SCALE = 1.0f / 2147483647.0f;
+
+/*
+ * Scalar kernels, which are also used by the vectorized
+ * kernels for values at the end of arrays. The accumulate
+ * and scale kernels take a gain for even and odd indices
+ * so that they can be used for both mono and stereo data.
+ */
+static void
+accumulateScalar(float *dest, const float *src, unsigned int count, float gain0, float gain1)
+{
+	for(unsigned int i = 0; i < count; i++)
+		dest[i] += src[i] * ((i & 1) ? gain1 : gain0);
+}
+
+static void
+scaleScalar(float *samples, unsigned int count, float gain0, float gain1)
+{
+	for(unsigned int i = 0; i < count; i++)
+		samples[i] *= (i & 1) ? gain1 : gain0;
+}
+
+static void
+clampScalar(float *samples, unsigned int count)
+{
+	for(unsigned int i = 0; i < count; i++) {
+		float f = samples[i];
+		samples[i] = (f < -1.0f) ? -1.0f : ((f > 1.0f) ? 1.0f : f);
+	}
+}
+
+static void
+dotScalar(const float *samples, const float *coefficients, unsigned int count, float *result)
+{
+	for(unsigned int i = 0; i < count; i++)
+		result[i & 1] += samples[i] * coefficients[i];
+}
+
+static void
+int16ToFloatScalar(float *dest, const int16_t *src, unsigned int count)
+{
+	for(unsigned int i = 0; i < count; i++)
+		dest[i] = (float)src[i] * INV_INT16_SCALE;
+}
+
+static void
+uint8ToFloatScalar(float *dest, const uint8_t *src, unsigned int count)
+{
+	for(unsigned int i = 0; i < count; i++)
+		dest[i] = (float)((int)src[i] - 128) * INV_INT8_SCALE;
+}
+
+static void
+int24ToFloatScalar(float *dest, const uint8_t *src, unsigned int count)
+{
+	for(unsigned int i = 0; i < count; i++) {
+		const uint8_t *p = src + i * 3;
+		int32_t value = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8;
+		dest[i] = (float)value * INV_INT24_SCALE;
+	}
+}
+
+static void
+int32ToFloatScalar(float *dest, const int32_t *src, unsigned int count)
+{
+	for(unsigned int i = 0; i < count; i++)
+		dest[i] = (float)src[i] * INV_INT32_SCALE;
+}
+
+static void
+floatToInt16Scalar(int16_t *dest, const float *src, unsigned int count)
+{
+	for(unsigned int i = 0; i < count; i++) {
+		float f = src[i];
+		f = (f < -1.0f) ? -1.0f : ((f > 1.0f) ? 1.0f : f);
+		dest[i] = (int16_t)lrintf(f * INT16_SCALE);
+	}
+}
+
+static void
+floatToInt24Scalar(uint8_t *dest, const float *src, unsigned int count)
+{
+	for(unsigned int i = 0; i < count; i++) {
+		float f = src[i];
+		f = (f < -1.0f) ? -1.0f : ((f > 1.0f) ? 1.0f : f);
+		int32_t value = (int32_t)lrintf(f * INT24_SCALE);
+
+		uint8_t *p = dest + i * 3;
+		p[0] = (uint8_t)value;
+		p[1] = (uint8_t)(value >> 8);
+		p[2] = (uint8_t)(value >> 16);
+	}
+}
+
+#ifdef MIX_SSE2
+/*
+ * SSE2 kernels
+ */
+MIX_TARGET_SSE2 static void
+accumulateSSE2(float *dest, const float *src, unsigned int count, float gain0, float gain1)
+{
+	__m128 gains = _mm_set_ps(gain1, gain0, gain1, gain0);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4) {
+		__m128 d = _mm_loadu_ps(dest + i);
+		__m128 s = _mm_loadu_ps(src + i);
+		_mm_storeu_ps(dest + i, _mm_add_ps(d, _mm_mul_ps(s, gains)));
+	}
+
+	accumulateScalar(dest + i, src + i, count - i, gain0, gain1);
+}
+
+MIX_TARGET_SSE2 static void
+scaleSSE2(float *samples, unsigned int count, float gain0, float gain1)
+{
+	__m128 gains = _mm_set_ps(gain1, gain0, gain1, gain0);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4)
+		_mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), gains));
+
+	scaleScalar(samples + i, count - i, gain0, gain1);
+}
+
+MIX_TARGET_SSE2 static void
+clampSSE2(float *samples, unsigned int count)
+{
+	__m128 min = _mm_set1_ps(-1.0f);
+	__m128 max = _mm_set1_ps(1.0f);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4)
+		_mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples + i), min), max));
+
+	clampScalar(samples + i, count - i);
+}
+
+MIX_TARGET_SSE2 static void
+dotSSE2(const float *samples, const float *coefficients, unsigned int count, float *result)
+{
+	__m128 sum = _mm_setzero_ps();
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4)
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(coefficients + i)));
+
+	float sums[4];
+	_mm_storeu_ps(sums, sum);
+	result[0] += sums[0] + sums[2];
+	result[1] += sums[1] + sums[3];
+
+	dotScalar(samples + i, coefficients + i, count - i, result);
+}
+
+MIX_TARGET_SSE2 static void
+int16ToFloatSSE2(float *dest, const int16_t *src, unsigned int count)
+{
+	__m128 scale = _mm_set1_ps(INV_INT16_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+
+		// sign-extend to 32-bit integers
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+
+		_mm_storeu_ps(dest + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+
+	int16ToFloatScalar(dest + i, src + i, count - i);
+}
+
+MIX_TARGET_SSE2 static void
+uint8ToFloatSSE2(float *dest, const uint8_t *src, unsigned int count)
+{
+	__m128 scale = _mm_set1_ps(INV_INT8_SCALE);
+	__m128i bias = _mm_set1_epi8((char)0x80);
+
+	unsigned int i = 0;
+	for(; i + 16 <= count; i += 16) {
+		// flipping the top bit subtracts 128 and makes the values signed
+		__m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)), bias);
+		__m128i lo = _mm_unpacklo_epi8(s, s);
+		__m128i hi = _mm_unpackhi_epi8(s, s);
+
+		// sign-extend to 32-bit integers
+		__m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 24);
+		__m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 24);
+		__m128i c = _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 24);
+		__m128i d = _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 24);
+
+		_mm_storeu_ps(dest + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(a), scale));
+		_mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), scale));
+		_mm_storeu_ps(dest + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(c), scale));
+		_mm_storeu_ps(dest + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(d), scale));
+	}
+
+	uint8ToFloatScalar(dest + i, src + i, count - i);
+}
+
+MIX_TARGET_SSE2 static void
+int24ToFloatSSE2(float *dest, const uint8_t *src, unsigned int count)
+{
+	__m128 scale = _mm_set1_ps(INV_INT24_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4) {
+		// load each value into the top 3 bytes of a 32-bit lane; the
+		// last one is loaded from a byte earlier so the load doesn't
+		// go past the end of the array
+		const uint8_t *p = src + i * 3;
+		uint32_t v[4];
+		memcpy(&v[0], p + 0, 4);
+		memcpy(&v[1], p + 3, 4);
+		memcpy(&v[2], p + 6, 4);
+		memcpy(&v[3], p + 8, 4);
+
+		__m128i s = _mm_set_epi32((int)v[3], (int)(v[2] << 8), (int)(v[1] << 8), (int)(v[0] << 8));
+		s = _mm_srai_epi32(s, 8);
+		_mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(s), scale));
+	}
+
+	int24ToFloatScalar(dest + i, src + i * 3, count - i);
+}
+
+MIX_TARGET_SSE2 static void
+int32ToFloatSSE2(float *dest, const int32_t *src, unsigned int count)
+{
+	__m128 scale = _mm_set1_ps(INV_INT32_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(s), scale));
+	}
+
+	int32ToFloatScalar(dest + i, src + i, count - i);
+}
+
+MIX_TARGET_SSE2 static void
+floatToInt16SSE2(int16_t *dest, const float *src, unsigned int count)
+{
+	__m128 min = _mm_set1_ps(-1.0f);
+	__m128 max = _mm_set1_ps(1.0f);
+	__m128 scale = _mm_set1_ps(INT16_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 0), min), max);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), min), max);
+
+		__m128i ia = _mm_cvtps_epi32(_mm_mul_ps(a, scale));
+		__m128i ib = _mm_cvtps_epi32(_mm_mul_ps(b, scale));
+		_mm_storeu_si128((__m128i *)(dest + i), _mm_packs_epi32(ia, ib));
+	}
+
+	floatToInt16Scalar(dest + i, src + i, count - i);
+}
+
+MIX_TARGET_SSE2 static void
+floatToInt24SSE2(uint8_t *dest, const float *src, unsigned int count)
+{
+	__m128 min = _mm_set1_ps(-1.0f);
+	__m128 max = _mm_set1_ps(1.0f);
+	__m128 scale = _mm_set1_ps(INT24_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4) {
+		__m128 f = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), min), max);
+
+		// SSE2 can't shuffle bytes, so the values are packed one at a time
+		int32_t values[4];
+		_mm_storeu_si128((__m128i *)values, _mm_cvtps_epi32(_mm_mul_ps(f, scale)));
+
+		uint8_t *p = dest + i * 3;
+		for(unsigned int j = 0; j < 4; j++) {
+			p[j * 3 + 0] = (uint8_t)values[j];
+			p[j * 3 + 1] = (uint8_t)(values[j] >> 8);
+			p[j * 3 + 2] = (uint8_t)(values[j] >> 16);
+		}
+	}
+
+	floatToInt24Scalar(dest + i * 3, src + i, count - i);
+}
+#endif /* MIX_SSE2 */
+
+#ifdef MIX_AVX2
+/*
+ * AVX2 kernels
+ */
+MIX_TARGET_AVX2 static void
+accumulateAVX2(float *dest, const float *src, unsigned int count, float gain0, float gain1)
+{
+	__m256 gains = _mm256_set_ps(gain1, gain0, gain1, gain0, gain1, gain0, gain1, gain0);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m256 d = _mm256_loadu_ps(dest + i);
+		__m256 s = _mm256_loadu_ps(src + i);
+		_mm256_storeu_ps(dest + i, _mm256_add_ps(d, _mm256_mul_ps(s, gains)));
+	}
+
+	accumulateScalar(dest + i, src + i, count - i, gain0, gain1);
+}
+
+MIX_TARGET_AVX2 static void
+scaleAVX2(float *samples, unsigned int count, float gain0, float gain1)
+{
+	__m256 gains = _mm256_set_ps(gain1, gain0, gain1, gain0, gain1, gain0, gain1, gain0);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), gains));
+
+	scaleScalar(samples + i, count - i, gain0, gain1);
+}
+
+MIX_TARGET_AVX2 static void
+clampAVX2(float *samples, unsigned int count)
+{
+	__m256 min = _mm256_set1_ps(-1.0f);
+	__m256 max = _mm256_set1_ps(1.0f);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(samples + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(samples + i), min), max));
+
+	clampScalar(samples + i, count - i);
+}
+
+MIX_TARGET_AVX2 static void
+dotAVX2(const float *samples, const float *coefficients, unsigned int count, float *result)
+{
+	__m256 sum = _mm256_setzero_ps();
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8)
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(samples + i), _mm256_loadu_ps(coefficients + i)));
+
+	// fold the upper half onto the lower half so that
+	// even lanes are left and odd lanes are right
+	__m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+
+	float sums[4];
+	_mm_storeu_ps(sums, half);
+	result[0] += sums[0] + sums[2];
+	result[1] += sums[1] + sums[3];
+
+	dotScalar(samples + i, coefficients + i, count - i, result);
+}
+
+MIX_TARGET_AVX2 static void
+int16ToFloatAVX2(float *dest, const int16_t *src, unsigned int count)
+{
+	__m256 scale = _mm256_set1_ps(INV_INT16_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		__m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(s));
+		_mm256_storeu_ps(dest + i, _mm256_mul_ps(f, scale));
+	}
+
+	int16ToFloatScalar(dest + i, src + i, count - i);
+}
+
+MIX_TARGET_AVX2 static void
+uint8ToFloatAVX2(float *dest, const uint8_t *src, unsigned int count)
+{
+	__m256 scale = _mm256_set1_ps(INV_INT8_SCALE);
+	__m128i bias = _mm_set1_epi8((char)0x80);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		// flipping the top bit subtracts 128 and makes the values signed
+		__m128i s = _mm_xor_si128(_mm_loadl_epi64((const __m128i *)(src + i)), bias);
+		__m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(s));
+		_mm256_storeu_ps(dest + i, _mm256_mul_ps(f, scale));
+	}
+
+	uint8ToFloatScalar(dest + i, src + i, count - i);
+}
+
+MIX_TARGET_AVX2 static void
+int24ToFloatAVX2(float *dest, const uint8_t *src, unsigned int count)
+{
+	__m256 scale = _mm256_set1_ps(INV_INT24_SCALE);
+
+	// moves the 3 bytes of each value in a 128-bit lane
+	// into the top 3 bytes of a 32-bit lane
+	__m256i shuffle = _mm256_setr_epi8(
+		-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+		-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+
+	// each iteration loads 32 bytes but uses 24, so stop
+	// early enough that the loads stay inside the array
+	unsigned int i = 0;
+	for(; i + 10 <= count; i += 8) {
+		const uint8_t *p = src + i * 3;
+		__m128i lo = _mm_loadu_si128((const __m128i *)(p + 0));
+		__m128i hi = _mm_loadu_si128((const __m128i *)(p + 12));
+		__m256i s = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+		s = _mm256_srai_epi32(_mm256_shuffle_epi8(s, shuffle), 8);
+		_mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_cvtepi32_ps(s), scale));
+	}
+
+	int24ToFloatScalar(dest + i, src + i * 3, count - i);
+}
+
+MIX_TARGET_AVX2 static void
+int32ToFloatAVX2(float *dest, const int32_t *src, unsigned int count)
+{
+	__m256 scale = _mm256_set1_ps(INV_INT32_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_cvtepi32_ps(s), scale));
+	}
+
+	int32ToFloatScalar(dest + i, src + i, count - i);
+}
+
+MIX_TARGET_AVX2 static void
+floatToInt16AVX2(int16_t *dest, const float *src, unsigned int count)
+{
+	__m256 min = _mm256_set1_ps(-1.0f);
+	__m256 max = _mm256_set1_ps(1.0f);
+	__m256 scale = _mm256_set1_ps(INT16_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 16 <= count; i += 16) {
+		__m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i + 0), min), max);
+		__m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i + 8), min), max);
+
+		__m256i ia = _mm256_cvtps_epi32(_mm256_mul_ps(a, scale));
+		__m256i ib = _mm256_cvtps_epi32(_mm256_mul_ps(b, scale));
+
+		// packing works within 128-bit lanes, so put the
+		// 64-bit blocks back in order afterwards
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(ia, ib), 0xd8);
+		_mm256_storeu_si256((__m256i *)(dest + i), packed);
+	}
+
+	floatToInt16Scalar(dest + i, src + i, count - i);
+}
+
+MIX_TARGET_AVX2 static void
+floatToInt24AVX2(uint8_t *dest, const float *src, unsigned int count)
+{
+	__m256 min = _mm256_set1_ps(-1.0f);
+	__m256 max = _mm256_set1_ps(1.0f);
+	__m256 scale = _mm256_set1_ps(INT24_SCALE);
+
+	// moves the low 3 bytes of each 32-bit lane to the
+	// first 12 bytes of its 128-bit lane
+	__m256i shuffle = _mm256_setr_epi8(
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+	// each iteration stores 28 bytes, the last 4 of which are
+	// overwritten by the next one, so stop early enough that the
+	// stores stay inside the array
+	unsigned int i = 0;
+	for(; i + 10 <= count; i += 8) {
+		__m256 f = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), min), max);
+		__m256i s = _mm256_shuffle_epi8(_mm256_cvtps_epi32(_mm256_mul_ps(f, scale)), shuffle);
+
+		uint8_t *p = dest + i * 3;
+		_mm_storeu_si128((__m128i *)(p + 0), _mm256_castsi256_si128(s));
+		_mm_storeu_si128((__m128i *)(p + 12), _mm256_extracti128_si256(s, 1));
+	}
+
+	floatToInt24Scalar(dest + i * 3, src + i, count - i);
+}
+#endif /* MIX_AVX2 */
+
+#ifdef MIX_NEON
+/*
+ * NEON kernels
+ */
+static inline int32x4_t
+roundNEON(float32x4_t f)
+{
+#ifdef __aarch64__
+	return vcvtnq_s32_f32(f);
+#else
+	// ARMv7 conversions only truncate, so add 0.5 with the sign of
+	// each value first to round halfway cases away from zero
+	uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(f), vdupq_n_u32(0x80000000));
+	float32x4_t half = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(vdupq_n_f32(0.5f)), sign));
+	return vcvtq_s32_f32(vaddq_f32(f, half));
+#endif /* __aarch64__ */
+}
+
+static void
+accumulateNEON(float *dest, const float *src, unsigned int count, float gain0, float gain1)
+{
+	const float g[4] = { gain0, gain1, gain0, gain1 };
+	float32x4_t gains = vld1q_f32(g);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4) {
+		float32x4_t d = vld1q_f32(dest + i);
+		float32x4_t s = vld1q_f32(src + i);
+		vst1q_f32(dest + i, vaddq_f32(d, vmulq_f32(s, gains)));
+	}
+
+	accumulateScalar(dest + i, src + i, count - i, gain0, gain1);
+}
+
+static void
+scaleNEON(float *samples, unsigned int count, float gain0, float gain1)
+{
+	const float g[4] = { gain0, gain1, gain0, gain1 };
+	float32x4_t gains = vld1q_f32(g);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4)
+		vst1q_f32(samples + i, vmulq_f32(vld1q_f32(samples + i), gains));
+
+	scaleScalar(samples + i, count - i, gain0, gain1);
+}
+
+static void
+clampNEON(float *samples, unsigned int count)
+{
+	float32x4_t min = vdupq_n_f32(-1.0f);
+	float32x4_t max = vdupq_n_f32(1.0f);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4)
+		vst1q_f32(samples + i, vminq_f32(vmaxq_f32(vld1q_f32(samples + i), min), max));
+
+	clampScalar(samples + i, count - i);
+}
+
+static void
+dotNEON(const float *samples, const float *coefficients, unsigned int count, float *result)
+{
+	float32x4_t sum = vdupq_n_f32(0.0f);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4)
+		sum = vmlaq_f32(sum, vld1q_f32(samples + i), vld1q_f32(coefficients + i));
+
+	float sums[4];
+	vst1q_f32(sums, sum);
+	result[0] += sums[0] + sums[2];
+	result[1] += sums[1] + sums[3];
+
+	dotScalar(samples + i, coefficients + i, count - i, result);
+}
+
+static void
+int16ToFloatNEON(float *dest, const int16_t *src, unsigned int count)
+{
+	float32x4_t scale = vdupq_n_f32(INV_INT16_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		int16x8_t s = vld1q_s16(src + i);
+		float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+		float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+		vst1q_f32(dest + i + 0, vmulq_f32(lo, scale));
+		vst1q_f32(dest + i + 4, vmulq_f32(hi, scale));
+	}
+
+	int16ToFloatScalar(dest + i, src + i, count - i);
+}
+
+static void
+uint8ToFloatNEON(float *dest, const uint8_t *src, unsigned int count)
+{
+	float32x4_t scale = vdupq_n_f32(INV_INT8_SCALE);
+	uint8x8_t bias = vdup_n_u8(0x80);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		// flipping the top bit subtracts 128 and makes the values signed
+		int16x8_t s = vmovl_s8(vreinterpret_s8_u8(veor_u8(vld1_u8(src + i), bias)));
+		float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+		float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+		vst1q_f32(dest + i + 0, vmulq_f32(lo, scale));
+		vst1q_f32(dest + i + 4, vmulq_f32(hi, scale));
+	}
+
+	uint8ToFloatScalar(dest + i, src + i, count - i);
+}
+
+static void
+int24ToFloatNEON(float *dest, const uint8_t *src, unsigned int count)
+{
+	float32x4_t scale = vdupq_n_f32(INV_INT24_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		// split the bytes of 8 values into low, middle and high bytes
+		uint8x8x3_t b = vld3_u8(src + i * 3);
+		uint16x8_t low = vorrq_u16(vmovl_u8(b.val[0]), vshll_n_u8(b.val[1], 8));
+		int16x8_t high = vmovl_s8(vreinterpret_s8_u8(b.val[2]));
+
+		int32x4_t a = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_low_s16(high)), 16), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))));
+		int32x4_t c = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_high_s16(high)), 16), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))));
+		vst1q_f32(dest + i + 0, vmulq_f32(vcvtq_f32_s32(a), scale));
+		vst1q_f32(dest + i + 4, vmulq_f32(vcvtq_f32_s32(c), scale));
+	}
+
+	int24ToFloatScalar(dest + i, src + i * 3, count - i);
+}
+
+static void
+int32ToFloatNEON(float *dest, const int32_t *src, unsigned int count)
+{
+	float32x4_t scale = vdupq_n_f32(INV_INT32_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 4 <= count; i += 4)
+		vst1q_f32(dest + i, vmulq_f32(vcvtq_f32_s32(vld1q_s32(src + i)), scale));
+
+	int32ToFloatScalar(dest + i, src + i, count - i);
+}
+
+static void
+floatToInt16NEON(int16_t *dest, const float *src, unsigned int count)
+{
+	float32x4_t min = vdupq_n_f32(-1.0f);
+	float32x4_t max = vdupq_n_f32(1.0f);
+	float32x4_t scale = vdupq_n_f32(INT16_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(src + i + 0), min), max);
+		float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(src + i + 4), min), max);
+
+		int32x4_t ia = roundNEON(vmulq_f32(a, scale));
+		int32x4_t ib = roundNEON(vmulq_f32(b, scale));
+		vst1q_s16(dest + i, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+	}
+
+	floatToInt16Scalar(dest + i, src + i, count - i);
+}
+
+static void
+floatToInt24NEON(uint8_t *dest, const float *src, unsigned int count)
+{
+	float32x4_t min = vdupq_n_f32(-1.0f);
+	float32x4_t max = vdupq_n_f32(1.0f);
+	float32x4_t scale = vdupq_n_f32(INT24_SCALE);
+
+	unsigned int i = 0;
+	for(; i + 8 <= count; i += 8) {
+		float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(src + i + 0), min), max);
+		float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(src + i + 4), min), max);
+
+		uint32x4_t ia = vreinterpretq_u32_s32(roundNEON(vmulq_f32(a, scale)));
+		uint32x4_t ib = vreinterpretq_u32_s32(roundNEON(vmulq_f32(b, scale)));
+
+		// split the values into low, middle and high bytes
+		uint8x8x3_t bytes;
+		bytes.val[0] = vmovn_u16(vcombine_u16(vmovn_u32(ia), vmovn_u32(ib)));
+		bytes.val[1] = vmovn_u16(vcombine_u16(vmovn_u32(vshrq_n_u32(ia, 8)), vmovn_u32(vshrq_n_u32(ib, 8))));
+		bytes.val[2] = vmovn_u16(vcombine_u16(vmovn_u32(vshrq_n_u32(ia, 16)), vmovn_u32(vshrq_n_u32(ib, 16))));
+		vst3_u8(dest + i * 3, bytes);
+	}
+
+	floatToInt24Scalar(dest + i * 3, src + i, count - i);
+}
+#endif /* MIX_NEON */
+
+/*
+ * Runtime dispatch
+ */
+struct MixFunctions {
+	const char *name;
+	void (*accumulate)(float *, const float *, unsigned int, float, float);
+	void (*scale)(float *, unsigned int, float, float);
+	void (*clamp)(float *, unsigned int);
+	void (*dot)(const float *, const float *, unsigned int, float *);
+	void (*int16ToFloat)(float *, const int16_t *, unsigned int);
+	void (*uint8ToFloat)(float *, const uint8_t *, unsigned int);
+	void (*int24ToFloat)(float *, const uint8_t *, unsigned int);
+	void (*int32ToFloat)(float *, const int32_t *, unsigned int);
+	void (*floatToInt16)(int16_t *, const float *, unsigned int);
+	void (*floatToInt24)(uint8_t *, const float *, unsigned int);
+};
+
+static const MixFunctions SCALAR_FUNCTIONS = {
+	"scalar", accumulateScalar, scaleScalar, clampScalar, dotScalar, int16ToFloatScalar,
+	uint8ToFloatScalar, int24ToFloatScalar, int32ToFloatScalar, floatToInt16Scalar, floatToInt24Scalar
+};
+
+#ifdef MIX_SSE2
+static const MixFunctions SSE2_FUNCTIONS = {
+	"sse2", accumulateSSE2, scaleSSE2, clampSSE2, dotSSE2, int16ToFloatSSE2,
+	uint8ToFloatSSE2, int24ToFloatSSE2, int32ToFloatSSE2, floatToInt16SSE2, floatToInt24SSE2
+};
+#endif /* MIX_SSE2 */
+
+#ifdef MIX_AVX2
+static const MixFunctions AVX2_FUNCTIONS = {
+	"avx2", accumulateAVX2, scaleAVX2, clampAVX2, dotAVX2, int16ToFloatAVX2,
+	uint8ToFloatAVX2, int24ToFloatAVX2, int32ToFloatAVX2, floatToInt16AVX2, floatToInt24AVX2
+};
+#endif /* MIX_AVX2 */
+
+#ifdef MIX_NEON
+static const MixFunctions NEON_FUNCTIONS = {
+	"neon", accumulateNEON, scaleNEON, clampNEON, dotNEON, int16ToFloatNEON,
+	uint8ToFloatNEON, int24ToFloatNEON, int32ToFloatNEON, floatToInt16NEON, floatToInt24NEON
+};
+#endif /* MIX_NEON */
+
+static const MixFunctions *
+selectMixFunctions()
+{
+#ifdef MIX_AVX2
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2"))
+		return &AVX2_FUNCTIONS;
+#endif /* MIX_AVX2 */
+
+#ifdef MIX_SSE2
+	#if defined(__GNUC__) && (defined(__i386__) || defined(_M_IX86))
+	if(__builtin_cpu_supports("sse2"))
+		return &SSE2_FUNCTIONS;
+	#else
+	// SSE2 is always available on x86-64
+	return &SSE2_FUNCTIONS;
+	#endif
+#endif /* MIX_SSE2 */
+
+#ifdef MIX_NEON
+	return &NEON_FUNCTIONS;
+#endif /* MIX_NEON */
+
+	return &SCALAR_FUNCTIONS;
+}
+
+static const MixFunctions &
+getMixFunctions()
+{
+	static const MixFunctions *functions = selectMixFunctions();
+	return *functions;
+}
+
+void
+MixAccumulate(float *dest, const float *src, unsigned int count, float gain)
+{
+	getMixFunctions().accumulate(dest, src, count, gain, gain);
+}
+
+void
+MixAccumulateStereo(float *dest, const float *src, unsigned int numSamples, float leftGain, float rightGain)
+{
+	getMixFunctions().accumulate(dest, src, numSamples * 2, leftGain, rightGain);
+}
+
+void
+MixAccumulateMonoToStereo(float *dest, const float *src, unsigned int numSamples, float leftGain, float rightGain)
+{
+	for(unsigned int i = 0; i < numSamples; i++) {
+		dest[i * 2 + 0] += src[i] * leftGain;
+		dest[i * 2 + 1] += src[i] * rightGain;
+	}
+}
+
+void
+MixAccumulateStrided(float *dest, unsigned int destStride, const float *src, unsigned int srcStride, unsigned int count, float gain)
+{
+	for(unsigned int i = 0; i < count; i++)
+		dest[i * destStride] += src[i * srcStride] * gain;
+}
+
+void
+MixScaleStereo(float *samples, unsigned int numSamples, float leftGain, float rightGain)
+{
+	getMixFunctions().scale(samples, numSamples * 2, leftGain, rightGain);
+}
+
+void
+MixClamp(float *samples, unsigned int count)
+{
+	getMixFunctions().clamp(samples, count);
+}
+
+void
+MixDotProductStereo(const float *samples, const float *coefficients, unsigned int numSamples, float &left, float &right)
+{
+	float result[2] = { 0.0f, 0.0f };
+	getMixFunctions().dot(samples, coefficients, numSamples * 2, result);
+
+	left = result[0];
+	right = result[1];
+}
+
+void
+MixInt16ToFloat(float *dest, const int16_t *src, unsigned int count)
+{
+	getMixFunctions().int16ToFloat(dest, src, count);
+}
+
+void
+MixUInt8ToFloat(float *dest, const uint8_t *src, unsigned int count)
+{
+	getMixFunctions().uint8ToFloat(dest, src, count);
+}
+
+void
+MixInt24ToFloat(float *dest, const uint8_t *src, unsigned int count)
+{
+	getMixFunctions().int24ToFloat(dest, src, count);
+}
+
+void
+MixInt32ToFloat(float *dest, const int32_t *src, unsigned int count)
+{
+	getMixFunctions().int32ToFloat(dest, src, count);
+}
+
+void
+MixFloatToInt16(int16_t *dest, const float *src, unsigned int count)
+{
+	getMixFunctions().floatToInt16(dest, src, count);
+}
+
+void
+MixFloatToInt24(uint8_t *dest, const float *src, unsigned int count)
+{
+	getMixFunctions().floatToInt24(dest, src, count);
+}
+
+void
+MixAddTriangularNoise(float *samples, unsigned int count, float amplitude, uint32_t &state)
+{
+	// the difference of two uniform values in [0, 1) has a triangular
+	// distribution in (-1, 1); values come from the top 24 bits of a
+	// linear congruential generator, scaled by 2^-24
+	const float scale = amplitude * (1.0f / 16777216.0f);
+	uint32_t x = state;
+
+	for(unsigned int i = 0; i < count; i++) {
+		x = x * 1664525u + 1013904223u;
+		int32_t a = (int32_t)(x >> 8);
+		x = x * 1664525u + 1013904223u;
+		int32_t b = (int32_t)(x >> 8);
+
+		samples[i] += (float)(a - b) * scale;
+	}
+
+	state = x;
+}
+
+void
+MixPanGains(float balance, float &leftGain, float &rightGain)
+{
+	if(balance == 0.0f) {
+		leftGain = 1.0f;
+		rightGain = 1.0f;
+		return;
+	}
+
+	if(balance < -1.0f)
+		balance = -1.0f;
+	else if(balance > 1.0f)
+		balance = 1.0f;
+
+	// sin^2 + cos^2 is constant across the whole range; scale
+	// by sqrt(2) so that the center position has unity gain
+	float angle = (balance + 1.0f) * (float)(M_PI / 4.0);
+	leftGain = cosf(angle) * (float)M_SQRT2;
+	rightGain = sinf(angle) * (float)M_SQRT2;
+}
+
+const char *
+MixGetInstructionSet()
+{
+	return getMixFunctions().name;
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_MIX_H__
+#define __DROMEAUDIO_MIX_H__
+
+#include <stdint.h>
+
+namespace DromeAudio {
+
+/*
+ * Mixing kernels used by the mixer, effects and drivers. Each function
+ * operates on plain arrays of floats (a Sample array can be passed as
+ * an array of interleaved stereo floats) and is dispatched at runtime to
+ * an AVX2, SSE2 or NEON implementation when the CPU supports one, with
+ * a scalar fallback.
+ */
+
+/**
+ * Adds src * gain to dest.
+ * @param count Number of floats in dest and src.
+ */
+void MixAccumulate(float *dest, const float *src, unsigned int count, float gain);
+
+/**
+ * Adds interleaved stereo src to dest, scaling the left channel by leftGain and the right channel by rightGain.
+ * @param numSamples Number of stereo samples (pairs of floats) in dest and src.
+ */
+void MixAccumulateStereo(float *dest, const float *src, unsigned int numSamples, float leftGain, float rightGain);
+
+/**
+ * Adds mono src to both channels of interleaved stereo dest, scaling the left channel by leftGain and the right channel by rightGain.
+ * @param numSamples Number of floats in src, and stereo samples in dest.
+ */
+void MixAccumulateMonoToStereo(float *dest, const float *src, unsigned int numSamples, float leftGain, float rightGain);
+
+/**
+ * Adds src * gain to dest, stepping through each array by its own stride. Used to mix one channel of interleaved or planar data into one channel of an interleaved buffer. This has no vectorized implementations, since the strides vary with the number of channels.
+ * @param destStride Distance in floats between consecutive values in dest.
+ * @param srcStride Distance in floats between consecutive values in src.
+ * @param count Number of values to mix.
+ */
+void MixAccumulateStrided(float *dest, unsigned int destStride, const float *src, unsigned int srcStride, unsigned int count, float gain);
+
+/**
+ * Scales interleaved stereo samples in place, multiplying the left channel by leftGain and the right channel by rightGain.
+ * @param numSamples Number of stereo samples (pairs of floats) in samples.
+ */
+void MixScaleStereo(float *samples, unsigned int numSamples, float leftGain, float rightGain);
+
+/**
+ * Clamps values in place to a range of [-1, 1].
+ * @param count Number of floats in samples.
+ */
+void MixClamp(float *samples, unsigned int count);
+
+/**
+ * Converts 16-bit integers to floats with a range of [-1, 1].
+ * @param count Number of values in dest and src.
+ */
+void MixInt16ToFloat(float *dest, const int16_t *src, unsigned int count);
+
+/**
+ * Converts unsigned 8-bit integers, with silence at 128, to floats with a range of [-1, 1].
+ * @param count Number of values in dest and src.
+ */
+void MixUInt8ToFloat(float *dest, const uint8_t *src, unsigned int count);
+
+/**
+ * Converts packed 24-bit integers, least significant byte first, to floats with a range of [-1, 1].
+ * @param count Number of values in dest; src is count * 3 bytes in length.
+ */
+void MixInt24ToFloat(float *dest, const uint8_t *src, unsigned int count);
+
+/**
+ * Converts 32-bit integers to floats with a range of [-1, 1].
+ * @param count Number of values in dest and src.
+ */
+void MixInt32ToFloat(float *dest, const int32_t *src, unsigned int count);
+
+/**
+ * Converts floats to 16-bit integers, rounding to the nearest integer and saturating values outside of [-1, 1].
+ * @param count Number of values in dest and src.
+ */
+void MixFloatToInt16(int16_t *dest, const float *src, unsigned int count);
+
+/**
+ * Converts floats to packed 24-bit integers, least significant byte first, rounding to the nearest integer and saturating values outside of [-1, 1].
+ * @param count Number of values in src; dest is count * 3 bytes in length.
+ */
+void MixFloatToInt24(uint8_t *dest, const float *src, unsigned int count);
+
+/**
+ * Adds noise with a triangular probability density to values in place, as used for dithering before converting to integers. This has no vectorized implementations, since each random number depends on the one before it.
+ * @param count Number of floats in samples.
+ * @param amplitude Peak amplitude of the noise; 1 LSB of the target format for TPDF dither.
+ * @param state State of the random number generator, which is updated so that consecutive calls continue the same sequence.
+ */
+void MixAddTriangularNoise(float *samples, unsigned int count, float amplitude, uint32_t &state);
+
+/**
+ * Multiplies interleaved stereo samples by a set of coefficients and sums the results for each channel. Used for FIR filtering.
+ * @param samples Interleaved stereo samples, numSamples * 2 floats in length.
+ * @param coefficients Coefficients with each value repeated for both channels, numSamples * 2 floats in length.
+ * @param numSamples Number of stereo samples (pairs of floats) in samples.
+ */
+void MixDotProductStereo(const float *samples, const float *coefficients, unsigned int numSamples, float &left, float &right);
+
+/**
+ * Calculates left and right channel gains for a balance value using a constant-power pan law. A balance of 0 gives unity gain on both channels.
+ * @param balance Balance value with a range of [-1, 1].
+ */
+void MixPanGains(float balance, float &leftGain, float &rightGain);
+
+/**
+ * @return Name of the instruction set used by the mixing kernels ("avx2", "sse2", "neon" or "scalar").
+ */
+const char *MixGetInstructionSet();
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_MIX_H__ */
@@ -49,6 +49,19 @@ NoiseSound::getSample(unsigned int /*index*/) const
 	return sample;
 }
 
+void
+NoiseSound::getSamples(unsigned int /*index*/, Sample *samples, unsigned int numSamples) const
+{
+	const unsigned int z = ~0;
+
+	for(unsigned int i = 0; i < numSamples; i++) {
+		unsigned int n = (unsigned int)rand();
+		float f = (((float)n / (float)z) - 0.5f) * 2.0f;
+		samples[i][0] = f;
+		samples[i][1] = f;
+	}
+}
+
 NoiseSoundPtr
 NoiseSound::create()
 {
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <vector>
+#include <DromeAudio/Mutex.h>
+#include "Mix.h"
+#include "Resample.h"
+
+namespace DromeAudio {
+
+// number of samples fetched at a time from the sound being resampled
+static const unsigned int SOURCE_BLOCK_SIZE = 1024;
+
+// steps are rounded up to a multiple of 1/RATIO_STEPS when choosing
+// a filter, so that similar ratios can share the same filter
+static const unsigned int RATIO_STEPS = 8;
+
+struct FilterSpec {
+	unsigned int numTaps;
+	unsigned int phaseBits;
+
+	// cutoff frequency as a fraction of the nyquist frequency
+	// when upsampling, and the kaiser window's beta parameter
+	double cutoff;
+	double beta;
+};
+
+static const FilterSpec FILTER_SPECS[] = {
+	{ 1, 0, 0.0, 0.0 },     // RESAMPLE_NEAREST (unused)
+	{ 2, 10, 0.0, 0.0 },    // RESAMPLE_LINEAR
+	{ 8, 10, 0.85, 5.0 },   // RESAMPLE_SINC8
+	{ 32, 9, 0.95, 8.0 }    // RESAMPLE_SINC32
+};
+
+struct FilterEntry {
+	ResampleQuality quality;
+	unsigned int ratio;
+	ResampleFilter *filter;
+};
+
+static double
+besselI0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+
+	for(unsigned int k = 1; k < 50; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if(term < sum * 1e-12)
+			break;
+	}
+
+	return sum;
+}
+
+static ResampleFilter *
+createFilter(ResampleQuality quality, unsigned int ratio)
+{
+	const FilterSpec &spec = FILTER_SPECS[quality];
+
+	ResampleFilter *filter = new ResampleFilter();
+	filter->numTaps = spec.numTaps;
+	filter->phaseBits = spec.phaseBits;
+
+	unsigned int numPhases = 1 << spec.phaseBits;
+	unsigned int rowSize = spec.numTaps * 2;
+	filter->coefficients = new float[numPhases * rowSize];
+
+	// lower the cutoff frequency when downsampling so that
+	// frequencies above the new nyquist frequency don't alias
+	double cutoff = spec.cutoff;
+	if(ratio > RATIO_STEPS)
+		cutoff *= (double)RATIO_STEPS / (double)ratio;
+
+	double halfWidth = (double)spec.numTaps / 2.0;
+	double firstTap = (double)((spec.numTaps - 1) / 2);
+
+	std::vector <double> row(spec.numTaps);
+	for(unsigned int phase = 0; phase < numPhases; phase++) {
+		double fraction = (double)phase / (double)numPhases;
+		double sum = 0.0;
+
+		for(unsigned int tap = 0; tap < spec.numTaps; tap++) {
+			// distance from the resampled position to the tap
+			double x = (double)tap - firstTap - fraction;
+
+			double value;
+			if(quality == RESAMPLE_LINEAR) {
+				value = 1.0 - fabs(x);
+			} else {
+				double sinc = (x == 0.0) ? 1.0 : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+
+				double t = x / halfWidth;
+				double window = (fabs(t) >= 1.0) ? 0.0 : besselI0(spec.beta * sqrt(1.0 - t * t)) / besselI0(spec.beta);
+
+				value = sinc * window;
+			}
+
+			row[tap] = value;
+			sum += value;
+		}
+
+		// normalize each row for unity gain at DC
+		float *coefficients = filter->coefficients + phase * rowSize;
+		for(unsigned int tap = 0; tap < spec.numTaps; tap++) {
+			float value = (float)(row[tap] / sum);
+			coefficients[tap * 2] = value;
+			coefficients[tap * 2 + 1] = value;
+		}
+	}
+
+	return filter;
+}
+
+/*
+ * ResampleFilter class
+ */
+const ResampleFilter *
+ResampleFilter::get(ResampleQuality quality, uint64_t step)
+{
+	if(quality == RESAMPLE_NEAREST)
+		return NULL;
+
+	// linear interpolation doesn't depend on the ratio
+	unsigned int ratio = 0;
+	if(quality != RESAMPLE_LINEAR) {
+		uint64_t r = (step * RATIO_STEPS + 0xffffffff) >> 32;
+		ratio = (r < RATIO_STEPS) ? RATIO_STEPS : (unsigned int)r;
+	}
+
+	static Mutex *mutex = Mutex::create();
+	static std::vector <FilterEntry> filters;
+
+	mutex->lock();
+
+	ResampleFilter *filter = NULL;
+	for(unsigned int i = 0; i < filters.size(); i++) {
+		if(filters[i].quality == quality && filters[i].ratio == ratio) {
+			filter = filters[i].filter;
+			break;
+		}
+	}
+
+	if(!filter) {
+		FilterEntry entry;
+		entry.quality = quality;
+		entry.ratio = ratio;
+		entry.filter = filter = createFilter(quality, ratio);
+		filters.push_back(entry);
+	}
+
+	mutex->unlock();
+	return filter;
+}
+
+/*
+ * Resampling functions
+ */
+uint64_t
+ResampleGetPhase(unsigned int index, uint64_t step)
+{
+	// index * step without overflowing 64 bits
+	return (((uint64_t)index * (step >> 32)) << 32) + (uint64_t)index * (step & 0xffffffff);
+}
+
+static void
+fetchSamples(const SoundPtr &sound, unsigned int numSoundSamples, bool loop, int64_t base, Sample *samples, unsigned int numSamples)
+{
+	unsigned int offset = 0;
+	while(offset < numSamples) {
+		int64_t index = base + (int64_t)offset;
+		unsigned int count = numSamples - offset;
+		bool silent = false;
+
+		if(numSoundSamples != 0 && loop) {
+			index %= (int64_t)numSoundSamples;
+			if(index < 0)
+				index += numSoundSamples;
+			if(count > numSoundSamples - index)
+				count = numSoundSamples - (unsigned int)index;
+		} else if(index < 0) {
+			silent = true;
+			if((int64_t)count > -index)
+				count = (unsigned int)-index;
+		} else if(numSoundSamples != 0) {
+			if(index >= (int64_t)numSoundSamples)
+				silent = true;
+			else if(count > numSoundSamples - index)
+				count = numSoundSamples - (unsigned int)index;
+		}
+
+		if(silent) {
+			for(unsigned int i = 0; i < count; i++)
+				samples[offset + i] = Sample();
+		} else {
+			sound->getSamples((unsigned int)index, samples + offset, count);
+		}
+
+		offset += count;
+	}
+}
+
+void
+ResampleSound(const SoundPtr &sound, bool loop, const ResampleFilter *filter, uint64_t phase, uint64_t step, Sample *samples, unsigned int numSamples)
+{
+	unsigned int numSoundSamples = sound->getNumSamples();
+	unsigned int numTaps = filter ? filter->numTaps : 1;
+	unsigned int rowSize = numTaps * 2;
+	int64_t tapOffset = (numTaps - 1) / 2;
+
+	Sample buffer[SOURCE_BLOCK_SIZE];
+	int64_t base = 0;
+	unsigned int count = 0;
+
+	for(unsigned int i = 0; i < numSamples; i++, phase += step) {
+		int64_t first = (int64_t)(phase >> 32) - tapOffset;
+
+		// fetch the next block of samples from the sound if the
+		// filter's taps extend past the ones already fetched
+		if(count == 0 || first < base || first + numTaps > base + count) {
+			int64_t last = (int64_t)((phase + step * (numSamples - 1 - i)) >> 32) - tapOffset + numTaps - 1;
+
+			base = first;
+			count = (last - base + 1 > (int64_t)SOURCE_BLOCK_SIZE) ? SOURCE_BLOCK_SIZE : (unsigned int)(last - base + 1);
+			fetchSamples(sound, numSoundSamples, loop, base, buffer, count);
+		}
+
+		const Sample *taps = buffer + (first - base);
+		if(!filter) {
+			samples[i] = taps[0];
+			continue;
+		}
+
+		const float *coefficients = filter->coefficients + (((uint32_t)phase) >> (32 - filter->phaseBits)) * rowSize;
+		MixDotProductStereo((const float *)taps, coefficients, numTaps, samples[i][0], samples[i][1]);
+	}
+}
+
+} // namespace DromeAudio
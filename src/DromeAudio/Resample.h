@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_RESAMPLE_H__
+#define __DROMEAUDIO_RESAMPLE_H__
+
+#include <stdint.h>
+#include <DromeAudio/ResampleQuality.h>
+#include <DromeAudio/Sound.h>
+
+namespace DromeAudio {
+
+/*
+ * Polyphase FIR filters for resampling. Positions in a sound are
+ * 32.32 fixed point numbers, and the top bits of a position's
+ * fractional part select the row of coefficients to use.
+ */
+class ResampleFilter
+{
+	public:
+		unsigned int numTaps;
+		unsigned int phaseBits;
+
+		// (1 << phaseBits) rows of numTaps coefficients, with each
+		// coefficient repeated for both channels of a stereo sample
+		float *coefficients;
+
+		/**
+		 * Gets the filter for a quality and step, creating it if it doesn't exist yet. Filters are shared by every user with the same quality and a similar step, and are never destroyed. This locks a mutex, so it shouldn't be called by the audio thread.
+		 * @param step Amount that the position in the sound advances for each resampled sample.
+		 * @return Pointer to the filter, or NULL for RESAMPLE_NEAREST.
+		 */
+		static const ResampleFilter *get(ResampleQuality quality, uint64_t step);
+};
+
+/**
+ * @return Position of the given resampled sample, keeping only the low 32 bits of the position's integer part.
+ */
+uint64_t ResampleGetPhase(unsigned int index, uint64_t step);
+
+/**
+ * Resamples a block of samples from a sound.
+ * @param sound Sound to be resampled.
+ * @param loop If true, positions outside of the sound wrap around to the other end; otherwise they're silent.
+ * @param filter Filter returned by ResampleFilter::get(), or NULL for nearest sample.
+ * @param phase Position in the sound of the first resampled sample.
+ * @param step Amount that the position advances for each resampled sample.
+ * @param samples Array that numSamples Sample objects will be written to.
+ * @param numSamples Number of resampled samples to generate.
+ */
+void ResampleSound(const SoundPtr &sound, bool loop, const ResampleFilter *filter, uint64_t phase, uint64_t step, Sample *samples, unsigned int numSamples);
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_RESAMPLE_H__ */
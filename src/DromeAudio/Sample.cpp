@@ -23,11 +23,147 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cstring>
+#include <vector>
+#include <DromeAudio/ChannelLayout.h>
 #include <DromeAudio/Exception.h>
 #include <DromeAudio/Sample.h>
+#include "Mix.h"
 
 namespace DromeAudio {
 
+/*
+ * Mixes samples with more than two channels down to stereo, using the
+ * given speaker positions or, if channels is NULL, the default channel
+ * layout for the number of channels. Channels past MAX_CHANNELS are
+ * discrete, so they're dropped.
+ */
+template <typename T> static void
+downmixToStereo(const T values[], unsigned int numChannels, float max, Sample samples[], unsigned int numSamples, const Channel *channels)
+{
+	unsigned int numMixedChannels = (numChannels > MAX_CHANNELS) ? MAX_CHANNELS : numChannels;
+	float matrix[2 * MAX_CHANNELS];
+	if(channels)
+		ChannelLayoutGetMixMatrix(channels, numMixedChannels, 2, matrix);
+	else
+		ChannelLayoutGetMixMatrix(numMixedChannels, 2, matrix);
+
+	for(unsigned int i = 0; i < numSamples; i++) {
+		const T *v = values + i * numChannels;
+		float left = 0.0f;
+		float right = 0.0f;
+
+		for(unsigned int c = 0; c < numMixedChannels; c++) {
+			left += matrix[c] * (float)v[c];
+			right += matrix[numMixedChannels + c] * (float)v[c];
+		}
+
+		samples[i][0] = left / max;
+		samples[i][1] = right / max;
+	}
+}
+
+template <typename T> static void
+deinterleave(const T values[], unsigned int numChannels, float max, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples)
+{
+	for(unsigned int c = 0; c < numChannels; c++) {
+		float *channel = buffer.getChannel(c) + offset;
+		const T *v = values + c;
+
+		for(unsigned int i = 0; i < numSamples; i++)
+			channel[i] = (float)v[i * numChannels] / max;
+	}
+}
+
+/*
+ * Converts values of any sample format to floats using the vectorized
+ * mixing kernels. Formats without their own Sample conversions are
+ * converted into a temporary buffer a block at a time before their
+ * channels are mixed down or deinterleaved.
+ */
+static const unsigned int CONVERT_BUFFER_SIZE = 1024;
+
+static void
+convertToFloat(float *dest, const void *values, SampleFormat format, unsigned int count)
+{
+	switch(format) {
+		case SAMPLE_FORMAT_INT8:
+			for(unsigned int i = 0; i < count; i++)
+				dest[i] = (float)((const int8_t *)values)[i] / 127.0f;
+			break;
+		case SAMPLE_FORMAT_UINT8:
+			MixUInt8ToFloat(dest, (const uint8_t *)values, count);
+			break;
+		case SAMPLE_FORMAT_INT16:
+			MixInt16ToFloat(dest, (const int16_t *)values, count);
+			break;
+		case SAMPLE_FORMAT_INT24:
+			MixInt24ToFloat(dest, (const uint8_t *)values, count);
+			break;
+		case SAMPLE_FORMAT_INT32:
+			MixInt32ToFloat(dest, (const int32_t *)values, count);
+			break;
+		case SAMPLE_FORMAT_FLOAT32:
+			memcpy(dest, values, count * sizeof(float));
+			break;
+	}
+}
+
+template <typename Output> static void
+convertBlocks(const void *values, SampleFormat format, unsigned int numChannels, unsigned int numSamples, Output &output)
+{
+	float stackBuffer[CONVERT_BUFFER_SIZE];
+	std::vector <float> heapBuffer;
+	float *buffer = stackBuffer;
+
+	unsigned int blockSize = CONVERT_BUFFER_SIZE / numChannels;
+	if(blockSize == 0) {
+		heapBuffer.resize(numChannels);
+		buffer = &heapBuffer[0];
+		blockSize = 1;
+	}
+
+	const uint8_t *data = (const uint8_t *)values;
+	size_t frameSize = (size_t)numChannels * SampleFormatGetSize(format);
+
+	for(unsigned int i = 0; i < numSamples; i += blockSize) {
+		unsigned int count = numSamples - i;
+		if(count > blockSize)
+			count = blockSize;
+
+		convertToFloat(buffer, data + i * frameSize, format, count * numChannels);
+		output.write(buffer, numChannels, i, count);
+	}
+}
+
+/*
+ * Outputs for convertBlocks()
+ */
+struct ConvertStereoOutput {
+	Sample *samples;
+	const Channel *channels;
+
+	void write(const float *values, unsigned int numChannels, unsigned int index, unsigned int count) {
+		if(numChannels == 1 && !channels) {
+			for(unsigned int i = 0; i < count; i++) {
+				samples[index + i][0] = values[i];
+				samples[index + i][1] = values[i];
+			}
+		} else {
+			downmixToStereo(values, numChannels, 1.0f, samples + index, count, channels);
+		}
+	}
+};
+
+struct ConvertPlanarOutput {
+	SampleBuffer *buffer;
+	unsigned int offset;
+
+	void write(const float *values, unsigned int numChannels, unsigned int index, unsigned int count) {
+		deinterleave(values, numChannels, 1.0f, *buffer, offset + index, count);
+	}
+};
+
 /*
  * Sample class
  */
@@ -199,15 +335,23 @@ Sample::toMono() const
 }
 
 Sample
-Sample::fromInt8(const int8_t values[], unsigned int numChannels)
+Sample::fromInt8(const int8_t values[], unsigned int numChannels, const Channel *channels)
 {
 	const float max = 127.0f;
 	Sample sample;
 
+	if(channels && numChannels != 0) {
+		downmixToStereo(values, numChannels, max, &sample, 1, channels);
+		return sample;
+	}
+
 	switch(numChannels) {
-		default:
+		case 0:
 			throw Exception("Sample::fromInt8(): Unsupported number of channels (%u)\n", numChannels);
 			break;
+		default:
+			downmixToStereo(values, numChannels, max, &sample, 1, NULL);
+			break;
 		case 1:
 			sample[0] = (float)values[0] / max;
 			sample[1] = sample[0];
@@ -221,16 +365,57 @@ Sample::fromInt8(const int8_t values[], unsigned int numChannels)
 	return sample;
 }
 
+void
+Sample::fromInt8(const int8_t values[], unsigned int numChannels, Sample samples[], unsigned int numSamples, const Channel *channels)
+{
+	const float max = 127.0f;
+
+	if(channels && numChannels != 0) {
+		downmixToStereo(values, numChannels, max, samples, numSamples, channels);
+		return;
+	}
+
+	switch(numChannels) {
+		case 0:
+			throw Exception("Sample::fromInt8(): Unsupported number of channels (%u)\n", numChannels);
+			break;
+		default:
+			downmixToStereo(values, numChannels, max, samples, numSamples, NULL);
+			break;
+		case 1:
+			for(unsigned int i = 0; i < numSamples; i++) {
+				float f = (float)values[i] / max;
+				samples[i].m_channelValues[0] = f;
+				samples[i].m_channelValues[1] = f;
+			}
+			break;
+		case 2:
+			for(unsigned int i = 0; i < numSamples; i++) {
+				samples[i].m_channelValues[0] = (float)values[i * 2 + 0] / max;
+				samples[i].m_channelValues[1] = (float)values[i * 2 + 1] / max;
+			}
+			break;
+	}
+}
+
 Sample
-Sample::fromInt16(const int16_t values[], unsigned int numChannels)
+Sample::fromInt16(const int16_t values[], unsigned int numChannels, const Channel *channels)
 {
 	const float max = 32767.0f;
 	Sample sample;
 
+	if(channels && numChannels != 0) {
+		downmixToStereo(values, numChannels, max, &sample, 1, channels);
+		return sample;
+	}
+
 	switch(numChannels) {
-		default:
+		case 0:
 			throw Exception("Sample::fromInt16(): Unsupported number of channels (%u)\n", numChannels);
 			break;
+		default:
+			downmixToStereo(values, numChannels, max, &sample, 1, NULL);
+			break;
 		case 1:
 			sample[0] = (float)values[0] / max;
 			sample[1] = sample[0];
@@ -244,4 +429,94 @@ Sample::fromInt16(const int16_t values[], unsigned int numChannels)
 	return sample;
 }
 
+void
+Sample::fromInt16(const int16_t values[], unsigned int numChannels, Sample samples[], unsigned int numSamples, const Channel *channels)
+{
+	const float max = 32767.0f;
+
+	if(channels && numChannels != 0) {
+		downmixToStereo(values, numChannels, max, samples, numSamples, channels);
+		return;
+	}
+
+	switch(numChannels) {
+		case 0:
+			throw Exception("Sample::fromInt16(): Unsupported number of channels (%u)\n", numChannels);
+			break;
+		default:
+			downmixToStereo(values, numChannels, max, samples, numSamples, NULL);
+			break;
+		case 1:
+			for(unsigned int i = 0; i < numSamples; i++) {
+				float f = (float)values[i] / max;
+				samples[i].m_channelValues[0] = f;
+				samples[i].m_channelValues[1] = f;
+			}
+			break;
+		case 2:
+			// Sample arrays have the same layout as interleaved stereo floats
+			MixInt16ToFloat((float *)samples, values, numSamples * 2);
+			break;
+	}
+}
+
+void
+Sample::fromInt8(const int8_t values[], unsigned int numChannels, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples)
+{
+	deinterleave(values, numChannels, 127.0f, buffer, offset, numSamples);
+}
+
+void
+Sample::fromInt16(const int16_t values[], unsigned int numChannels, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples)
+{
+	// mono data is already planar
+	if(numChannels == 1)
+		MixInt16ToFloat(buffer.getChannel(0) + offset, values, numSamples);
+	else
+		deinterleave(values, numChannels, 32767.0f, buffer, offset, numSamples);
+}
+
+Sample
+Sample::fromFormat(const void *values, SampleFormat format, unsigned int numChannels, const Channel *channels)
+{
+	Sample sample;
+	fromFormat(values, format, numChannels, &sample, 1, channels);
+	return sample;
+}
+
+void
+Sample::fromFormat(const void *values, SampleFormat format, unsigned int numChannels, Sample samples[], unsigned int numSamples, const Channel *channels)
+{
+	if(numChannels == 0)
+		throw Exception("Sample::fromFormat(): Unsupported number of channels (%u)\n", numChannels);
+
+	if(format == SAMPLE_FORMAT_INT8) {
+		fromInt8((const int8_t *)values, numChannels, samples, numSamples, channels);
+	} else if(format == SAMPLE_FORMAT_INT16) {
+		fromInt16((const int16_t *)values, numChannels, samples, numSamples, channels);
+	} else if(numChannels == 2 && !channels) {
+		// Sample arrays have the same layout as interleaved stereo floats
+		convertToFloat((float *)samples, values, format, numSamples * 2);
+	} else {
+		ConvertStereoOutput output = { samples, channels };
+		convertBlocks(values, format, numChannels, numSamples, output);
+	}
+}
+
+void
+Sample::fromFormat(const void *values, SampleFormat format, unsigned int numChannels, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples)
+{
+	if(format == SAMPLE_FORMAT_INT8) {
+		fromInt8((const int8_t *)values, numChannels, buffer, offset, numSamples);
+	} else if(format == SAMPLE_FORMAT_INT16) {
+		fromInt16((const int16_t *)values, numChannels, buffer, offset, numSamples);
+	} else if(numChannels == 1) {
+		// mono data is already planar
+		convertToFloat(buffer.getChannel(0) + offset, values, format, numSamples);
+	} else {
+		ConvertPlanarOutput output = { &buffer, offset };
+		convertBlocks(values, format, numChannels, numSamples, output);
+	}
+}
+
 } // namespace DromeAudio
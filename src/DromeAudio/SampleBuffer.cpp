@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <DromeAudio/SampleBuffer.h>
+
+namespace DromeAudio {
+
+SampleBuffer::SampleBuffer(unsigned int numChannels, unsigned int numSamples)
+{
+	m_numChannels = numChannels;
+	m_numSamples = numSamples;
+	m_data = new float[numChannels * numSamples];
+	m_ownsData = true;
+
+	clear(0, numSamples);
+}
+
+SampleBuffer::SampleBuffer(unsigned int numChannels, unsigned int numSamples, float *data)
+{
+	m_numChannels = numChannels;
+	m_numSamples = numSamples;
+	m_data = data;
+	m_ownsData = false;
+}
+
+SampleBuffer::~SampleBuffer()
+{
+	if(m_ownsData)
+		delete [] m_data;
+}
+
+unsigned int
+SampleBuffer::getNumChannels() const
+{
+	return m_numChannels;
+}
+
+unsigned int
+SampleBuffer::getNumSamples() const
+{
+	return m_numSamples;
+}
+
+float *
+SampleBuffer::getChannel(unsigned int channel)
+{
+	return m_data + channel * m_numSamples;
+}
+
+const float *
+SampleBuffer::getChannel(unsigned int channel) const
+{
+	return m_data + channel * m_numSamples;
+}
+
+void
+SampleBuffer::clear(unsigned int offset, unsigned int numSamples)
+{
+	for(unsigned int i = 0; i < m_numChannels; i++)
+		memset(getChannel(i) + offset, 0, sizeof(float) * numSamples);
+}
+
+} // namespace DromeAudio
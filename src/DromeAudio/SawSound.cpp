@@ -75,6 +75,18 @@ SawSound::getSample(unsigned int index) const
 	return sample;
 }
 
+void
+SawSound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	float period = (float)(getNumSamples() - 1);
+
+	for(unsigned int i = 0; i < numSamples; i++) {
+		float f = (((float)(index + i) / period) - 0.5f) * 2.0f;
+		samples[i][0] = f;
+		samples[i][1] = f;
+	}
+}
+
 SawSoundPtr
 SawSound::create(float frequency)
 {
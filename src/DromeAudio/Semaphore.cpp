@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+	#include <windows.h>
+#elif defined(__APPLE__)
+	#include <dispatch/dispatch.h>
+#else
+	#include <cerrno>
+	#include <ctime>
+	#include <semaphore.h>
+#endif /* _WIN32 */
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/Semaphore.h>
+
+namespace DromeAudio {
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+class PosixSemaphore : public Semaphore
+{
+	protected:
+		sem_t m_semaphore;
+
+	public:
+		PosixSemaphore()
+		{
+			if(sem_init(&m_semaphore, 0, 0) != 0)
+				throw Exception("PosixSemaphore::PosixSemaphore(): sem_init failed");
+		}
+
+		~PosixSemaphore()
+		{
+			sem_destroy(&m_semaphore);
+		}
+
+		void post()
+		{
+			sem_post(&m_semaphore);
+		}
+
+		void wait()
+		{
+			while(sem_wait(&m_semaphore) != 0 && errno == EINTR)
+				;
+		}
+
+		bool wait(unsigned int timeout)
+		{
+			if(timeout == 0)
+				return (sem_trywait(&m_semaphore) == 0);
+
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_sec += timeout / 1000;
+			ts.tv_nsec += (long)(timeout % 1000) * 1000000;
+			if(ts.tv_nsec >= 1000000000) {
+				ts.tv_sec += 1;
+				ts.tv_nsec -= 1000000000;
+			}
+
+			int result;
+			while((result = sem_timedwait(&m_semaphore, &ts)) != 0 && errno == EINTR)
+				;
+
+			return (result == 0);
+		}
+};
+#endif
+
+#ifdef __APPLE__
+// unnamed POSIX semaphores aren't supported on OS X
+class DispatchSemaphore : public Semaphore
+{
+	protected:
+		dispatch_semaphore_t m_semaphore;
+
+	public:
+		DispatchSemaphore()
+		{
+			m_semaphore = dispatch_semaphore_create(0);
+			if(!m_semaphore)
+				throw Exception("DispatchSemaphore::DispatchSemaphore(): dispatch_semaphore_create failed");
+		}
+
+		~DispatchSemaphore()
+		{
+			dispatch_release(m_semaphore);
+		}
+
+		void post()
+		{
+			dispatch_semaphore_signal(m_semaphore);
+		}
+
+		void wait()
+		{
+			dispatch_semaphore_wait(m_semaphore, DISPATCH_TIME_FOREVER);
+		}
+
+		bool wait(unsigned int timeout)
+		{
+			dispatch_time_t t = dispatch_time(DISPATCH_TIME_NOW, (int64_t)timeout * NSEC_PER_MSEC);
+			return (dispatch_semaphore_wait(m_semaphore, t) == 0);
+		}
+};
+#endif /* __APPLE__ */
+
+#ifdef _WIN32
+class WinSemaphore : public Semaphore
+{
+	protected:
+		HANDLE m_semaphore;
+
+	public:
+		WinSemaphore()
+		{
+			m_semaphore = CreateSemaphore(NULL, 0, 0x7fffffff, NULL);
+			if(!m_semaphore)
+				throw Exception("WinSemaphore::WinSemaphore(): CreateSemaphore failed");
+		}
+
+		~WinSemaphore()
+		{
+			CloseHandle(m_semaphore);
+		}
+
+		void post()
+		{
+			ReleaseSemaphore(m_semaphore, 1, NULL);
+		}
+
+		void wait()
+		{
+			WaitForSingleObject(m_semaphore, INFINITE);
+		}
+
+		bool wait(unsigned int timeout)
+		{
+			return (WaitForSingleObject(m_semaphore, timeout) == WAIT_OBJECT_0);
+		}
+};
+#endif /* _WIN32 */
+
+Semaphore *
+Semaphore::create()
+{
+#if defined(_WIN32)
+	return new WinSemaphore();
+#elif defined(__APPLE__)
+	return new DispatchSemaphore();
+#else
+	return new PosixSemaphore();
+#endif /* _WIN32 */
+}
+
+} // namespace DromeAudio
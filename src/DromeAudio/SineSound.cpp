@@ -75,6 +75,18 @@ SineSound::getSample(unsigned int index) const
 	return sample;
 }
 
+void
+SineSound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	float period = (float)getNumSamples();
+
+	for(unsigned int i = 0; i < numSamples; i++) {
+		float f = sinf(M_PI * 2.0f * ((float)(index + i) / period));
+		samples[i][0] = f;
+		samples[i][1] = f;
+	}
+}
+
 SineSoundPtr
 SineSound::create(float frequency)
 {
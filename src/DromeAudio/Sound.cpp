@@ -30,22 +30,35 @@
 #ifdef WITH_OSX
 	#include <DromeAudio/CoreAudioSound.h>
 #endif /* WITH_OSX */
+#ifdef WITH_FLAC
+	#include <DromeAudio/FlacSound.h>
+#endif /* WITH_FLAC */
 #ifdef WITH_VORBIS
 	#include <DromeAudio/VorbisSound.h>
 #endif /* WITH_VORBIS */
 #include <DromeAudio/WavSound.h>
 #include <DromeAudio/Util.h>
-#include "Wav.h"
+#include "WavWriter.h"
 
 using namespace std;
 
 namespace DromeAudio {
 
+// number of samples rendered at a time by save()
+static const unsigned int SAVE_BLOCK_SIZE = 4096;
+
 /*
  * Sound class
  */
 Sound::Sound()
 {
+	m_hasChannelLayout = false;
+}
+
+const Channel *
+Sound::getChannelLayout() const
+{
+	return m_hasChannelLayout ? m_channels : NULL;
 }
 
 unsigned char
@@ -54,6 +67,29 @@ Sound::getNumChannels() const
 	return 1;
 }
 
+Channel
+Sound::getChannel(unsigned int index) const
+{
+	if(m_hasChannelLayout)
+		return (index < MAX_CHANNELS) ? m_channels[index] : CHANNEL_DISCRETE;
+
+	return ChannelLayoutGetChannel(getNumChannels(), index);
+}
+
+void
+Sound::setChannelLayout(const Channel *channels, unsigned int numChannels)
+{
+	// sounds given their default layout keep using it, so that their
+	// samples can still be converted without a mix matrix
+	unsigned int numSoundChannels = getNumChannels();
+	m_hasChannelLayout = false;
+	for(unsigned int i = 0; i < MAX_CHANNELS; i++) {
+		m_channels[i] = (i < numChannels) ? channels[i] : CHANNEL_DISCRETE;
+		if(m_channels[i] != ChannelLayoutGetChannel(numSoundChannels, i))
+			m_hasChannelLayout = true;
+	}
+}
+
 unsigned int
 Sound::getSampleRate() const
 {
@@ -66,6 +102,52 @@ Sound::getNumSamples() const
 	return 0;
 }
 
+size_t
+Sound::getDataSize() const
+{
+	return 0;
+}
+
+void
+Sound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	for(unsigned int i = 0; i < numSamples; i++)
+		samples[i] = getSample(index + i);
+}
+
+void
+Sound::getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const
+{
+	const unsigned int numChannels = getNumChannels();
+	Sample samples[256];
+
+	while(numSamples) {
+		unsigned int n = numSamples < 256 ? numSamples : 256;
+		getSamples(index, samples, n);
+
+		for(unsigned int c = 0; c < numChannels; c++) {
+			float *channel = buffer.getChannel(c) + offset;
+
+			if(c < 2) {
+				for(unsigned int i = 0; i < n; i++)
+					channel[i] = samples[i][c];
+			} else {
+				for(unsigned int i = 0; i < n; i++)
+					channel[i] = 0.0f;
+			}
+		}
+
+		index += n;
+		offset += n;
+		numSamples -= n;
+	}
+}
+
+void
+Sound::prefetch(unsigned int /*index*/)
+{
+}
+
 void
 Sound::setParameter(const string &name, float value)
 {
@@ -73,17 +155,14 @@ Sound::setParameter(const string &name, float value)
 }
 
 void
-Sound::setParameter(const string &name, SoundPtr value)
+Sound::setParameter(const string &name, const SoundPtr &value)
 {
 	throw Exception("No such parameter");
 }
 
 void
-Sound::save(const char *filename, unsigned int numSamples)
+Sound::save(const char *filename, unsigned int numSamples, SampleFormat format, bool dither)
 {
-	const unsigned char bytesPerSample = 2;
-	const unsigned char numChannels = 2;
-
 	// make sure the number of samples to save is good
 	if(numSamples == 0) {
 		if(getNumSamples() == 0)
@@ -92,61 +171,29 @@ Sound::save(const char *filename, unsigned int numSamples)
 		numSamples = getNumSamples();
 	}
 
-	// open file for writing
-	FILE *fp = fopen(filename, "wb");
-	if(!fp)
-		throw Exception("Sound::save(): Unable to open %s for writing", filename);
-
-	// calculate length of sample data
-	unsigned int dataLength = numSamples * (unsigned int)bytesPerSample * (unsigned int)numChannels;
-
-	// create riff header
-	WavChunkHeader hdr;
-	hdr.chunk_id[0] = 'R'; hdr.chunk_id[1] = 'I';
-	hdr.chunk_id[2] = 'F'; hdr.chunk_id[3] = 'F';
-	hdr.chunk_size = NativeToLittleUInt32(4 + (sizeof(WavChunkHeader) * 2) + sizeof(WavFmtChunk));
-	fwrite(&hdr, sizeof(hdr), 1, fp);
-
-	// write riff type
-	char tmp[4];
-	tmp[0] = 'W'; tmp[1] = 'A'; tmp[2] = 'V'; tmp[3] = 'E';
-	fwrite(tmp, 4, 1, fp);
-
-	// write fmt header
-	hdr.chunk_id[0] = 'f'; hdr.chunk_id[1] = 'm';
-	hdr.chunk_id[2] = 't'; hdr.chunk_id[3] = ' ';
-	hdr.chunk_size = NativeToLittleUInt32(sizeof(WavFmtChunk));
-	fwrite(&hdr, sizeof(hdr), 1, fp);
-
-	// write fmt chunk
-	WavFmtChunk fmt;
-	fmt.type = NativeToLittleUInt16(1);
-	fmt.channels = NativeToLittleUInt16(numChannels);
-	fmt.rate = NativeToLittleUInt32(getSampleRate());
-	fmt.bytes_per_second = NativeToLittleUInt32((unsigned int)bytesPerSample * (unsigned int)numChannels * getSampleRate());
-	fmt.block_align = NativeToLittleUInt16((uint16_t)bytesPerSample * (uint16_t)numChannels);
-	fmt.bits_per_sample = NativeToLittleUInt16((uint16_t)bytesPerSample * 8);
-	fwrite(&fmt, sizeof(fmt), 1, fp);
-
-	// write data header
-	hdr.chunk_id[0] = 'd'; hdr.chunk_id[1] = 'a';
-	hdr.chunk_id[2] = 't'; hdr.chunk_id[3] = 'a';
-	hdr.chunk_size = NativeToLittleUInt32(dataLength);
-	fwrite(&hdr, sizeof(hdr), 1, fp);
-
-	// write data
-	for(unsigned int i = 0; i < numSamples; i++) {
-		uint16_t s[2];
-		Sample sample = getSample(i);
-
-		s[0] = NativeToLittleUInt16((uint16_t)(32767.0f * sample[0]));
-		s[1] = NativeToLittleUInt16((uint16_t)(32767.0f * sample[1]));
-
-		fwrite(s, sizeof(s), 1, fp);
+	WavWriter writer(filename, getSampleRate(), 2, format, dither);
+
+	// write data a block at a time; Sample arrays have the
+	// same layout as interleaved stereo floats
+	Sample samples[SAVE_BLOCK_SIZE];
+	unsigned int index = 0;
+
+	// count down the samples left rather than comparing an
+	// index, which would wrap around for lengths near UINT_MAX
+	while(numSamples != 0) {
+		unsigned int count = numSamples;
+		if(count > SAVE_BLOCK_SIZE)
+			count = SAVE_BLOCK_SIZE;
+
+		getSamples(index, samples, count);
+		writer.write((const float *)samples, count);
+
+		index += count;
+		numSamples -= count;
 	}
 
 	// done
-	fclose(fp);
+	writer.close();
 }
 
 SoundPtr
@@ -164,6 +211,10 @@ Sound::create(const char *filename)
 	if(StrCaseCmp(tmp, ".ogg") == 0)
 		return VorbisSound::create(filename);
 #endif /* WITH_VORBIS */
+#ifdef WITH_FLAC
+	if(StrCaseCmp(tmp, ".flac") == 0)
+		return FlacSound::create(filename);
+#endif /* WITH_FLAC */
 #ifdef WITH_OSX
 	return CoreAudioSound::create(filename);
 #else
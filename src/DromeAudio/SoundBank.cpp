@@ -0,0 +1,564 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <DromeAudio/Endian.h>
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/SampleBuffer.h>
+#include <DromeAudio/SoundBank.h>
+#include <DromeAudio/Util.h>
+#include "MappedFile.h"
+#include "Mix.h"
+#include "Wav.h"
+
+using namespace std;
+
+namespace DromeAudio {
+
+/*
+ * Bank files are little endian and laid out as:
+ *
+ *   SoundBankHeader
+ *   SoundBankEntry entries[num_entries]
+ *   uint32_t slots[num_slots]   hash table of entry indices plus one,
+ *                               or 0 for empty slots; linear probing
+ *   char names[names_size]      names, not null-terminated
+ *   sample data, each sound starting on a SOUND_BANK_ALIGNMENT boundary
+ */
+static const uint8_t SOUND_BANK_MAGIC[4] = { 'D', 'A', 'B', 'K' };
+static const uint32_t SOUND_BANK_VERSION = 1;
+static const unsigned int SOUND_BANK_ALIGNMENT = 16;
+
+// number of samples converted at a time when packing non-WAV files
+static const unsigned int PACK_BLOCK_SIZE = 4096;
+
+struct SoundBankHeader {
+	uint8_t magic[4];
+	uint32_t version;
+	uint32_t num_entries;
+	uint32_t num_slots;
+	uint32_t names_size;
+	uint32_t reserved[3];
+};
+
+struct SoundBankEntry {
+	uint32_t name_hash;
+	uint32_t name_offset;
+	uint32_t name_length;
+	uint32_t data_offset_low;
+	uint32_t data_offset_high;
+	uint32_t data_size;
+	uint32_t sample_rate;
+	uint32_t num_samples;
+	uint8_t num_channels;
+	uint8_t format;
+
+	// speaker positions of the first MAX_CHANNELS channels, 4 bits
+	// each, if has_layout is set; otherwise the sound uses the default
+	// layout for its number of channels
+	uint8_t channels[4];
+	uint8_t has_layout;
+	uint8_t reserved;
+};
+
+/*
+ * 32-bit FNV-1a hash of a name.
+ */
+static uint32_t
+SoundBankHash(const char *name, size_t length)
+{
+	uint32_t hash = 2166136261u;
+	for(size_t i = 0; i < length; i++) {
+		hash ^= (uint8_t)name[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static uint64_t
+SoundBankDataOffset(const SoundBankEntry &entry)
+{
+	return ((uint64_t)LittleToNativeUInt32(entry.data_offset_high) << 32) | LittleToNativeUInt32(entry.data_offset_low);
+}
+
+/*
+ * Stores the speaker positions of a sound's channels in its entry, if
+ * they aren't the default layout for its number of channels.
+ */
+static void
+SoundBankSetLayout(SoundBankEntry &entry, const Channel *channels, unsigned int numChannels)
+{
+	for(unsigned int i = 0; i < numChannels && i < MAX_CHANNELS; i++) {
+		entry.channels[i / 2] |= (uint8_t)(channels[i] << ((i % 2) * 4));
+		if(channels[i] != ChannelLayoutGetChannel(numChannels, i))
+			entry.has_layout = 1;
+	}
+}
+
+/*
+ * SoundBankSound class
+ */
+class SoundBankSound : public Sound
+{
+	protected:
+		SoundBankPtr m_bank;
+		unsigned char m_numChannels;
+		unsigned char m_bytesPerSample;
+		SampleFormat m_format;
+		unsigned int m_sampleRate;
+		unsigned int m_numSamples;
+
+		uint32_t m_dataSize;
+		const uint8_t *m_data;
+
+		// set if the samples had to be converted to native byte order
+		uint8_t *m_copy;
+
+	public:
+		SoundBankSound(const SoundBankPtr &bank, const SoundBankEntry &entry, const uint8_t *data)
+		{
+			m_bank = bank;
+			m_numChannels = entry.num_channels;
+			m_format = (SampleFormat)entry.format;
+			m_bytesPerSample = (unsigned char)SampleFormatGetSize(m_format);
+			m_sampleRate = LittleToNativeUInt32(entry.sample_rate);
+			m_numSamples = LittleToNativeUInt32(entry.num_samples);
+			m_dataSize = LittleToNativeUInt32(entry.data_size);
+
+			if(entry.has_layout) {
+				Channel channels[MAX_CHANNELS];
+				for(unsigned int i = 0; i < MAX_CHANNELS; i++)
+					channels[i] = (Channel)((entry.channels[i / 2] >> ((i % 2) * 4)) & 0xf);
+				setChannelLayout(channels, (m_numChannels < MAX_CHANNELS) ? m_numChannels : MAX_CHANNELS);
+			}
+
+			// multi-byte samples other than 24-bit ones have to be
+			// swapped on big endian hosts
+			m_copy = NULL;
+			m_data = data;
+			if(m_bytesPerSample != 1 && m_format != SAMPLE_FORMAT_INT24 && GetEndianness() != ENDIANNESS_LITTLE) {
+				m_copy = new uint8_t [m_dataSize];
+				memcpy(m_copy, data, m_dataSize);
+				WavToNative(m_copy, m_format, m_dataSize);
+				m_data = m_copy;
+			}
+		}
+
+		~SoundBankSound()
+		{
+			delete [] m_copy;
+		}
+
+		unsigned char getNumChannels() const
+		{
+			return m_numChannels;
+		}
+
+		unsigned int getSampleRate() const
+		{
+			return m_sampleRate;
+		}
+
+		unsigned int getNumSamples() const
+		{
+			return m_numSamples;
+		}
+
+		size_t getDataSize() const
+		{
+			return m_dataSize;
+		}
+
+		Sample getSample(unsigned int index) const
+		{
+			index %= m_numSamples;
+
+			const uint8_t *data = m_data + (size_t)index * m_numChannels * m_bytesPerSample;
+			return Sample::fromFormat(data, m_format, m_numChannels, getChannelLayout());
+		}
+
+		void getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+		{
+			index %= m_numSamples;
+
+			while(numSamples != 0) {
+				// copy as many samples as possible before wrapping around
+				unsigned int count = m_numSamples - index;
+				if(count > numSamples)
+					count = numSamples;
+
+				const uint8_t *data = m_data + (size_t)index * m_numChannels * m_bytesPerSample;
+				Sample::fromFormat(data, m_format, m_numChannels, samples, count, getChannelLayout());
+
+				samples += count;
+				numSamples -= count;
+				index = 0;
+			}
+		}
+
+		void getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const
+		{
+			index %= m_numSamples;
+
+			while(numSamples != 0) {
+				// copy as many samples as possible before wrapping around
+				unsigned int count = m_numSamples - index;
+				if(count > numSamples)
+					count = numSamples;
+
+				const uint8_t *data = m_data + (size_t)index * m_numChannels * m_bytesPerSample;
+				Sample::fromFormat(data, m_format, m_numChannels, buffer, offset, count);
+
+				offset += count;
+				numSamples -= count;
+				index = 0;
+			}
+		}
+};
+
+/*
+ * SoundBank class
+ */
+SoundBank::SoundBank(const char *filename)
+{
+	m_file = MappedFile::create(filename);
+
+	const uint8_t *data = m_file->getData();
+	uint64_t size = m_file->getSize();
+
+	try {
+		if(size < sizeof(SoundBankHeader))
+			throw Exception("SoundBank::SoundBank(): %s is too small to be a sound bank", filename);
+
+		const SoundBankHeader *header = (const SoundBankHeader *)data;
+		if(memcmp(header->magic, SOUND_BANK_MAGIC, 4) != 0)
+			throw Exception("SoundBank::SoundBank(): %s is not a sound bank", filename);
+		if(LittleToNativeUInt32(header->version) != SOUND_BANK_VERSION)
+			throw Exception("SoundBank::SoundBank(): %s has unsupported version %u", filename, LittleToNativeUInt32(header->version));
+
+		m_numEntries = LittleToNativeUInt32(header->num_entries);
+		m_numSlots = LittleToNativeUInt32(header->num_slots);
+		uint32_t namesSize = LittleToNativeUInt32(header->names_size);
+
+		// the hash table needs a power of two number of slots with
+		// at least one empty slot for lookups to stop at
+		if(m_numSlots == 0 || (m_numSlots & (m_numSlots - 1)) != 0 || m_numSlots <= m_numEntries)
+			throw Exception("SoundBank::SoundBank(): %s has an invalid hash table", filename);
+
+		uint64_t entriesOffset = sizeof(SoundBankHeader);
+		uint64_t slotsOffset = entriesOffset + (uint64_t)m_numEntries * sizeof(SoundBankEntry);
+		uint64_t namesOffset = slotsOffset + (uint64_t)m_numSlots * sizeof(uint32_t);
+		if(namesOffset + namesSize > size)
+			throw Exception("SoundBank::SoundBank(): %s is truncated", filename);
+
+		m_entries = (const SoundBankEntry *)(data + entriesOffset);
+		m_slots = (const uint32_t *)(data + slotsOffset);
+		m_names = (const char *)(data + namesOffset);
+
+		// check each entry once here so lookups don't have to
+		for(unsigned int i = 0; i < m_numEntries; i++) {
+			const SoundBankEntry &entry = m_entries[i];
+
+			uint64_t nameEnd = (uint64_t)LittleToNativeUInt32(entry.name_offset) + LittleToNativeUInt32(entry.name_length);
+			uint64_t dataEnd = SoundBankDataOffset(entry) + LittleToNativeUInt32(entry.data_size);
+			if(nameEnd > namesSize || dataEnd > size)
+				throw Exception("SoundBank::SoundBank(): %s is truncated", filename);
+
+			if(entry.format > SAMPLE_FORMAT_FLOAT32 || entry.num_channels == 0 ||
+			   LittleToNativeUInt32(entry.num_samples) == 0 || LittleToNativeUInt32(entry.sample_rate) == 0 ||
+			   (uint64_t)LittleToNativeUInt32(entry.num_samples) * entry.num_channels * SampleFormatGetSize((SampleFormat)entry.format) > LittleToNativeUInt32(entry.data_size))
+				throw Exception("SoundBank::SoundBank(): %s has an invalid entry", filename);
+		}
+	} catch(Exception ex) {
+		delete m_file;
+		throw;
+	}
+}
+
+SoundBank::~SoundBank()
+{
+	delete m_file;
+}
+
+unsigned int
+SoundBank::getNumSounds() const
+{
+	return m_numEntries;
+}
+
+string
+SoundBank::getName(unsigned int index) const
+{
+	if(index >= m_numEntries)
+		throw Exception("SoundBank::getName(): Invalid index %u", index);
+
+	const SoundBankEntry &entry = m_entries[index];
+	return string(m_names + LittleToNativeUInt32(entry.name_offset), LittleToNativeUInt32(entry.name_length));
+}
+
+int
+SoundBank::find(const char *name) const
+{
+	size_t length = strlen(name);
+	uint32_t hash = SoundBankHash(name, length);
+
+	// the probe count is bounded in case the table is corrupt
+	uint32_t i = hash & (m_numSlots - 1);
+	for(unsigned int n = 0; n < m_numSlots; n++, i = (i + 1) & (m_numSlots - 1)) {
+		uint32_t slot = LittleToNativeUInt32(m_slots[i]);
+		if(slot == 0 || slot > m_numEntries)
+			return -1;
+
+		const SoundBankEntry &entry = m_entries[slot - 1];
+		if(LittleToNativeUInt32(entry.name_hash) == hash && LittleToNativeUInt32(entry.name_length) == length &&
+		   memcmp(m_names + LittleToNativeUInt32(entry.name_offset), name, length) == 0)
+			return (int)(slot - 1);
+	}
+
+	return -1;
+}
+
+SoundPtr
+SoundBank::getSound(unsigned int index)
+{
+	if(index >= m_numEntries)
+		throw Exception("SoundBank::getSound(): Invalid index %u", index);
+
+	const SoundBankEntry &entry = m_entries[index];
+	const uint8_t *data = m_file->getData() + SoundBankDataOffset(entry);
+	return SoundPtr(new SoundBankSound(SoundBankPtr(this), entry, data));
+}
+
+SoundPtr
+SoundBank::getSound(const char *name)
+{
+	int index = find(name);
+	if(index == -1)
+		throw Exception("SoundBank::getSound(): No sound named %s", name);
+
+	return getSound((unsigned int)index);
+}
+
+SoundBankPtr
+SoundBank::create(const char *filename)
+{
+	return SoundBankPtr(new SoundBank(filename));
+}
+
+/*
+ * Writes the samples of a sound file to a bank, filling in the format
+ * fields of its entry.
+ */
+static void
+SoundBankWriteSound(FILE *out, const char *filename, SoundBankEntry &entry)
+{
+	// look for file extension
+	const char *tmp = filename + strlen(filename);
+	while(tmp != filename && *tmp != '.')
+		--tmp;
+
+	uint32_t dataSize = 0;
+	if(StrCaseCmp(tmp, ".wav") == 0) {
+		// WAV data is already little endian, so it's copied as it is
+		FILE *fp = fopen(filename, "rb");
+		if(!fp)
+			throw Exception("SoundBank::pack(): Unable to open %s for reading", filename);
+
+		WavFmtChunk fmt;
+		SampleFormat format;
+		uint32_t size;
+		Channel channels[MAX_CHANNELS];
+		uint8_t *data = NULL;
+		try {
+			WavReadHeader(fp, fmt, format, size, channels);
+			data = new uint8_t [size];
+		} catch(Exception ex) {
+			fclose(fp);
+			throw;
+		}
+
+		unsigned int frameSize = fmt.channels * SampleFormatGetSize(format);
+		dataSize = (uint32_t)fread(data, 1, size, fp);
+		dataSize -= dataSize % frameSize;
+		fclose(fp);
+
+		bool written = (fwrite(data, 1, dataSize, out) == dataSize);
+		delete [] data;
+		if(!written)
+			throw Exception("SoundBank::pack(): Unable to write samples of %s", filename);
+
+		entry.num_channels = (uint8_t)fmt.channels;
+		entry.format = (uint8_t)format;
+		SoundBankSetLayout(entry, channels, fmt.channels);
+		entry.sample_rate = NativeToLittleUInt32(fmt.rate);
+		entry.num_samples = NativeToLittleUInt32(dataSize / frameSize);
+	} else {
+		// other formats are decoded and stored as 16-bit samples
+		SoundPtr sound = Sound::create(filename);
+		unsigned int numChannels = sound->getNumChannels();
+		unsigned int numSamples = sound->getNumSamples();
+		if(numChannels == 0 || numChannels > 255)
+			throw Exception("SoundBank::pack(): %s has an unsupported number of channels", filename);
+
+		SampleBuffer buffer(numChannels, PACK_BLOCK_SIZE);
+		vector <float> interleaved(PACK_BLOCK_SIZE * numChannels);
+		vector <int16_t> samples(PACK_BLOCK_SIZE * numChannels);
+
+		for(unsigned int i = 0; i < numSamples; i += PACK_BLOCK_SIZE) {
+			unsigned int count = numSamples - i;
+			if(count > PACK_BLOCK_SIZE)
+				count = PACK_BLOCK_SIZE;
+
+			sound->getPlanarSamples(i, buffer, 0, count);
+			for(unsigned int c = 0; c < numChannels; c++) {
+				const float *channel = buffer.getChannel(c);
+				for(unsigned int j = 0; j < count; j++)
+					interleaved[j * numChannels + c] = channel[j];
+			}
+
+			unsigned int n = count * numChannels;
+			MixFloatToInt16(&samples[0], &interleaved[0], n);
+			for(unsigned int j = 0; j < n; j++)
+				samples[j] = NativeToLittleInt16(samples[j]);
+
+			if(fwrite(&samples[0], sizeof(int16_t), n, out) != n)
+				throw Exception("SoundBank::pack(): Unable to write samples of %s", filename);
+		}
+
+		Channel channels[MAX_CHANNELS];
+		for(unsigned int c = 0; c < numChannels && c < MAX_CHANNELS; c++)
+			channels[c] = sound->getChannel(c);
+
+		dataSize = numSamples * numChannels * sizeof(int16_t);
+		entry.num_channels = (uint8_t)numChannels;
+		entry.format = SAMPLE_FORMAT_INT16;
+		SoundBankSetLayout(entry, channels, numChannels);
+		entry.sample_rate = NativeToLittleUInt32(sound->getSampleRate());
+		entry.num_samples = NativeToLittleUInt32(numSamples);
+	}
+
+	if(entry.num_samples == 0)
+		throw Exception("SoundBank::pack(): %s has no samples", filename);
+
+	entry.data_size = NativeToLittleUInt32(dataSize);
+}
+
+static void
+SoundBankPack(FILE *out, const vector <string> &names, const vector <string> &filenames)
+{
+	SoundBankHeader header;
+	memset(&header, 0, sizeof(header));
+
+	// lay out the names and the hash table, keeping the table at most
+	// half full so probe sequences stay short
+	uint32_t numSlots = 1;
+	while(numSlots < names.size() * 2 + 1)
+		numSlots <<= 1;
+
+	vector <SoundBankEntry> entries(names.size());
+	vector <uint32_t> slots(numSlots, 0);
+	string nameData;
+	for(unsigned int i = 0; i < names.size(); i++) {
+		SoundBankEntry &entry = entries[i];
+		memset(&entry, 0, sizeof(entry));
+
+		const string &name = names[i];
+		uint32_t hash = SoundBankHash(name.data(), name.size());
+		entry.name_hash = NativeToLittleUInt32(hash);
+		entry.name_offset = NativeToLittleUInt32((uint32_t)nameData.size());
+		entry.name_length = NativeToLittleUInt32((uint32_t)name.size());
+		nameData += name;
+
+		uint32_t slot = hash & (numSlots - 1);
+		while(slots[slot] != 0) {
+			if(names[LittleToNativeUInt32(slots[slot]) - 1] == name)
+				throw Exception("SoundBank::pack(): Duplicate sound name %s", name.c_str());
+			slot = (slot + 1) & (numSlots - 1);
+		}
+		slots[slot] = NativeToLittleUInt32(i + 1);
+	}
+
+	memcpy(header.magic, SOUND_BANK_MAGIC, 4);
+	header.version = NativeToLittleUInt32(SOUND_BANK_VERSION);
+	header.num_entries = NativeToLittleUInt32((uint32_t)entries.size());
+	header.num_slots = NativeToLittleUInt32(numSlots);
+	header.names_size = NativeToLittleUInt32((uint32_t)nameData.size());
+
+	// write everything but the entries, which are written last
+	// once the data offsets are known
+	uint64_t offset = sizeof(header) + entries.size() * sizeof(SoundBankEntry);
+	if(fseek(out, (long)offset, SEEK_SET) != 0 ||
+	   fwrite(&slots[0], sizeof(uint32_t), numSlots, out) != numSlots ||
+	   fwrite(nameData.data(), 1, nameData.size(), out) != nameData.size())
+		throw Exception("SoundBank::pack(): Unable to write index");
+	offset += numSlots * sizeof(uint32_t) + nameData.size();
+
+	static const uint8_t padding[SOUND_BANK_ALIGNMENT] = { 0 };
+	for(unsigned int i = 0; i < filenames.size(); i++) {
+		unsigned int padSize = (unsigned int)((SOUND_BANK_ALIGNMENT - offset % SOUND_BANK_ALIGNMENT) % SOUND_BANK_ALIGNMENT);
+		if(fwrite(padding, 1, padSize, out) != padSize)
+			throw Exception("SoundBank::pack(): Unable to write samples of %s", filenames[i].c_str());
+		offset += padSize;
+
+		SoundBankEntry &entry = entries[i];
+		entry.data_offset_low = NativeToLittleUInt32((uint32_t)offset);
+		entry.data_offset_high = NativeToLittleUInt32((uint32_t)(offset >> 32));
+		SoundBankWriteSound(out, filenames[i].c_str(), entry);
+		offset += LittleToNativeUInt32(entry.data_size);
+	}
+
+	if(fseek(out, 0, SEEK_SET) != 0 ||
+	   fwrite(&header, sizeof(header), 1, out) != 1 ||
+	   (!entries.empty() && fwrite(&entries[0], sizeof(SoundBankEntry), entries.size(), out) != entries.size()))
+		throw Exception("SoundBank::pack(): Unable to write index");
+}
+
+void
+SoundBank::pack(const char *filename, const vector <string> &names, const vector <string> &filenames)
+{
+	if(names.size() != filenames.size())
+		throw Exception("SoundBank::pack(): Number of names doesn't match number of files");
+
+	FILE *fp = fopen(filename, "wb");
+	if(!fp)
+		throw Exception("SoundBank::pack(): Unable to open %s for writing", filename);
+
+	try {
+		SoundBankPack(fp, names, filenames);
+	} catch(Exception ex) {
+		fclose(fp);
+		remove(filename);
+		throw;
+	}
+
+	if(fclose(fp) != 0) {
+		remove(filename);
+		throw Exception("SoundBank::pack(): Unable to write %s", filename);
+	}
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/Semaphore.h>
+#include <DromeAudio/SoundCache.h>
+
+namespace DromeAudio {
+
+// budget of the shared cache until the application sets one
+static const size_t SOUND_CACHE_SHARED_BUDGET = 128 * 1024 * 1024;
+
+/*
+ * Gets the modification time and size of a file. Returns false if the
+ * file doesn't exist.
+ */
+static bool
+GetFileInfo(const char *filename, int64_t &modificationTime, uint64_t &size)
+{
+#ifdef _WIN32
+	struct _stat64 st;
+	if(_stat64(filename, &st) != 0)
+		return false;
+#else
+	struct stat st;
+	if(stat(filename, &st) != 0)
+		return false;
+#endif /* _WIN32 */
+
+	modificationTime = (int64_t)st.st_mtime;
+	size = (uint64_t)st.st_size;
+	return true;
+}
+
+/*
+ * SoundCacheEntry class
+ */
+class SoundCacheEntry : public RefClass
+{
+	public:
+		std::string filename;
+		int64_t modificationTime;
+		uint64_t fileSize;
+
+		// set when loading finishes; unset if it failed
+		SoundPtr sound;
+		size_t dataSize;
+		bool loading;
+
+		// threads waiting for the entry to finish loading; the
+		// semaphore is created by the first one
+		unsigned int numWaiters;
+		Semaphore *semaphore;
+
+		// position in the cache's list of loaded entries
+		std::list <SoundCacheEntry *>::iterator lruIterator;
+
+		SoundCacheEntry(const char *filename_, int64_t modificationTime_, uint64_t fileSize_)
+		{
+			filename = filename_;
+			modificationTime = modificationTime_;
+			fileSize = fileSize_;
+			dataSize = 0;
+			loading = true;
+			numWaiters = 0;
+			semaphore = NULL;
+		}
+
+		~SoundCacheEntry()
+		{
+			if(semaphore)
+				delete semaphore;
+		}
+};
+
+typedef RefPtr <SoundCacheEntry> SoundCacheEntryPtr;
+
+/*
+ * SoundCache class
+ */
+SoundCache::SoundCache(size_t budget, SoundLoadFunction function)
+{
+	m_function = function ? function : Sound::create;
+	m_budget = budget;
+	m_numBytes = 0;
+	m_numHits = 0;
+	m_numMisses = 0;
+	m_mutex = Mutex::create();
+}
+
+SoundCache::~SoundCache()
+{
+	// entries that are still loading are kept alive by the
+	// threads loading them
+	std::map <std::string, SoundCacheEntry *>::iterator it;
+	for(it = m_entries.begin(); it != m_entries.end(); ++it)
+		it->second->Unref();
+	delete m_mutex;
+}
+
+/*
+ * Removes an entry from the cache; the mutex must be locked. Its sound
+ * is destroyed if nothing else references it.
+ */
+void
+SoundCache::remove(SoundCacheEntry *entry)
+{
+	if(!entry->loading && entry->sound.IsSet()) {
+		m_lru.erase(entry->lruIterator);
+		m_numBytes -= entry->dataSize;
+	}
+
+	// this may release the last reference to the entry
+	m_entries.erase(entry->filename);
+	entry->Unref();
+}
+
+/*
+ * Stores the result of loading an entry and wakes the threads waiting
+ * for it; the mutex must be locked.
+ */
+void
+SoundCache::finish(SoundCacheEntry *entry, const SoundPtr &sound)
+{
+	entry->sound = sound;
+	entry->loading = false;
+	for(unsigned int i = 0; i < entry->numWaiters; i++)
+		entry->semaphore->post();
+	entry->numWaiters = 0;
+
+	// the entry may have been replaced or dropped by clear()
+	// while it was loading
+	std::map <std::string, SoundCacheEntry *>::iterator it = m_entries.find(entry->filename);
+	if(it == m_entries.end() || it->second != entry)
+		return;
+
+	if(!sound) {
+		remove(entry);
+		return;
+	}
+
+	entry->dataSize = sound->getDataSize();
+	m_numBytes += entry->dataSize;
+	m_lru.push_front(entry);
+	entry->lruIterator = m_lru.begin();
+}
+
+/*
+ * Drops unreferenced entries, least recently used first, until the
+ * cache fits in its budget; the mutex must be locked. A sound whose only
+ * reference is its entry can't be referenced again without going through
+ * the cache, so it can't be in use by another thread.
+ */
+void
+SoundCache::evict()
+{
+	std::list <SoundCacheEntry *>::iterator it = m_lru.end();
+	while(m_numBytes > m_budget && it != m_lru.begin()) {
+		SoundCacheEntry *entry = *(--it);
+		if(entry->GetRefCount() != 1 || entry->sound->GetRefCount() != 1)
+			continue;
+
+		// the iterator is moved to the next entry before this
+		// one is removed from the list
+		++it;
+		remove(entry);
+	}
+}
+
+SoundPtr
+SoundCache::load(const char *filename)
+{
+	int64_t modificationTime;
+	uint64_t fileSize;
+	if(!GetFileInfo(filename, modificationTime, fileSize))
+		throw Exception("SoundCache::load(): Unable to open %s", filename);
+
+	m_mutex->lock();
+
+	std::map <std::string, SoundCacheEntry *>::iterator it = m_entries.find(filename);
+	if(it != m_entries.end()) {
+		// referenced in case the entry is removed while waiting
+		SoundCacheEntryPtr entry = it->second;
+		if(entry->modificationTime == modificationTime && entry->fileSize == fileSize) {
+			++m_numHits;
+
+			// wait for another thread to finish loading it
+			if(entry->loading) {
+				if(!entry->semaphore)
+					entry->semaphore = Semaphore::create();
+				++entry->numWaiters;
+
+				m_mutex->unlock();
+				entry->semaphore->wait();
+				m_mutex->lock();
+			} else {
+				m_lru.splice(m_lru.begin(), m_lru, entry->lruIterator);
+			}
+
+			SoundPtr sound = entry->sound;
+			m_mutex->unlock();
+
+			// the loading thread's exception has already been printed
+			if(!sound)
+				throw Exception("SoundCache::load(): Failed to load %s", filename);
+			return sound;
+		}
+
+		// the file has changed; the old sound stays valid for
+		// anything still using it
+		remove(it->second);
+	}
+
+	SoundCacheEntry *entry = new SoundCacheEntry(filename, modificationTime, fileSize);
+	SoundCacheEntryPtr entryRef = entry;
+	entry->Ref();
+	m_entries[filename] = entry;
+	++m_numMisses;
+
+	m_mutex->unlock();
+
+	// load without holding the mutex so that other files can be
+	// loaded and cached sounds returned in the meantime
+	SoundPtr sound;
+	try {
+		sound = m_function(filename);
+	} catch(Exception ex) {
+		m_mutex->lock();
+		finish(entry, SoundPtr());
+		m_mutex->unlock();
+		throw;
+	}
+
+	m_mutex->lock();
+	finish(entry, sound);
+	evict();
+	m_mutex->unlock();
+
+	return sound;
+}
+
+void
+SoundCache::trim()
+{
+	m_mutex->lock();
+	evict();
+	m_mutex->unlock();
+}
+
+void
+SoundCache::clear()
+{
+	m_mutex->lock();
+	size_t budget = m_budget;
+	m_budget = 0;
+	evict();
+	m_budget = budget;
+	m_mutex->unlock();
+}
+
+void
+SoundCache::setBudget(size_t budget)
+{
+	m_mutex->lock();
+	m_budget = budget;
+	evict();
+	m_mutex->unlock();
+}
+
+size_t
+SoundCache::getBudget() const
+{
+	m_mutex->lock();
+	size_t budget = m_budget;
+	m_mutex->unlock();
+	return budget;
+}
+
+size_t
+SoundCache::getNumBytes() const
+{
+	m_mutex->lock();
+	size_t numBytes = m_numBytes;
+	m_mutex->unlock();
+	return numBytes;
+}
+
+unsigned int
+SoundCache::getNumSounds() const
+{
+	m_mutex->lock();
+	unsigned int numSounds = (unsigned int)m_lru.size();
+	m_mutex->unlock();
+	return numSounds;
+}
+
+uint64_t
+SoundCache::getNumHits() const
+{
+	m_mutex->lock();
+	uint64_t numHits = m_numHits;
+	m_mutex->unlock();
+	return numHits;
+}
+
+uint64_t
+SoundCache::getNumMisses() const
+{
+	m_mutex->lock();
+	uint64_t numMisses = m_numMisses;
+	m_mutex->unlock();
+	return numMisses;
+}
+
+SoundCache *
+SoundCache::getShared()
+{
+	// never deleted, so sounds can be loaded through it at any time
+	// until the process exits
+	static SoundCache *cache = new SoundCache(SOUND_CACHE_SHARED_BUDGET);
+	return cache;
+}
+
+SoundPtr
+SoundCache::loadShared(const char *filename)
+{
+	return getShared()->load(filename);
+}
+
+} // namespace DromeAudio
@@ -26,9 +26,15 @@
 #include <cmath>
 #include <DromeAudio/Exception.h>
 #include <DromeAudio/SoundEffect.h>
+#include "Mix.h"
+#include "Resample.h"
 
 namespace DromeAudio {
 
+// number of samples fetched at a time by effects that need
+// a temporary buffer for samples from their associated sound
+static const unsigned int BLOCK_SIZE = 256;
+
 /*
  * SoundEffect class
  */
@@ -50,6 +56,19 @@ SoundEffect::getNumSamples() const
 	return m_sound->getNumSamples();
 }
 
+size_t
+SoundEffect::getDataSize() const
+{
+	return m_sound.IsSet() ? m_sound->getDataSize() : 0;
+}
+
+void
+SoundEffect::prefetch(unsigned int index)
+{
+	if(m_sound.IsSet())
+		m_sound->prefetch(index);
+}
+
 SoundPtr
 SoundEffect::getSound() const
 {
@@ -57,7 +76,7 @@ SoundEffect::getSound() const
 }
 
 void
-SoundEffect::setSound(SoundPtr value)
+SoundEffect::setSound(const SoundPtr &value)
 {
 	m_sound = value;
 }
@@ -65,9 +84,10 @@ SoundEffect::setSound(SoundPtr value)
 /*
  * PitchShiftSoundEffect class
  */
-PitchShiftSoundEffect::PitchShiftSoundEffect(SoundPtr sound, float factor)
+PitchShiftSoundEffect::PitchShiftSoundEffect(const SoundPtr &sound, float factor)
  : SoundEffect(sound)
 {
+	m_resampleQuality = RESAMPLE_SINC8;
 	setFactor(factor);
 }
 
@@ -91,6 +111,21 @@ PitchShiftSoundEffect::setFactor(float value)
 		throw Exception("PitchShiftSoundEffect::setFactor(): Invalid factor value (%f)", value);
 
 	m_factor = value;
+	m_step = (uint64_t)((double)value * 4294967296.0 + 0.5);
+	m_filter = ResampleFilter::get(m_resampleQuality, m_step);
+}
+
+ResampleQuality
+PitchShiftSoundEffect::getResampleQuality() const
+{
+	return m_resampleQuality;
+}
+
+void
+PitchShiftSoundEffect::setResampleQuality(ResampleQuality value)
+{
+	m_resampleQuality = value;
+	m_filter = ResampleFilter::get(m_resampleQuality, m_step);
 }
 
 Sample
@@ -99,19 +134,26 @@ PitchShiftSoundEffect::getSample(unsigned int index) const
 	if(!m_sound)
 		throw Exception("PitchShiftSoundEffect::getSample(): Sound not set");
 
-	float f = (float)index * m_factor;
-	float fl = floor((double)f);
-	unsigned int index1 = (unsigned int)fl;
-	unsigned int index2 = (unsigned int)ceil((double)f);
+	Sample sample;
+	getSamples(index, &sample, 1);
+	return sample;
+}
 
-	Sample s1 = m_sound->getSample(index1);
-	Sample s2 = m_sound->getSample(index2);
+void
+PitchShiftSoundEffect::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	if(!m_sound)
+		throw Exception("PitchShiftSoundEffect::getSamples(): Sound not set");
+	if(numSamples == 0)
+		return;
 
-	return s1 + ((s2 - s1) * (f - fl));
+	// sounds wrap indices past their end, so the filter's
+	// taps do too
+	ResampleSound(m_sound, true, m_filter, ResampleGetPhase(index, m_step), m_step, samples, numSamples);
 }
 
 PitchShiftSoundEffectPtr
-PitchShiftSoundEffect::create(SoundPtr sound, float factor)
+PitchShiftSoundEffect::create(const SoundPtr &sound, float factor)
 {
 	return PitchShiftSoundEffectPtr(new PitchShiftSoundEffect(sound, factor));
 }
@@ -119,7 +161,7 @@ PitchShiftSoundEffect::create(SoundPtr sound, float factor)
 /*
  * OscillatorSoundEffect class
  */
-OscillatorSoundEffect::OscillatorSoundEffect(SoundPtr sound, float frequency)
+OscillatorSoundEffect::OscillatorSoundEffect(const SoundPtr &sound, float frequency)
  : SoundEffect(sound)
 {
 	setFrequency(frequency);
@@ -156,8 +198,24 @@ OscillatorSoundEffect::getSample(unsigned int index) const
 	return sample;
 }
 
+void
+OscillatorSoundEffect::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	if(!m_sound)
+		throw Exception("OscillatorSoundEffect::getSamples(): Sound not set");
+
+	m_sound->getSamples(index, samples, numSamples);
+
+	float tmp = (float)getSampleRate() / m_frequency;
+	for(unsigned int i = 0; i < numSamples; i++) {
+		float f = sinf(M_PI * 2.0f * ((float)(index + i) / tmp));
+		samples[i][0] *= f;
+		samples[i][1] *= f;
+	}
+}
+
 OscillatorSoundEffectPtr
-OscillatorSoundEffect::create(SoundPtr sound, float frequency)
+OscillatorSoundEffect::create(const SoundPtr &sound, float frequency)
 {
 	return OscillatorSoundEffectPtr(new OscillatorSoundEffect(sound, frequency));
 }
@@ -165,7 +223,7 @@ OscillatorSoundEffect::create(SoundPtr sound, float frequency)
 /*
  * EchoSoundEffect class
  */
-EchoSoundEffect::EchoSoundEffect(SoundPtr sound, float delay,
+EchoSoundEffect::EchoSoundEffect(const SoundPtr &sound, float delay,
                                  float factor, unsigned int count)
  : SoundEffect(sound)
 {
@@ -245,8 +303,48 @@ EchoSoundEffect::getSample(unsigned int index) const
 	return sample;
 }
 
+void
+EchoSoundEffect::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	if(!m_sound)
+		throw Exception("EchoSoundEffect::getSamples(): Sound not set");
+
+	uint64_t soundSamples = m_sound->getNumSamples();
+	uint64_t start = index;
+	uint64_t end = start + numSamples;
+
+	// get the samples from the sound itself
+	unsigned int numDirect = 0;
+	if(start < soundSamples)
+		numDirect = (unsigned int)(((end < soundSamples) ? end : soundSamples) - start);
+	m_sound->getSamples(index, samples, numDirect);
+	for(unsigned int i = numDirect; i < numSamples; i++)
+		samples[i] = Sample();
+
+	// add each echo to the range of samples it overlaps; echo n of
+	// sample i is heard at i + n * delay, as long as i is in the sound
+	uint64_t delay = (uint64_t)((float)getSampleRate() * m_delay);
+	float factor = m_factor;
+	Sample buffer[BLOCK_SIZE];
+	for(unsigned int count = 1; count <= m_count; count++) {
+		uint64_t offset = delay * count;
+		uint64_t first = (offset + 1 > start) ? offset + 1 : start;
+		uint64_t last = (offset + soundSamples < end) ? offset + soundSamples : end;
+
+		for(uint64_t i = first; i < last; i += BLOCK_SIZE) {
+			unsigned int n = (unsigned int)((last - i < BLOCK_SIZE) ? last - i : BLOCK_SIZE);
+			m_sound->getSamples((unsigned int)(i - offset), buffer, n);
+
+			float *dest = (float *)(samples + (i - start));
+			MixAccumulate(dest, (const float *)buffer, n * 2, factor);
+		}
+
+		factor *= factor;
+	}
+}
+
 EchoSoundEffectPtr
-EchoSoundEffect::create(SoundPtr sound, float delay, float factor, unsigned int count)
+EchoSoundEffect::create(const SoundPtr &sound, float delay, float factor, unsigned int count)
 {
 	return EchoSoundEffectPtr(new EchoSoundEffect(sound, delay, factor, count));
 }
@@ -23,30 +23,178 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <DromeAudio/ChannelLayout.h>
 #include <DromeAudio/Exception.h>
 #include <DromeAudio/SoundEmitter.h>
+#include "Mix.h"
+#include "Resample.h"
 
 namespace DromeAudio {
 
+// number of samples rendered at a time by mixNextSamples()
+static const unsigned int BLOCK_SIZE = 256;
+
+// gets samples of a sound played with the given step
+static void
+readSamples(const SoundPtr &sound, bool loop, const ResampleFilter *filter, uint64_t step, unsigned int index, Sample *samples, unsigned int numSamples)
+{
+	if(step == ((uint64_t)1 << 32))
+		sound->getSamples(index, samples, numSamples);
+	else
+		ResampleSound(sound, loop, filter, ResampleGetPhase(index, step), step, samples, numSamples);
+}
+
+/*
+ * Targets for SoundEmitter::render()
+ */
+struct EmitterStereoTarget {
+	const SoundPtr *sound;
+	bool loop;
+	const ResampleFilter *filter;
+	uint64_t step;
+	Sample *samples;
+
+	void read(unsigned int index, unsigned int offset, unsigned int count) {
+		readSamples(*sound, loop, filter, step, index, samples + offset, count);
+	}
+
+	void silence(unsigned int offset, unsigned int count) {
+		for(unsigned int i = 0; i < count; i++)
+			samples[offset + i] = Sample();
+	}
+
+	void hold(unsigned int index, unsigned int count) {
+		Sample sample;
+		readSamples(*sound, loop, filter, step, index, &sample, 1);
+		for(unsigned int i = 0; i < count; i++)
+			samples[i] = sample;
+	}
+};
+
+struct EmitterPlanarTarget {
+	const SoundPtr *sound;
+	SampleBuffer *buffer;
+
+	void read(unsigned int index, unsigned int offset, unsigned int count) {
+		(*sound)->getPlanarSamples(index, *buffer, offset, count);
+	}
+
+	void silence(unsigned int offset, unsigned int count) {
+		buffer->clear(offset, count);
+	}
+
+	void hold(unsigned int index, unsigned int count) {
+		(*sound)->getPlanarSamples(index, *buffer, 0, 1);
+		for(unsigned int c = 0; c < buffer->getNumChannels(); c++) {
+			float *channel = buffer->getChannel(c);
+			for(unsigned int i = 1; i < count; i++)
+				channel[i] = channel[0];
+		}
+	}
+};
+
+// gain applied to an output channel, following the side of the
+// listener that it's on so that balance works with any layout
+static float
+getChannelGain(Channel channel, float leftGain, float rightGain, float centerGain)
+{
+	switch(channel) {
+		case CHANNEL_FRONT_LEFT:
+		case CHANNEL_BACK_LEFT:
+		case CHANNEL_SIDE_LEFT:
+			return leftGain;
+		case CHANNEL_FRONT_RIGHT:
+		case CHANNEL_BACK_RIGHT:
+		case CHANNEL_SIDE_RIGHT:
+			return rightGain;
+		default:
+			return centerGain;
+	}
+}
+
 SoundEmitter::SoundEmitter(unsigned int sampleRate)
 {
 	m_sampleRate = sampleRate;
+	m_soundPending = false;
+	m_pendingSoundLock.clear();
+	m_step = 0;
+	m_numSamples = 0;
+	m_resampleQuality = RESAMPLE_SINC8;
+	m_filter = NULL;
 
 	m_loop = true;
 	m_paused = false;
 	m_volume = 1.0f;
 	m_balance = 0.0f;
+	m_gainsChanged = false;
+	updateGains();
 
 	m_sampleIndex = 0;
+	m_seekIndex = 0;
+	m_seekPending = false;
+	m_startDelay = 0;
 }
 
-float
-SoundEmitter::getSampleIndexFactor() const
+void
+SoundEmitter::updateStep()
 {
-	if(!m_sound)
-		return 0.0f;
+	if(!m_sound || m_sampleRate == 0) {
+		m_step = 0;
+		m_numSamples = 0;
+		return;
+	}
+
+	// rounding the step up keeps the position from falling just
+	// short of sample boundaries that it should land on exactly
+	uint64_t step = (((uint64_t)m_sound->getSampleRate() << 32) + m_sampleRate - 1) / m_sampleRate;
+	uint64_t soundSamples = m_sound->getNumSamples();
+
+	// the emitter's length is the number of samples it takes
+	// for the position to reach the end of the sound
+	uint64_t numSamples = 0;
+	if(soundSamples != 0 && step != 0) {
+		numSamples = ((soundSamples << 32) + step - 1) / step;
+		if(numSamples > 0xffffffff)
+			numSamples = 0xffffffff;
+	}
+
+	m_filter = ResampleFilter::get(m_resampleQuality, step);
+	m_step = step;
+	m_numSamples = (unsigned int)numSamples;
+}
+
+void
+SoundEmitter::updateGains()
+{
+	float volume = m_volume.load(std::memory_order_relaxed);
 
-	return (float)m_sound->getSampleRate() / (float)m_sampleRate;
+	MixPanGains(m_balance.load(std::memory_order_relaxed), m_leftGain, m_rightGain);
+	m_leftGain *= volume;
+	m_rightGain *= volume;
+	m_centerGain = volume;
+}
+
+void
+SoundEmitter::applyChanges()
+{
+	// the lock is only tried, so a new sound that setSound() is in
+	// the middle of passing over is picked up at the next block
+	if(m_soundPending.load(std::memory_order_relaxed) &&
+	   !m_pendingSoundLock.test_and_set(std::memory_order_acquire)) {
+		if(m_soundPending.load(std::memory_order_relaxed)) {
+			m_retiredSound = std::move(m_playingSound);
+			m_playingSound = std::move(m_pendingSound);
+			m_soundPending.store(false, std::memory_order_relaxed);
+		}
+
+		m_pendingSoundLock.clear(std::memory_order_release);
+	}
+
+	if(m_gainsChanged.exchange(false, std::memory_order_acquire))
+		updateGains();
+
+	if(m_seekPending.exchange(false, std::memory_order_acquire))
+		m_sampleIndex.store(m_seekIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
 }
 
 uint8_t
@@ -65,6 +213,7 @@ void
 SoundEmitter::setSampleRate(unsigned int value)
 {
 	m_sampleRate = value;
+	updateStep();
 }
 
 SoundPtr
@@ -74,18 +223,45 @@ SoundEmitter::getSound() const
 }
 
 void
-SoundEmitter::setSound(SoundPtr value)
+SoundEmitter::setSound(const SoundPtr &value)
 {
 	m_sound = value;
+	updateStep();
+
+	// the thread playing the emitter only holds the lock for a
+	// couple of pointer moves; a sound it never picked up is
+	// released here, after unlocking
+	SoundPtr unplayed;
+	while(m_pendingSoundLock.test_and_set(std::memory_order_acquire))
+		;
+	unplayed = std::move(m_pendingSound);
+	m_pendingSound = value;
+	m_soundPending.store(true, std::memory_order_relaxed);
+	m_pendingSoundLock.clear(std::memory_order_release);
+
+	// let sounds that load their data in the background start
+	// before the audio thread needs it
+	if(m_sound.IsSet())
+		m_sound->prefetch(0);
 }
 
 unsigned int
 SoundEmitter::getNumSamples() const
 {
-	if(!m_sound)
-		return 0;
+	return m_numSamples;
+}
+
+ResampleQuality
+SoundEmitter::getResampleQuality() const
+{
+	return m_resampleQuality;
+}
 
-	return (unsigned int)((float)m_sound->getNumSamples() / getSampleIndexFactor());
+void
+SoundEmitter::setResampleQuality(ResampleQuality value)
+{
+	m_resampleQuality = value;
+	updateStep();
 }
 
 bool
@@ -121,7 +297,8 @@ SoundEmitter::getVolume() const
 void
 SoundEmitter::setVolume(float value)
 {
-	m_volume = value;
+	m_volume.store(value, std::memory_order_relaxed);
+	m_gainsChanged.store(true, std::memory_order_release);
 }
 
 float
@@ -133,19 +310,53 @@ SoundEmitter::getBalance() const
 void
 SoundEmitter::setBalance(float value)
 {
-	m_balance = value;
+	m_balance.store(value, std::memory_order_relaxed);
+	m_gainsChanged.store(true, std::memory_order_release);
 }
 
 unsigned int
 SoundEmitter::getSampleIndex() const
 {
-	return m_sampleIndex;
+	if(m_seekPending.load(std::memory_order_acquire))
+		return m_seekIndex.load(std::memory_order_relaxed);
+
+	return m_sampleIndex.load(std::memory_order_relaxed);
 }
 
 void
 SoundEmitter::setSampleIndex(unsigned int value)
 {
-	m_sampleIndex = value;
+	// let sounds that read in the background start reading the
+	// new position before the audio thread gets to it
+	if(m_sound.IsSet()) {
+		uint64_t step = m_step.load(std::memory_order_relaxed);
+		m_sound->prefetch((unsigned int)(ResampleGetPhase(value, step) >> 32));
+	}
+
+	m_seekIndex.store(value, std::memory_order_relaxed);
+	m_seekPending.store(true, std::memory_order_release);
+}
+
+unsigned int
+SoundEmitter::getStartDelay() const
+{
+	return m_startDelay.load(std::memory_order_relaxed);
+}
+
+void
+SoundEmitter::setStartDelay(unsigned int value)
+{
+	m_startDelay.store(value, std::memory_order_relaxed);
+}
+
+bool
+SoundEmitter::isFinished() const
+{
+	// sounds with an unlimited number of samples never end
+	if(getNumSamples() == 0)
+		return false;
+
+	return (m_loop == false && getSampleIndex() >= getNumSamples());
 }
 
 bool
@@ -154,7 +365,7 @@ SoundEmitter::isDone()
 	if(!m_sound)
 		throw Exception("SoundEmitter::isDone(): Sound not set");
 
-	return (m_loop == false && m_sampleIndex >= getNumSamples());
+	return isFinished();
 }
 
 Sample
@@ -163,25 +374,212 @@ SoundEmitter::getSample(unsigned int sampleIndex) const
 	if(!m_sound)
 		throw Exception("SoundEmitter::getSample(): Sound not set");
 
-	unsigned int index = (unsigned int)((float)sampleIndex * getSampleIndexFactor());
-	return m_sound->getSample(index);
+	Sample sample;
+	getSamples(sampleIndex, &sample, 1);
+	return sample;
+}
+
+void
+SoundEmitter::getSamples(unsigned int sampleIndex, Sample *samples, unsigned int numSamples) const
+{
+	if(!m_sound)
+		throw Exception("SoundEmitter::getSamples(): Sound not set");
+	if(numSamples == 0)
+		return;
+
+	readSamples(m_sound, m_loop, m_filter, m_step.load(std::memory_order_relaxed), sampleIndex, samples, numSamples);
 }
 
 Sample
 SoundEmitter::getNextSample()
 {
-	Sample sample = getSample(m_sampleIndex).balance(m_balance) * m_volume;
+	applyChanges();
+	if(!m_playingSound)
+		throw Exception("SoundEmitter::getNextSample(): Sound not set");
+
+	Sample sample;
+	renderNextSamples(&sample, 1);
+
+	sample[0] *= m_leftGain;
+	sample[1] *= m_rightGain;
+
+	return sample;
+}
+
+template <typename Target> void
+SoundEmitter::render(Target &target, unsigned int numSamples)
+{
+	unsigned int sampleIndex = m_sampleIndex.load(std::memory_order_relaxed);
+
+	if(m_paused) {
+		// the sample index isn't incremented while paused
+		target.hold(sampleIndex, numSamples);
+		return;
+	}
 
-	// increment the sample index if not paused
-	if(!m_paused) {
-		++m_sampleIndex;
+	bool loop = m_loop;
+	unsigned int totalSamples = getNumSamples();
+	unsigned int offset = 0;
+	while(offset < numSamples) {
+		unsigned int count = numSamples - offset;
+
+		// stop at the end of the sound so that the sample index can be
+		// wrapped around if looping, or silence written if not
+		if(totalSamples != 0) {
+			if(sampleIndex >= totalSamples) {
+				if(!loop) {
+					target.silence(offset, numSamples - offset);
+					break;
+				}
+
+				count = 1;
+			} else if(count > totalSamples - sampleIndex) {
+				count = totalSamples - sampleIndex;
+			}
+		}
+
+		target.read(sampleIndex, offset, count);
+		sampleIndex += count;
+		offset += count;
 
 		// loop if necessary
-		if(m_sampleIndex >= getNumSamples() && m_loop)
-			m_sampleIndex = 0;
+		if(loop && totalSamples != 0 && sampleIndex >= totalSamples)
+			sampleIndex = 0;
 	}
 
-	return sample;
+	m_sampleIndex.store(sampleIndex, std::memory_order_relaxed);
+}
+
+void
+SoundEmitter::renderNextSamples(Sample *samples, unsigned int numSamples)
+{
+	EmitterStereoTarget target = { &m_playingSound, m_loop, m_filter, m_step.load(std::memory_order_relaxed), samples };
+	render(target, numSamples);
+}
+
+void
+SoundEmitter::renderNextPlanarSamples(SampleBuffer &buffer, unsigned int numSamples)
+{
+	EmitterPlanarTarget target = { &m_playingSound, &buffer };
+	render(target, numSamples);
+}
+
+void
+SoundEmitter::getNextSamples(Sample *samples, unsigned int numSamples)
+{
+	applyChanges();
+	if(!m_playingSound)
+		throw Exception("SoundEmitter::getNextSamples(): Sound not set");
+
+	renderNextSamples(samples, numSamples);
+	MixScaleStereo((float *)samples, numSamples, m_leftGain, m_rightGain);
+}
+
+void
+SoundEmitter::mixNextSamples(float *samples, unsigned int numSamples, unsigned int numChannels)
+{
+	if(numChannels == 0 || numChannels > MAX_CHANNELS)
+		throw Exception("SoundEmitter::mixNextSamples(): Unsupported number of channels (%u)", numChannels);
+
+	applyChanges();
+	if(!m_playingSound)
+		return;
+
+	// skip over the start delay, if any
+	unsigned int delay = m_startDelay.load(std::memory_order_relaxed);
+	if(delay != 0) {
+		unsigned int skip = (delay < numSamples) ? delay : numSamples;
+		m_startDelay.store(delay - skip, std::memory_order_relaxed);
+
+		samples += skip * numChannels;
+		numSamples -= skip;
+	}
+
+	// mono sounds, and sounds with more channels than a Sample holds,
+	// are mixed from planar buffers unless they're being resampled;
+	// other sounds are mixed from stereo Samples
+	unsigned int soundChannels = m_playingSound->getNumChannels();
+	bool planar = ((soundChannels == 1 || (soundChannels > 2 && soundChannels <= MAX_CHANNELS)) &&
+	               m_step.load(std::memory_order_relaxed) == ((uint64_t)1 << 32));
+
+	if(planar && soundChannels == 1 && numChannels == 2 && m_playingSound->getChannel(0) == CHANNEL_FRONT_CENTER) {
+		float mono[BLOCK_SIZE];
+		SampleBuffer buffer(1, BLOCK_SIZE, mono);
+
+		for(unsigned int offset = 0; offset < numSamples; offset += BLOCK_SIZE) {
+			unsigned int count = numSamples - offset;
+			if(count > BLOCK_SIZE)
+				count = BLOCK_SIZE;
+
+			renderNextPlanarSamples(buffer, count);
+			MixAccumulateMonoToStereo(samples + offset * 2, mono, count, m_leftGain, m_rightGain);
+		}
+
+		return;
+	}
+
+	if(!planar && numChannels == 2) {
+		Sample buffer[BLOCK_SIZE];
+
+		for(unsigned int offset = 0; offset < numSamples; offset += BLOCK_SIZE) {
+			unsigned int count = numSamples - offset;
+			if(count > BLOCK_SIZE)
+				count = BLOCK_SIZE;
+
+			renderNextSamples(buffer, count);
+			MixAccumulateStereo(samples + offset * 2, (const float *)buffer, count, m_leftGain, m_rightGain);
+		}
+
+		return;
+	}
+
+	// planar buffers are mixed with the speaker positions of the sound's
+	// channels; stereo Samples have already been mixed down with them
+	unsigned int inputChannels = planar ? soundChannels : 2;
+	float matrix[MAX_CHANNELS * MAX_CHANNELS];
+	if(planar) {
+		Channel channels[MAX_CHANNELS];
+		for(unsigned int i = 0; i < inputChannels; i++)
+			channels[i] = m_playingSound->getChannel(i);
+		ChannelLayoutGetMixMatrix(channels, inputChannels, numChannels, matrix);
+	} else {
+		ChannelLayoutGetMixMatrix(inputChannels, numChannels, matrix);
+	}
+
+	for(unsigned int o = 0; o < numChannels; o++) {
+		float gain = getChannelGain(ChannelLayoutGetChannel(numChannels, o), m_leftGain, m_rightGain, m_centerGain);
+		for(unsigned int i = 0; i < inputChannels; i++)
+			matrix[o * inputChannels + i] *= gain;
+	}
+
+	Sample stereo[BLOCK_SIZE];
+	float planes[MAX_CHANNELS * BLOCK_SIZE];
+	SampleBuffer buffer(inputChannels, BLOCK_SIZE, planes);
+
+	for(unsigned int offset = 0; offset < numSamples; offset += BLOCK_SIZE) {
+		unsigned int count = numSamples - offset;
+		if(count > BLOCK_SIZE)
+			count = BLOCK_SIZE;
+
+		if(planar)
+			renderNextPlanarSamples(buffer, count);
+		else
+			renderNextSamples(stereo, count);
+
+		float *dest = samples + offset * numChannels;
+		for(unsigned int o = 0; o < numChannels; o++) {
+			for(unsigned int i = 0; i < inputChannels; i++) {
+				float gain = matrix[o * inputChannels + i];
+				if(gain == 0.0f)
+					continue;
+
+				if(planar)
+					MixAccumulateStrided(dest + o, numChannels, buffer.getChannel(i), 1, count, gain);
+				else
+					MixAccumulateStrided(dest + o, numChannels, (const float *)stereo + i, 2, count, gain);
+			}
+		}
+	}
 }
 
 SoundEmitterPtr
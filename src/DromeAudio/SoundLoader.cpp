@@ -0,0 +1,406 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/SoundLoader.h>
+
+namespace DromeAudio {
+
+// size of the buffer files are read into by the read thread
+static const size_t READ_BUFFER_SIZE = 1024 * 1024;
+
+// number of requests per decode thread that the read thread
+// can read before they're decoded
+static const unsigned int READ_AHEAD_PER_THREAD = 2;
+
+/*
+ * Reads a file from start to end so that its data is in the operating
+ * system's file cache when it's decoded. Returns the number of bytes
+ * read; files that can't be opened are left for the decoder to report.
+ */
+static uint64_t
+readFile(const char *filename, std::vector <uint8_t> &buffer)
+{
+	FILE *fp = fopen(filename, "rb");
+	if(!fp)
+		return 0;
+
+	uint64_t numBytes = 0;
+	size_t result;
+	while((result = fread(&buffer[0], 1, buffer.size(), fp)) > 0)
+		numBytes += result;
+
+	fclose(fp);
+	return numBytes;
+}
+
+/*
+ * SoundLoadRequest class
+ */
+SoundLoadRequest::SoundLoadRequest(const std::string &filename, SoundLoadFunction function, SoundLoadCallback callback, void *userData)
+{
+	m_filename = filename;
+	m_function = function;
+	m_callback = callback;
+	m_userData = userData;
+	m_state = SOUND_LOAD_QUEUED;
+	m_semaphore = Semaphore::create();
+}
+
+SoundLoadRequest::~SoundLoadRequest()
+{
+	delete m_semaphore;
+}
+
+void
+SoundLoadRequest::finish(SoundLoadState state)
+{
+	m_state.store(state, std::memory_order_release);
+
+	// the callback returns before waiting threads are woken
+	if(m_callback)
+		m_callback(this, m_userData);
+
+	m_semaphore->post();
+}
+
+const char *
+SoundLoadRequest::getFilename() const
+{
+	return m_filename.c_str();
+}
+
+SoundLoadState
+SoundLoadRequest::getState() const
+{
+	return (SoundLoadState)m_state.load(std::memory_order_acquire);
+}
+
+bool
+SoundLoadRequest::isFinished() const
+{
+	SoundLoadState state = getState();
+	return (state != SOUND_LOAD_QUEUED && state != SOUND_LOAD_LOADING);
+}
+
+SoundPtr
+SoundLoadRequest::getSound() const
+{
+	if(getState() != SOUND_LOAD_DONE)
+		return SoundPtr();
+
+	return m_sound;
+}
+
+bool
+SoundLoadRequest::cancel()
+{
+	int expected = SOUND_LOAD_QUEUED;
+	if(!m_state.compare_exchange_strong(expected, SOUND_LOAD_CANCELLED))
+		return false;
+
+	m_semaphore->post();
+	return true;
+}
+
+void
+SoundLoadRequest::wait()
+{
+	// post again so that every waiting thread wakes up
+	m_semaphore->wait();
+	m_semaphore->post();
+}
+
+bool
+SoundLoadRequest::wait(unsigned int timeout)
+{
+	if(!m_semaphore->wait(timeout))
+		return false;
+
+	m_semaphore->post();
+	return true;
+}
+
+/*
+ * SoundLoader class
+ */
+SoundLoader::SoundLoader(unsigned int numThreads)
+{
+	if(numThreads == 0) {
+		numThreads = std::thread::hardware_concurrency();
+		if(numThreads == 0)
+			numThreads = 1;
+	}
+
+	m_mutex = Mutex::create();
+	m_readSemaphore = Semaphore::create();
+	m_decodeSemaphore = Semaphore::create();
+	m_readAheadSemaphore = Semaphore::create();
+	for(unsigned int i = 0; i < numThreads * READ_AHEAD_PER_THREAD; i++)
+		m_readAheadSemaphore->post();
+
+	m_running = true;
+	m_numRequests = 0;
+	m_numFinished = 0;
+	m_numBytesRead = 0;
+
+	m_readThread = Thread::create(readThread, this);
+	for(unsigned int i = 0; i < numThreads; i++)
+		m_decodeThreads.push_back(Thread::create(decodeThread, this));
+}
+
+SoundLoader::~SoundLoader()
+{
+	cancelAll();
+
+	// wake every thread wherever it's waiting
+	m_running = false;
+	m_readSemaphore->post();
+	m_readAheadSemaphore->post();
+	for(unsigned int i = 0; i < m_decodeThreads.size(); i++)
+		m_decodeSemaphore->post();
+
+	delete m_readThread;
+	for(unsigned int i = 0; i < m_decodeThreads.size(); i++)
+		delete m_decodeThreads[i];
+
+	// requests made while the threads were stopping
+	// are never started
+	cancelAll();
+
+	delete m_mutex;
+	delete m_readSemaphore;
+	delete m_decodeSemaphore;
+	delete m_readAheadSemaphore;
+}
+
+void
+SoundLoader::finishRequest(const SoundLoadRequestPtr &request, SoundLoadState state)
+{
+	// cancelled requests have already been finished
+	if(state != SOUND_LOAD_CANCELLED) {
+		SoundLoadRequestPtr tmp = request;
+		tmp->finish(state);
+	}
+
+	m_numFinished++;
+}
+
+SoundLoadRequestPtr
+SoundLoader::popRequest(std::deque <SoundLoadRequestPtr> &queue)
+{
+	m_mutex->lock();
+	SoundLoadRequestPtr request = queue.front();
+	queue.pop_front();
+	m_mutex->unlock();
+
+	return request;
+}
+
+void
+SoundLoader::readThread(void *arg)
+{
+	SoundLoader *loader = (SoundLoader *)arg;
+	std::vector <uint8_t> buffer(READ_BUFFER_SIZE);
+
+	for(;;) {
+		loader->m_readSemaphore->wait();
+		if(!loader->m_running)
+			break;
+
+		SoundLoadRequestPtr request = loader->popRequest(loader->m_readQueue);
+		if(request->getState() == SOUND_LOAD_CANCELLED) {
+			loader->finishRequest(request, SOUND_LOAD_CANCELLED);
+			continue;
+		}
+
+		// wait until the decode threads are close enough
+		// that the file will still be cached
+		loader->m_readAheadSemaphore->wait();
+		if(!loader->m_running) {
+			request->cancel();
+			break;
+		}
+
+		if(request->getState() == SOUND_LOAD_CANCELLED) {
+			loader->m_readAheadSemaphore->post();
+			loader->finishRequest(request, SOUND_LOAD_CANCELLED);
+			continue;
+		}
+
+		loader->m_numBytesRead += readFile(request->getFilename(), buffer);
+
+		loader->m_mutex->lock();
+		loader->m_decodeQueue.push_back(request);
+		loader->m_mutex->unlock();
+		loader->m_decodeSemaphore->post();
+	}
+}
+
+void
+SoundLoader::decodeThread(void *arg)
+{
+	SoundLoader *loader = (SoundLoader *)arg;
+
+	for(;;) {
+		loader->m_decodeSemaphore->wait();
+		if(!loader->m_running)
+			break;
+
+		SoundLoadRequestPtr request = loader->popRequest(loader->m_decodeQueue);
+		loader->m_readAheadSemaphore->post();
+
+		int expected = SOUND_LOAD_QUEUED;
+		if(!request->m_state.compare_exchange_strong(expected, SOUND_LOAD_LOADING)) {
+			loader->finishRequest(request, SOUND_LOAD_CANCELLED);
+			continue;
+		}
+
+		// the exception's message has already been printed
+		SoundLoadState state = SOUND_LOAD_FAILED;
+		try {
+			request->m_sound = request->m_function(request->getFilename());
+			if(request->m_sound.IsSet())
+				state = SOUND_LOAD_DONE;
+		} catch(...) {
+		}
+
+		loader->finishRequest(request, state);
+	}
+}
+
+unsigned int
+SoundLoader::getNumThreads() const
+{
+	return (unsigned int)m_decodeThreads.size();
+}
+
+SoundLoadRequestPtr
+SoundLoader::load(const char *filename, SoundLoadFunction function)
+{
+	return load(filename, function, NULL, NULL);
+}
+
+SoundLoadRequestPtr
+SoundLoader::load(const char *filename, SoundLoadFunction function, SoundLoadCallback callback, void *userData)
+{
+	SoundLoadRequestPtr request(new SoundLoadRequest(filename, function ? function : Sound::create, callback, userData));
+
+	m_mutex->lock();
+	m_readQueue.push_back(request);
+	m_mutex->unlock();
+
+	m_numRequests++;
+	m_readSemaphore->post();
+
+	return request;
+}
+
+void
+SoundLoader::load(const std::vector <std::string> &filenames, std::vector <SoundLoadRequestPtr> &requests, SoundLoadFunction function)
+{
+	for(unsigned int i = 0; i < filenames.size(); i++)
+		requests.push_back(load(filenames[i].c_str(), function));
+}
+
+void
+SoundLoader::loadManifest(const char *filename, std::vector <SoundLoadRequestPtr> &requests, SoundLoadFunction function)
+{
+	FILE *fp = fopen(filename, "r");
+	if(!fp)
+		throw Exception("SoundLoader::loadManifest(): Unable to open %s for reading", filename);
+
+	// relative paths start from the manifest's directory
+	std::string directory(filename);
+	size_t separator = directory.find_last_of("/\\");
+	directory.erase((separator == std::string::npos) ? 0 : separator + 1);
+
+	std::vector <std::string> filenames;
+	char line[4096];
+	while(fgets(line, sizeof(line), fp)) {
+		// strip the line ending and trailing whitespace
+		size_t length = strlen(line);
+		while(length != 0 && isspace((unsigned char)line[length - 1]))
+			line[--length] = '\0';
+
+		if(length == 0 || line[0] == '#')
+			continue;
+
+		bool absolute = (line[0] == '/' || line[0] == '\\' || (isalpha((unsigned char)line[0]) && line[1] == ':'));
+		filenames.push_back(absolute ? std::string(line) : (directory + line));
+	}
+
+	fclose(fp);
+
+	load(filenames, requests, function);
+}
+
+void
+SoundLoader::cancelAll()
+{
+	m_mutex->lock();
+
+	for(unsigned int i = 0; i < m_readQueue.size(); i++)
+		m_readQueue[i]->cancel();
+	for(unsigned int i = 0; i < m_decodeQueue.size(); i++)
+		m_decodeQueue[i]->cancel();
+
+	m_mutex->unlock();
+}
+
+unsigned int
+SoundLoader::getNumRequests() const
+{
+	return m_numRequests;
+}
+
+unsigned int
+SoundLoader::getNumFinished() const
+{
+	return m_numFinished;
+}
+
+float
+SoundLoader::getProgress() const
+{
+	unsigned int numFinished = m_numFinished;
+	unsigned int numRequests = m_numRequests;
+	if(numRequests == 0)
+		return 1.0f;
+
+	return (float)numFinished / (float)numRequests;
+}
+
+uint64_t
+SoundLoader::getNumBytesRead() const
+{
+	return m_numBytesRead;
+}
+
+} // namespace DromeAudio
@@ -75,6 +75,18 @@ SquareSound::getSample(unsigned int index) const
 	return sample;
 }
 
+void
+SquareSound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	unsigned int half = getNumSamples() / 2;
+
+	for(unsigned int i = 0; i < numSamples; i++) {
+		float f = (index + i < half) ? 1.0f : -1.0f;
+		samples[i][0] = f;
+		samples[i][1] = f;
+	}
+}
+
 SquareSoundPtr
 SquareSound::create(float frequency)
 {
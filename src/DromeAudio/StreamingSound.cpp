@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/StreamingSound.h>
+
+namespace DromeAudio {
+
+// number of blocks in the ring buffer
+static const unsigned int NUM_BLOCKS = 8;
+
+// smallest number of samples in a block
+static const unsigned int MIN_BLOCK_SIZE = 256;
+
+static const unsigned int INVALID_BLOCK = 0xffffffff;
+
+/*
+ * Outputs for StreamingSound::read()
+ */
+struct StreamStereoOutput {
+	Sample *samples;
+	const Channel *channels;
+
+	void convert(const uint8_t *data, unsigned int numChannels, SampleFormat format, unsigned int count) {
+		Sample::fromFormat(data, format, numChannels, samples, count, channels);
+	}
+
+	void silence(unsigned int count) {
+		for(unsigned int i = 0; i < count; i++)
+			samples[i] = Sample();
+	}
+
+	void advance(unsigned int count) {
+		samples += count;
+	}
+};
+
+struct StreamPlanarOutput {
+	SampleBuffer *buffer;
+	unsigned int offset;
+
+	void convert(const uint8_t *data, unsigned int numChannels, SampleFormat format, unsigned int count) {
+		Sample::fromFormat(data, format, numChannels, *buffer, offset, count);
+	}
+
+	void silence(unsigned int count) {
+		buffer->clear(offset, count);
+	}
+
+	void advance(unsigned int count) {
+		offset += count;
+	}
+};
+
+/*
+ * StreamingSound class
+ */
+StreamingSound::StreamingSound()
+{
+	m_numChannels = 0;
+	m_bytesPerSample = 0;
+	m_format = SAMPLE_FORMAT_INT16;
+	m_sampleRate = 0;
+	m_numSamples = 0;
+
+	m_blockSize = 0;
+	m_numBlocks = 0;
+	m_numSoundBlocks = 0;
+	m_blockData = NULL;
+	m_blockIndices = NULL;
+
+	m_cursor = 0;
+	m_numUnderruns = 0;
+	m_blocking = false;
+
+	m_readMutex = NULL;
+	m_semaphore = NULL;
+	m_thread = NULL;
+	m_running = false;
+}
+
+StreamingSound::~StreamingSound()
+{
+	stop();
+
+	delete m_semaphore;
+	delete m_readMutex;
+	delete [] m_blockIndices;
+	delete [] m_blockData;
+}
+
+void
+StreamingSound::start(unsigned int bufferSize)
+{
+	if(m_numSamples == 0)
+		throw Exception("StreamingSound::start(): Sound contains no samples");
+
+	// split the buffer into blocks
+	unsigned int frameSize = (unsigned int)m_numChannels * m_bytesPerSample;
+	m_numBlocks = NUM_BLOCKS;
+	m_blockSize = bufferSize / NUM_BLOCKS / frameSize;
+	if(m_blockSize < MIN_BLOCK_SIZE)
+		m_blockSize = MIN_BLOCK_SIZE;
+	m_numSoundBlocks = (m_numSamples + m_blockSize - 1) / m_blockSize;
+
+	m_blockData = new uint8_t[m_numBlocks * m_blockSize * frameSize];
+	m_blockIndices = new std::atomic <unsigned int> [m_numBlocks];
+	for(unsigned int i = 0; i < m_numBlocks; i++)
+		m_blockIndices[i] = INVALID_BLOCK;
+
+	m_readMutex = Mutex::create();
+	m_semaphore = Semaphore::create();
+
+	// read the first block so the sound can be played right away,
+	// and leave the rest to the reader thread
+	loadBlock(0, 0, 1);
+
+	m_running = true;
+	m_thread = Thread::create(readerThread, this);
+	m_semaphore->post();
+}
+
+void
+StreamingSound::stop()
+{
+	if(!m_thread)
+		return;
+
+	m_running = false;
+	m_semaphore->post();
+	delete m_thread;
+	m_thread = NULL;
+}
+
+int
+StreamingSound::findBlock(unsigned int block) const
+{
+	for(unsigned int i = 0; i < m_numBlocks; i++) {
+		if(m_blockIndices[i].load(std::memory_order_acquire) == block)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+int
+StreamingSound::loadBlock(unsigned int block, unsigned int first, unsigned int window)
+{
+	// replace a block that's outside of the window of
+	// blocks starting at first that should stay loaded
+	int slot = -1;
+	for(unsigned int i = 0; i < m_numBlocks; i++) {
+		unsigned int index = m_blockIndices[i].load(std::memory_order_relaxed);
+		if(index == INVALID_BLOCK || (index + m_numSoundBlocks - first) % m_numSoundBlocks >= window) {
+			slot = (int)i;
+			break;
+		}
+	}
+
+	if(slot == -1)
+		return -1;
+
+	unsigned int frameSize = (unsigned int)m_numChannels * m_bytesPerSample;
+	unsigned int index = block * m_blockSize;
+	unsigned int count = m_numSamples - index;
+	if(count > m_blockSize)
+		count = m_blockSize;
+
+	// the slot is marked as invalid while it's written to, so
+	// readers that copied from it in the meantime will notice
+	m_blockIndices[slot].store(INVALID_BLOCK, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	readBlock(index, m_blockData + (size_t)slot * m_blockSize * frameSize, count);
+	m_blockIndices[slot].store(block, std::memory_order_release);
+
+	return slot;
+}
+
+void
+StreamingSound::fillBlocks()
+{
+	// if the sound doesn't fit in the ring, the block before the cursor
+	// is kept loaded as well, since resampling starts each read a few
+	// samples before where the last one ended
+	unsigned int window = m_numSoundBlocks;
+	unsigned int behind = 0;
+	if(m_numSoundBlocks > m_numBlocks) {
+		window = m_numBlocks;
+		behind = 1;
+	}
+
+	// load the blocks following the cursor in order, wrapping around
+	// to the start of the sound in case it's looped
+	unsigned int first = m_cursor.load(std::memory_order_relaxed) / m_blockSize;
+	unsigned int i = 0;
+	while(i < window - behind && m_running) {
+		// start over if the cursor moved on while reading
+		unsigned int current = m_cursor.load(std::memory_order_relaxed) / m_blockSize;
+		if(current != first) {
+			first = current;
+			i = 0;
+		}
+
+		unsigned int block = (first + i) % m_numSoundBlocks;
+		i++;
+		if(findBlock(block) != -1)
+			continue;
+
+		m_readMutex->lock();
+		int slot = loadBlock(block, (first + m_numSoundBlocks - behind) % m_numSoundBlocks, window);
+		m_readMutex->unlock();
+
+		if(slot == -1)
+			break;
+	}
+}
+
+void
+StreamingSound::readerThread(void *arg)
+{
+	StreamingSound *sound = (StreamingSound *)arg;
+
+	while(sound->m_running) {
+		sound->m_semaphore->wait();
+		sound->fillBlocks();
+	}
+}
+
+template <typename Output> void
+StreamingSound::read(unsigned int index, unsigned int numSamples, Output &output) const
+{
+	unsigned int frameSize = (unsigned int)m_numChannels * m_bytesPerSample;
+	bool missed = false;
+
+	index %= m_numSamples;
+
+	while(numSamples != 0) {
+		unsigned int block = index / m_blockSize;
+		unsigned int offset = index % m_blockSize;
+
+		// copy as many samples as possible from the block
+		// before moving to the next one or wrapping around
+		unsigned int count = m_blockSize - offset;
+		if(count > m_numSamples - index)
+			count = m_numSamples - index;
+		if(count > numSamples)
+			count = numSamples;
+
+		bool copied = false;
+		int slot = findBlock(block);
+		if(slot != -1) {
+			const uint8_t *data = m_blockData + ((size_t)slot * m_blockSize + offset) * frameSize;
+			output.convert(data, m_numChannels, m_format, count);
+
+			// make sure the block wasn't replaced while copying
+			std::atomic_thread_fence(std::memory_order_acquire);
+			copied = (m_blockIndices[slot].load(std::memory_order_relaxed) == block);
+		}
+
+		if(!copied && m_blocking.load(std::memory_order_relaxed)) {
+			// read the block on this thread, holding the lock while
+			// copying so that the reader thread can't replace it
+			m_readMutex->lock();
+			slot = findBlock(block);
+			if(slot == -1)
+				slot = const_cast <StreamingSound *> (this)->loadBlock(block, block, 1);
+			if(slot != -1) {
+				const uint8_t *data = m_blockData + ((size_t)slot * m_blockSize + offset) * frameSize;
+				output.convert(data, m_numChannels, m_format, count);
+				copied = true;
+			}
+			m_readMutex->unlock();
+		}
+
+		if(!copied) {
+			output.silence(count);
+			missed = true;
+		}
+
+		output.advance(count);
+		numSamples -= count;
+		index += count;
+		if(index >= m_numSamples)
+			index = 0;
+	}
+
+	// wake the reader thread when the cursor moves to a new block
+	unsigned int previous = m_cursor.exchange(index, std::memory_order_relaxed);
+	if(missed)
+		m_numUnderruns.fetch_add(1, std::memory_order_relaxed);
+	if(missed || previous / m_blockSize != index / m_blockSize)
+		m_semaphore->post();
+}
+
+unsigned char
+StreamingSound::getNumChannels() const
+{
+	return m_numChannels;
+}
+
+unsigned int
+StreamingSound::getSampleRate() const
+{
+	return m_sampleRate;
+}
+
+unsigned int
+StreamingSound::getNumSamples() const
+{
+	return m_numSamples;
+}
+
+size_t
+StreamingSound::getDataSize() const
+{
+	return 0;
+}
+
+Sample
+StreamingSound::getSample(unsigned int index) const
+{
+	Sample sample;
+	getSamples(index, &sample, 1);
+	return sample;
+}
+
+void
+StreamingSound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	StreamStereoOutput output = { samples, getChannelLayout() };
+	read(index, numSamples, output);
+}
+
+void
+StreamingSound::getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const
+{
+	StreamPlanarOutput output = { &buffer, offset };
+	read(index, numSamples, output);
+}
+
+void
+StreamingSound::prefetch(unsigned int index)
+{
+	m_cursor.store(index % m_numSamples, std::memory_order_relaxed);
+	m_semaphore->post();
+}
+
+size_t
+StreamingSound::getBufferSize() const
+{
+	return (size_t)m_numBlocks * m_blockSize * m_numChannels * m_bytesPerSample;
+}
+
+unsigned int
+StreamingSound::getNumUnderruns() const
+{
+	return m_numUnderruns.load(std::memory_order_relaxed);
+}
+
+bool
+StreamingSound::getBlocking() const
+{
+	return m_blocking;
+}
+
+void
+StreamingSound::setBlocking(bool value)
+{
+	m_blocking = value;
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <vorbisfile.h>
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/Endian.h>
+#include <DromeAudio/StreamingVorbisSound.h>
+
+namespace DromeAudio {
+
+// number of blocks before the new position that a seek using the
+// seek index looks back through before bisecting the file instead
+static const unsigned int MAX_SEEK_DISTANCE = 4;
+
+/*
+ * StreamingVorbisSound class
+ */
+StreamingVorbisSound::StreamingVorbisSound(const char *filename, unsigned int bufferSize)
+{
+	OggVorbis_File *vf = new OggVorbis_File;
+
+	// open file
+	if(ov_fopen((char *)filename, vf) != 0) {
+		delete vf;
+		throw Exception("StreamingVorbisSound::StreamingVorbisSound(): ov_fopen failed");
+	}
+
+	m_file = vf;
+
+	// get vorbis information
+	vorbis_info *info = ov_info(vf, 0);
+	m_numChannels = (unsigned char)info->channels;
+	m_bytesPerSample = 2;
+	m_format = SAMPLE_FORMAT_INT16;
+	m_sampleRate = (unsigned int)info->rate;
+	m_numSamples = (unsigned int)ov_pcm_total(vf, 0);
+
+	try {
+		start(bufferSize);
+	} catch(Exception ex) {
+		ov_clear(vf);
+		delete vf;
+		throw;
+	}
+}
+
+StreamingVorbisSound::~StreamingVorbisSound()
+{
+	stop();
+
+	OggVorbis_File *vf = (OggVorbis_File *)m_file;
+	ov_clear(vf);
+	delete vf;
+}
+
+bool
+StreamingVorbisSound::seek(unsigned int index)
+{
+	OggVorbis_File *vf = (OggVorbis_File *)m_file;
+	unsigned int block = index / m_blockSize;
+
+	// jump to the page that followed the start of this or an earlier
+	// block when it was decoded, and decode up to the new position;
+	// pages can end past the start of the block they were read for,
+	// in which case an earlier block's page is tried
+	for(unsigned int i = 0; i <= block && i < MAX_SEEK_DISTANCE; i++) {
+		int64_t offset = m_seekIndex[block - i];
+		if(offset < 0)
+			continue;
+
+		if(ov_raw_seek(vf, offset) != 0)
+			break;
+
+		ogg_int64_t position = ov_pcm_tell(vf);
+		if(position < 0)
+			break;
+		if(position > (ogg_int64_t)index)
+			continue;
+
+		// decode and discard the samples before the new position
+		int bigendianp = (GetEndianness() == ENDIANNESS_BIG) ? 1 : 0;
+		int bitstream = 0;
+		char buffer[4096];
+		unsigned int frameSize = (unsigned int)m_numChannels * m_bytesPerSample;
+		while(position < (ogg_int64_t)index) {
+			ogg_int64_t numBytes = ((ogg_int64_t)index - position) * frameSize;
+			if(numBytes > (ogg_int64_t)sizeof(buffer))
+				numBytes = sizeof(buffer);
+
+			long result = ov_read(vf, buffer, (int)numBytes, bigendianp, 2, 1, &bitstream);
+			if(result == OV_HOLE)
+				continue;
+			if(result <= 0)
+				break;
+
+			position += result / frameSize;
+		}
+
+		if(position == (ogg_int64_t)index)
+			return true;
+		break;
+	}
+
+	// bisect the file
+	return (ov_pcm_seek(vf, index) == 0);
+}
+
+void
+StreamingVorbisSound::readBlock(unsigned int index, uint8_t *data, unsigned int numSamples)
+{
+	OggVorbis_File *vf = (OggVorbis_File *)m_file;
+	unsigned int frameSize = (unsigned int)m_numChannels * m_bytesPerSample;
+	size_t numBytes = (size_t)numSamples * frameSize;
+	size_t numRead = 0;
+
+	if(m_seekIndex.empty())
+		m_seekIndex.resize(m_numSoundBlocks, -1);
+
+	bool positioned = (ov_pcm_tell(vf) == (ogg_int64_t)index) || seek(index);
+	if(positioned) {
+		// remember where the block starts for later seeks
+		int64_t &offset = m_seekIndex[index / m_blockSize];
+		if(offset < 0)
+			offset = ov_raw_tell(vf);
+
+		// decode block
+		int bigendianp = (GetEndianness() == ENDIANNESS_BIG) ? 1 : 0;
+		int bitstream = 0;
+		while(numRead < numBytes) {
+			long result = ov_read(vf, (char *)data + numRead, (int)(numBytes - numRead), bigendianp, 2, 1, &bitstream);
+			if(result == OV_HOLE)
+				continue;
+			if(result <= 0)
+				break;
+
+			numRead += (size_t)result;
+		}
+	}
+
+	// anything that couldn't be decoded is played as silence
+	if(numRead < numBytes)
+		memset(data + numRead, 0, numBytes - numRead);
+}
+
+StreamingVorbisSoundPtr
+StreamingVorbisSound::create(const char *filename, unsigned int bufferSize)
+{
+	return StreamingVorbisSoundPtr(new StreamingVorbisSound(filename, bufferSize));
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/Endian.h>
+#include <DromeAudio/StreamingWavSound.h>
+#include "Wav.h"
+
+namespace DromeAudio {
+
+static int
+seekFile(FILE *fp, uint64_t offset)
+{
+#ifdef _WIN32
+	return _fseeki64(fp, (__int64)offset, SEEK_SET);
+#else
+	return fseeko(fp, (off_t)offset, SEEK_SET);
+#endif /* _WIN32 */
+}
+
+static uint64_t
+getFileSize(FILE *fp)
+{
+#ifdef _WIN32
+	_fseeki64(fp, 0, SEEK_END);
+	return (uint64_t)_ftelli64(fp);
+#else
+	fseeko(fp, 0, SEEK_END);
+	return (uint64_t)ftello(fp);
+#endif /* _WIN32 */
+}
+
+/*
+ * StreamingWavSound class
+ */
+StreamingWavSound::StreamingWavSound(const char *filename, unsigned int bufferSize)
+{
+	m_fp = fopen(filename, "rb");
+	if(!m_fp)
+		throw Exception("StreamingWavSound::StreamingWavSound(): Unable to open %s for reading", filename);
+
+	try {
+		WavFmtChunk fmt;
+		uint32_t dataSize;
+		Channel channels[MAX_CHANNELS];
+		WavReadHeader(m_fp, fmt, m_format, dataSize, channels);
+
+		m_numChannels = fmt.channels;
+		m_bytesPerSample = (unsigned char)SampleFormatGetSize(m_format);
+		m_sampleRate = fmt.rate;
+		setChannelLayout(channels, (m_numChannels < MAX_CHANNELS) ? m_numChannels : MAX_CHANNELS);
+
+		// truncated files have less data than the header says
+		m_dataOffset = (uint64_t)ftell(m_fp);
+		uint64_t fileSize = getFileSize(m_fp);
+		uint64_t available = (fileSize > m_dataOffset) ? (fileSize - m_dataOffset) : 0;
+		if(dataSize > available)
+			dataSize = (uint32_t)available;
+
+		m_numSamples = dataSize / m_numChannels / m_bytesPerSample;
+		start(bufferSize);
+	} catch(Exception ex) {
+		fclose(m_fp);
+		throw;
+	}
+}
+
+StreamingWavSound::~StreamingWavSound()
+{
+	stop();
+	fclose(m_fp);
+}
+
+void
+StreamingWavSound::readBlock(unsigned int index, uint8_t *data, unsigned int numSamples)
+{
+	unsigned int frameSize = (unsigned int)m_numChannels * m_bytesPerSample;
+	size_t numBytes = (size_t)numSamples * frameSize;
+	size_t numRead = 0;
+
+	if(seekFile(m_fp, m_dataOffset + (uint64_t)index * frameSize) == 0)
+		numRead = fread(data, 1, numBytes, m_fp);
+
+	// anything that couldn't be read is played as silence, which is
+	// 128 for unsigned 8-bit samples
+	if(numRead < numBytes)
+		memset(data + numRead, (m_format == SAMPLE_FORMAT_UINT8) ? 0x80 : 0, numBytes - numRead);
+
+	// do byte-swapping if necessary
+	WavToNative(data, m_format, numBytes);
+}
+
+StreamingWavSoundPtr
+StreamingWavSound::create(const char *filename, unsigned int bufferSize)
+{
+	return StreamingWavSoundPtr(new StreamingWavSound(filename, bufferSize));
+}
+
+} // namespace DromeAudio
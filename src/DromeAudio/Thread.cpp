@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <pthread.h>
+#endif /* _WIN32 */
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/Thread.h>
+
+namespace DromeAudio {
+
+#ifndef _WIN32
+class PThreadThread : public Thread
+{
+	protected:
+		pthread_t m_thread;
+		bool m_joined;
+
+		Function m_function;
+		void *m_arg;
+
+		static void *
+		start(void *arg)
+		{
+			PThreadThread *thread = (PThreadThread *)arg;
+			thread->m_function(thread->m_arg);
+			return NULL;
+		}
+
+	public:
+		PThreadThread(Function function, void *arg)
+		{
+			m_joined = false;
+			m_function = function;
+			m_arg = arg;
+
+			if(pthread_create(&m_thread, NULL, start, this) != 0)
+				throw Exception("PThreadThread::PThreadThread(): pthread_create failed");
+		}
+
+		~PThreadThread()
+		{
+			join();
+		}
+
+		void join()
+		{
+			if(!m_joined) {
+				pthread_join(m_thread, NULL);
+				m_joined = true;
+			}
+		}
+};
+#endif
+
+#ifdef _WIN32
+class WinThread : public Thread
+{
+	protected:
+		HANDLE m_thread;
+
+		Function m_function;
+		void *m_arg;
+
+		static DWORD WINAPI
+		start(LPVOID arg)
+		{
+			WinThread *thread = (WinThread *)arg;
+			thread->m_function(thread->m_arg);
+			return 0;
+		}
+
+	public:
+		WinThread(Function function, void *arg)
+		{
+			m_function = function;
+			m_arg = arg;
+
+			m_thread = CreateThread(NULL, 0, start, this, 0, NULL);
+			if(!m_thread)
+				throw Exception("WinThread::WinThread(): CreateThread failed");
+		}
+
+		~WinThread()
+		{
+			join();
+			CloseHandle(m_thread);
+		}
+
+		void join()
+		{
+			WaitForSingleObject(m_thread, INFINITE);
+		}
+};
+#endif
+
+Thread *
+Thread::create(Function function, void *arg)
+{
+#if _WIN32
+	return new WinThread(function, arg);
+#else
+	return new PThreadThread(function, arg);
+#endif /* _WIN32 */
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <thread>
+#include <DromeAudio/ThreadPool.h>
+
+namespace DromeAudio {
+
+/*
+ * ThreadPool class
+ */
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+	if(numThreads == 0) {
+		numThreads = std::thread::hardware_concurrency();
+		if(numThreads > 1)
+			numThreads--;
+		else
+			numThreads = 1;
+	}
+
+	m_workSemaphore = Semaphore::create();
+	m_doneSemaphore = Semaphore::create();
+	m_running = true;
+
+	m_busy = false;
+	m_function = NULL;
+	m_arg = NULL;
+	m_numTasks = 0;
+	m_nextTask = 0;
+
+	for(unsigned int i = 0; i < numThreads; i++)
+		m_threads.push_back(Thread::create(threadFunction, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	m_running = false;
+	for(unsigned int i = 0; i < m_threads.size(); i++)
+		m_workSemaphore->post();
+
+	for(unsigned int i = 0; i < m_threads.size(); i++)
+		delete m_threads[i];
+
+	delete m_workSemaphore;
+	delete m_doneSemaphore;
+}
+
+void
+ThreadPool::threadFunction(void *arg)
+{
+	ThreadPool *pool = (ThreadPool *)arg;
+
+	for(;;) {
+		pool->m_workSemaphore->wait();
+		if(!pool->m_running)
+			break;
+
+		pool->runTasks();
+		pool->m_doneSemaphore->post();
+	}
+}
+
+void
+ThreadPool::runTasks()
+{
+	unsigned int index;
+	while((index = m_nextTask++) < m_numTasks)
+		m_function(m_arg, index);
+}
+
+unsigned int
+ThreadPool::getNumThreads() const
+{
+	return (unsigned int)m_threads.size();
+}
+
+void
+ThreadPool::run(Function function, void *arg, unsigned int numTasks)
+{
+	// run on this thread if the pool is in use or there's nothing to split
+	if(numTasks <= 1 || m_busy.exchange(true)) {
+		for(unsigned int i = 0; i < numTasks; i++)
+			function(arg, i);
+		return;
+	}
+
+	m_function = function;
+	m_arg = arg;
+	m_numTasks = numTasks;
+	m_nextTask = 0;
+
+	// wake only as many workers as there are tasks left for them
+	unsigned int numWorkers = (unsigned int)m_threads.size();
+	if(numWorkers > numTasks - 1)
+		numWorkers = numTasks - 1;
+	for(unsigned int i = 0; i < numWorkers; i++)
+		m_workSemaphore->post();
+
+	runTasks();
+
+	// every woken worker posts once it's done with this job, so none of
+	// them can still be looking at it when the next job starts
+	for(unsigned int i = 0; i < numWorkers; i++)
+		m_doneSemaphore->wait();
+
+	m_busy = false;
+}
+
+ThreadPool *
+ThreadPool::getShared()
+{
+	// never deleted; the threads live until the process exits
+	static ThreadPool *pool = new ThreadPool();
+	return pool;
+}
+
+} // namespace DromeAudio
@@ -23,7 +23,9 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <atomic>
 #include <cstdio>
+#include <cstring>
 #include <DromeAudio/Exception.h>
 #include <DromeAudio/Endian.h>
 #include <DromeAudio/VorbisSound.h>
@@ -31,10 +33,79 @@
 
 namespace DromeAudio {
 
+// ranges shorter than this aren't worth the extra open and seek
+static const unsigned int VORBIS_MIN_RANGE_SAMPLES = 65536;
+
+/*
+ * Decodes numBytes of 16-bit samples from the current position of the
+ * given file into data, zero-filling anything the stream is too short for.
+ * Returns false on a decoding error.
+ */
+static bool
+VorbisDecode(OggVorbis_File *vf, uint8_t *data, size_t numBytes)
+{
+	int bigendianp = (GetEndianness() == ENDIANNESS_BIG) ? 1 : 0;
+	int bitstream = 0;
+
+	while(numBytes != 0) {
+		int length = (numBytes < 4096) ? (int)numBytes : 4096;
+		long result = ov_read(vf, (char *)data, length, bigendianp, 2, 1, &bitstream);
+		if(result == OV_HOLE)
+			continue;
+		if(result < 0)
+			return false;
+		if(result == 0)
+			break;
+
+		data += result;
+		numBytes -= (size_t)result;
+	}
+
+	memset(data, 0, numBytes);
+	return true;
+}
+
+/*
+ * VorbisDecodeJob struct
+ */
+struct VorbisDecodeJob {
+	const char *filename;
+	uint8_t *data;
+	unsigned int frameSize;
+	unsigned int numSamples;
+	unsigned int numRanges;
+	std::atomic <bool> failed;
+};
+
+/*
+ * Decodes one range of a VorbisDecodeJob. Each range has its own file
+ * handle and decoder, so ranges can be decoded concurrently; ov_pcm_seek()
+ * is sample-accurate, so the result is the same as a sequential decode.
+ */
+static void
+VorbisDecodeRange(void *arg, unsigned int index)
+{
+	VorbisDecodeJob *job = (VorbisDecodeJob *)arg;
+	unsigned int start = (unsigned int)((uint64_t)job->numSamples * index / job->numRanges);
+	unsigned int end = (unsigned int)((uint64_t)job->numSamples * (index + 1) / job->numRanges);
+
+	OggVorbis_File vf;
+	if(ov_fopen((char *)job->filename, &vf) != 0) {
+		job->failed = true;
+		return;
+	}
+
+	if((start != 0 && ov_pcm_seek(&vf, start) != 0) ||
+	   !VorbisDecode(&vf, job->data + (size_t)start * job->frameSize, (size_t)(end - start) * job->frameSize))
+		job->failed = true;
+
+	ov_clear(&vf);
+}
+
 /*
  * VorbisSound class
  */
-VorbisSound::VorbisSound(const char *filename)
+VorbisSound::VorbisSound(const char *filename, ThreadPool *pool)
 {
 	OggVorbis_File vf;
 
@@ -53,16 +124,37 @@ VorbisSound::VorbisSound(const char *filename)
 	m_dataSize = m_numSamples * m_bytesPerSample * m_numChannels;
 	m_data = new uint8_t [m_dataSize];
 
+	// split the stream into ranges if there's a pool to decode them on
+	unsigned int numRanges = 1;
+	if(pool) {
+		numRanges = pool->getNumThreads() + 1;
+		if(numRanges > m_numSamples / VORBIS_MIN_RANGE_SAMPLES)
+			numRanges = m_numSamples / VORBIS_MIN_RANGE_SAMPLES;
+	}
+
 	// decode file
-	int bigendianp = (GetEndianness() == ENDIANNESS_BIG) ? 1 : 0;
-	int bitstream = 0;
-	char *data = (char *)m_data;
-	int result;
-	while((result = ov_read(&vf, (char *)data, 4096, bigendianp, 2, 1, &bitstream)) > 0)
-		data += result;
+	bool failed;
+	if(numRanges <= 1) {
+		failed = !VorbisDecode(&vf, m_data, m_dataSize);
+		ov_clear(&vf);
+	} else {
+		ov_clear(&vf);
 
-	// done
-	ov_clear(&vf);
+		VorbisDecodeJob job;
+		job.filename = filename;
+		job.data = m_data;
+		job.frameSize = m_bytesPerSample * m_numChannels;
+		job.numSamples = m_numSamples;
+		job.numRanges = numRanges;
+		job.failed = false;
+		pool->run(VorbisDecodeRange, &job, numRanges);
+		failed = job.failed;
+	}
+
+	if(failed) {
+		delete [] m_data;
+		throw Exception("VorbisSound::VorbisSound(): Failed to decode %s", filename);
+	}
 }
 
 VorbisSound::~VorbisSound()
@@ -88,6 +180,12 @@ VorbisSound::getNumSamples() const
 	return m_numSamples;
 }
 
+size_t
+VorbisSound::getDataSize() const
+{
+	return m_dataSize;
+}
+
 Sample
 VorbisSound::getSample(unsigned int index) const
 {
@@ -97,10 +195,10 @@ VorbisSound::getSample(unsigned int index) const
 
 	if(m_bytesPerSample == 2) {
 		int16_t *data = ((int16_t *)m_data) + (index * m_numChannels);
-		sample = Sample::fromInt16(data, m_numChannels);
+		sample = Sample::fromInt16(data, m_numChannels, getChannelLayout());
 	} else if(m_bytesPerSample == 1) {
 		int8_t *data = ((int8_t *)m_data) + (index * m_numChannels);
-		sample = Sample::fromInt8(data, m_numChannels);
+		sample = Sample::fromInt8(data, m_numChannels, getChannelLayout());
 	} else {
 		throw Exception("VorbisSound::getSample(): Unsupported number of bytes per sample (%u)", m_bytesPerSample);
 	}
@@ -108,10 +206,64 @@ VorbisSound::getSample(unsigned int index) const
 	return sample;
 }
 
+void
+VorbisSound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
+	index %= m_numSamples;
+
+	while(numSamples != 0) {
+		// copy as many samples as possible before wrapping around
+		unsigned int count = m_numSamples - index;
+		if(count > numSamples)
+			count = numSamples;
+
+		if(m_bytesPerSample == 2) {
+			int16_t *data = ((int16_t *)m_data) + (index * m_numChannels);
+			Sample::fromInt16(data, m_numChannels, samples, count, getChannelLayout());
+		} else if(m_bytesPerSample == 1) {
+			int8_t *data = ((int8_t *)m_data) + (index * m_numChannels);
+			Sample::fromInt8(data, m_numChannels, samples, count, getChannelLayout());
+		} else {
+			throw Exception("VorbisSound::getSamples(): Unsupported number of bytes per sample (%u)", m_bytesPerSample);
+		}
+
+		samples += count;
+		numSamples -= count;
+		index = 0;
+	}
+}
+
+void
+VorbisSound::getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const
+{
+	index %= m_numSamples;
+
+	while(numSamples != 0) {
+		// copy as many samples as possible before wrapping around
+		unsigned int count = m_numSamples - index;
+		if(count > numSamples)
+			count = numSamples;
+
+		if(m_bytesPerSample == 2) {
+			int16_t *data = ((int16_t *)m_data) + (index * m_numChannels);
+			Sample::fromInt16(data, m_numChannels, buffer, offset, count);
+		} else if(m_bytesPerSample == 1) {
+			int8_t *data = ((int8_t *)m_data) + (index * m_numChannels);
+			Sample::fromInt8(data, m_numChannels, buffer, offset, count);
+		} else {
+			throw Exception("VorbisSound::getPlanarSamples(): Unsupported number of bytes per sample (%u)", m_bytesPerSample);
+		}
+
+		offset += count;
+		numSamples -= count;
+		index = 0;
+	}
+}
+
 VorbisSoundPtr
-VorbisSound::create(const char *filename)
+VorbisSound::create(const char *filename, ThreadPool *pool)
 {
-	return VorbisSoundPtr(new VorbisSound(filename));
+	return VorbisSoundPtr(new VorbisSound(filename, pool));
 }
 
 } // namespace DromeAudio
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <DromeAudio/Exception.h>
+#include <DromeAudio/Endian.h>
+#include "Wav.h"
+
+namespace DromeAudio {
+
+// the subformat GUIDs of ambisonic B-format (.amb) files end with these
+// bytes rather than those of KSDATAFORMAT_SUBTYPE_PCM
+static const uint8_t AMB_GUID_SUFFIX[12] = {
+	0x21, 0x07, 0xd3, 0x11, 0x86, 0x44, 0xc8, 0xc1, 0xca, 0x00, 0x00, 0x00
+};
+
+static const Channel AMB_CHANNELS[] = {
+	CHANNEL_AMBISONIC_W, CHANNEL_AMBISONIC_X, CHANNEL_AMBISONIC_Y, CHANNEL_AMBISONIC_Z
+};
+
+void
+WavReadHeader(FILE *fp, WavFmtChunk &fmt, SampleFormat &format, uint32_t &dataSize, Channel channels[MAX_CHANNELS])
+{
+	// read riff header
+	WavChunkHeader hdr;
+	if(fread(&hdr, sizeof(hdr), 1, fp) != 1)
+		throw Exception("WavReadHeader(): fread failed");
+	hdr.chunk_size = LittleToNativeUInt32(hdr.chunk_size);
+
+	if(hdr.chunk_id[0] != 'R' || hdr.chunk_id[1] != 'I' ||
+	   hdr.chunk_id[2] != 'F' || hdr.chunk_id[3] != 'F')
+		throw Exception("WavReadHeader(): Invalid file [1]");
+
+	// read riff type
+	char tmp[4];
+	if(fread(tmp, sizeof(tmp), 1, fp) != 1)
+		throw Exception("WavReadHeader(): fread failed");
+	if(tmp[0] != 'W' || tmp[1] != 'A' || tmp[2] != 'V' || tmp[3] != 'E')
+		throw Exception("WavReadHeader(): Invalid file [2]");
+
+	// read fmt header, skipping any chunks before it (e.g. the JUNK
+	// chunk reserving space for a ds64 chunk)
+	for(;;) {
+		if(fread(&hdr, sizeof(hdr), 1, fp) != 1)
+			throw Exception("WavReadHeader(): fread failed");
+		hdr.chunk_size = LittleToNativeUInt32(hdr.chunk_size);
+		if(hdr.chunk_id[0] == 'f' && hdr.chunk_id[1] == 'm' &&
+		   hdr.chunk_id[2] == 't' && hdr.chunk_id[3] == ' ')
+			break;
+
+		if(fseek(fp, hdr.chunk_size + (hdr.chunk_size & 1), SEEK_CUR) != 0)
+			throw Exception("WavReadHeader(): Invalid file [3]");
+	}
+
+	// read fmt chunk
+	if(fread(&fmt, sizeof(fmt), 1, fp) != 1)
+		throw Exception("WavReadHeader(): fread failed");
+	fmt.type = LittleToNativeUInt16(fmt.type);
+	fmt.channels = LittleToNativeUInt16(fmt.channels);
+	fmt.rate = LittleToNativeUInt32(fmt.rate);
+	fmt.bytes_per_second = LittleToNativeUInt32(fmt.bytes_per_second);
+	fmt.block_align = LittleToNativeUInt16(fmt.block_align);
+	fmt.bits_per_sample = LittleToNativeUInt16(fmt.bits_per_sample);
+
+	uint32_t fmtSize = sizeof(fmt);
+	unsigned int numPositions = (fmt.channels < MAX_CHANNELS) ? fmt.channels : MAX_CHANNELS;
+	for(unsigned int i = 0; i < numPositions; i++)
+		channels[i] = ChannelLayoutGetChannel(fmt.channels, i);
+
+	// extensible files give the actual format in their subformat GUID,
+	// which starts with the format code, and the speaker positions of
+	// their channels in a channel mask
+	if(fmt.type == WAV_FORMAT_EXTENSIBLE && hdr.chunk_size >= sizeof(fmt) + 24) {
+		uint8_t extension[24];
+		if(fread(extension, sizeof(extension), 1, fp) != 1)
+			throw Exception("WavReadHeader(): fread failed");
+		fmtSize += sizeof(extension);
+
+		fmt.type = (uint16_t)(extension[8] | (extension[9] << 8));
+
+		if(memcmp(extension + 12, AMB_GUID_SUFFIX, sizeof(AMB_GUID_SUFFIX)) == 0) {
+			// components past first order are discrete
+			for(unsigned int i = 0; i < numPositions; i++)
+				channels[i] = (i < 4) ? AMB_CHANNELS[i] : CHANNEL_DISCRETE;
+		} else {
+			uint32_t mask = (uint32_t)extension[4] | ((uint32_t)extension[5] << 8) |
+			                ((uint32_t)extension[6] << 16) | ((uint32_t)extension[7] << 24);
+			ChannelLayoutFromWavMask(mask, numPositions, channels);
+		}
+	}
+
+	// make sure the compression type is supported
+	if(fmt.type != WAV_FORMAT_PCM && fmt.type != WAV_FORMAT_IEEE_FLOAT)
+		throw Exception("WavReadHeader(): Unsupported compression type (0x%x); only uncompressed PCM and IEEE float are supported", fmt.type);
+
+	// samples that don't fill their container (e.g. 20 bits in 3 bytes)
+	// are stored in its most significant bits, so they're read as if
+	// they fill it
+	unsigned int bytesPerSample = (fmt.bits_per_sample + 7) / 8;
+	bool supported = false;
+	if(fmt.type == WAV_FORMAT_IEEE_FLOAT) {
+		format = SAMPLE_FORMAT_FLOAT32;
+		supported = (bytesPerSample == 4);
+	} else if(bytesPerSample >= 1 && bytesPerSample <= 4) {
+		const SampleFormat formats[] = { SAMPLE_FORMAT_UINT8, SAMPLE_FORMAT_INT16, SAMPLE_FORMAT_INT24, SAMPLE_FORMAT_INT32 };
+		format = formats[bytesPerSample - 1];
+		supported = true;
+	}
+
+	if(fmt.channels == 0 || !supported)
+		throw Exception("WavReadHeader(): Unsupported format (%u channels, %u bits per sample)", fmt.channels, fmt.bits_per_sample);
+
+	// skip the rest of the fmt chunk if it's larger than expected
+	if(hdr.chunk_size > fmtSize)
+		fseek(fp, hdr.chunk_size - fmtSize + (hdr.chunk_size & 1), SEEK_CUR);
+
+	// look for data chunk
+	while(fread(&hdr, sizeof(hdr), 1, fp) == 1) {
+		hdr.chunk_size = LittleToNativeUInt32(hdr.chunk_size);
+
+		if(hdr.chunk_id[0] == 'd' && hdr.chunk_id[1] == 'a' &&
+		   hdr.chunk_id[2] == 't' && hdr.chunk_id[3] == 'a') {
+			dataSize = hdr.chunk_size;
+			return;
+		}
+
+		// chunks are padded to an even size
+		if(fseek(fp, hdr.chunk_size + (hdr.chunk_size & 1), SEEK_CUR) != 0)
+			break;
+	}
+
+	throw Exception("WavReadHeader(): No data chunk found");
+}
+
+void
+WavToNative(uint8_t *data, SampleFormat format, size_t numBytes)
+{
+	if(GetEndianness() == ENDIANNESS_LITTLE)
+		return;
+
+	if(format == SAMPLE_FORMAT_INT16) {
+		int16_t *samples = (int16_t *)data;
+		for(size_t i = 0; i < numBytes / 2; i++)
+			samples[i] = LittleToNativeInt16(samples[i]);
+	} else if(format == SAMPLE_FORMAT_INT32 || format == SAMPLE_FORMAT_FLOAT32) {
+		uint32_t *samples = (uint32_t *)data;
+		for(size_t i = 0; i < numBytes / 4; i++)
+			samples[i] = LittleToNativeUInt32(samples[i]);
+	}
+}
+
+} // namespace DromeAudio
@@ -23,8 +23,17 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cstdio>
+#include <stdint.h>
+#include <DromeAudio/ChannelLayout.h>
+#include <DromeAudio/SampleFormat.h>
+
 namespace DromeAudio {
 
+static const uint16_t WAV_FORMAT_PCM = 1;
+static const uint16_t WAV_FORMAT_IEEE_FLOAT = 3;
+static const uint16_t WAV_FORMAT_EXTENSIBLE = 0xfffe;
+
 struct WavChunkHeader {
 	uint8_t chunk_id[4];
 	uint32_t chunk_size;
@@ -39,4 +48,26 @@ struct WavFmtChunk {
 	uint16_t bits_per_sample;
 };
 
+/*
+ * Reads the RIFF, WAVE and fmt headers of an uncompressed WAV file and
+ * finds its data chunk, leaving the file positioned at the start of the
+ * sample data. Integer PCM of 8 to 32 bits, 32-bit IEEE float and the
+ * WAVE_FORMAT_EXTENSIBLE forms of both are supported. The fmt chunk is
+ * converted to native byte order, with the type of extensible files
+ * replaced by that of their subformat, and the format of the samples is
+ * returned in format. The speaker positions of the first MAX_CHANNELS
+ * channels are written to channels, from the channel mask of extensible
+ * files or as first-order ambisonics for .amb files, and in the default
+ * layout for their number otherwise. Throws an exception for invalid or
+ * unsupported files; the caller is responsible for closing the file.
+ */
+void WavReadHeader(FILE *fp, WavFmtChunk &fmt, SampleFormat &format, uint32_t &dataSize, Channel channels[MAX_CHANNELS]);
+
+/*
+ * Converts sample data read from a WAV file to native byte order in
+ * place. 24-bit samples are left as they are, since SAMPLE_FORMAT_INT24
+ * is always least significant byte first.
+ */
+void WavToNative(uint8_t *data, SampleFormat format, size_t numBytes);
+
 } // namespace DromeAudio
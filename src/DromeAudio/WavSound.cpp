@@ -27,6 +27,7 @@
 #include <DromeAudio/Exception.h>
 #include <DromeAudio/Endian.h>
 #include <DromeAudio/WavSound.h>
+#include "MappedFile.h"
 #include "Wav.h"
 
 namespace DromeAudio {
@@ -34,105 +35,66 @@ namespace DromeAudio {
 /*
  * WavSound class
  */
-WavSound::WavSound(const char *filename)
+WavSound::WavSound(const char *filename, bool mapped)
 {
 	FILE *fp = fopen(filename, "rb");
 	if(!fp)
 		throw Exception("WavSound::WavSound(): Unable to open %s for reading", filename);
 
-    // read riff header
-	WavChunkHeader hdr;
-	fread(&hdr, sizeof(hdr), 1, fp);
-	hdr.chunk_size = LittleToNativeUInt32(hdr.chunk_size);
-
-	if(hdr.chunk_id[0] != 'R' || hdr.chunk_id[1] != 'I' ||
-	   hdr.chunk_id[2] != 'F' || hdr.chunk_id[3] != 'F') {
-		fclose(fp);
-		throw Exception("WavSound::WavSound(): Invalid file [1]");
-	}
-
-	// read riff type
-	char tmp[4];
-	if(fread(tmp, sizeof(tmp), 1, fp) != 1) {
-		fclose(fp);
-		throw Exception("WavSound::WavSound(): fread failed");
-	}
-	if(tmp[0] != 'W' || tmp[1] != 'A' || tmp[2] != 'V' || tmp[3] != 'E') {
-		fclose(fp);
-		printf("%c%c%c%c\n", tmp[0], tmp[1], tmp[2], tmp[3]);
-		throw Exception("WavSound::WavSound(): Invalid file [2]");
-	}
-
-    // read fmt header
-	fread(&hdr, sizeof(hdr), 1, fp);
-	hdr.chunk_size = LittleToNativeUInt32(hdr.chunk_size);
-	if(hdr.chunk_id[0] != 'f' || hdr.chunk_id[1] != 'm' ||
-	   hdr.chunk_id[2] != 't' || hdr.chunk_id[3] != ' ') {
+	WavFmtChunk fmt;
+	Channel channels[MAX_CHANNELS];
+	try {
+		WavReadHeader(fp, fmt, m_format, m_dataSize, channels);
+	} catch(Exception ex) {
 		fclose(fp);
-		throw Exception("WavSound::WavSound(): Invalid file [3]");
+		throw;
 	}
 
-	// read fmt chunk
-	WavFmtChunk fmt;
-	fread(&fmt, sizeof(fmt), 1, fp);
-	fmt.type = LittleToNativeUInt16(fmt.type);
-	fmt.channels = LittleToNativeUInt16(fmt.channels);
-	fmt.rate = LittleToNativeUInt16(fmt.rate);
-	fmt.bytes_per_second = LittleToNativeUInt16(fmt.bytes_per_second);
-	fmt.block_align = LittleToNativeUInt16(fmt.block_align);
-	fmt.bits_per_sample = LittleToNativeUInt16(fmt.bits_per_sample);
-
-	// make sure the compression type is supported
-    if(fmt.type != 1) {
-        fclose(fp);
-        throw Exception("WavSound::WavSound(): Unsupported compression type; only uncompressed PCM is supported");
-    }
-
 	m_numChannels = fmt.channels;
-	m_bytesPerSample = fmt.bits_per_sample / 8;
+	m_bytesPerSample = (unsigned char)SampleFormatGetSize(m_format);
 	m_sampleRate = fmt.rate;
+	setChannelLayout(channels, (m_numChannels < MAX_CHANNELS) ? m_numChannels : MAX_CHANNELS);
 
-	// look for data chunk
-	bool dataFound = false;
-	while(fread(&hdr, sizeof(hdr), 1, fp) == 1) {
-		hdr.chunk_size = LittleToNativeUInt32(hdr.chunk_size);
-
-		if(hdr.chunk_id[0] == 'd' && hdr.chunk_id[1] == 'a' &&
-		   hdr.chunk_id[2] == 't' && hdr.chunk_id[3] == 'a') {
-			dataFound = true;
-			break;
-		} else {
-			if(fseek(fp, hdr.chunk_size, SEEK_CUR) != 0)
-				break;
-		}
-	}
+	long dataOffset = ftell(fp);
 
-	if(!dataFound) {
+	// the data can be used straight from a mapping of the file if it's
+	// already in native byte order and aligned for the sample size
+	bool native = (m_bytesPerSample == 1 || m_format == SAMPLE_FORMAT_INT24 || GetEndianness() == ENDIANNESS_LITTLE);
+	m_file = NULL;
+	if(mapped && dataOffset >= 0 && (dataOffset % m_bytesPerSample) == 0 && native) {
 		fclose(fp);
-		throw Exception("WavSound::WavSound(): No data chunk found");
-	}
+		m_file = MappedFile::create(filename);
 
-	m_dataSize = hdr.chunk_size;
-	m_numSamples = m_dataSize / m_numChannels / m_bytesPerSample;
+		// truncated files have less data than the header says
+		size_t available = 0;
+		if(m_file->getSize() > (size_t)dataOffset)
+			available = m_file->getSize() - (size_t)dataOffset;
+		if(m_dataSize > available)
+			m_dataSize = (uint32_t)available;
 
-	// read data chunk
-	m_data = new uint8_t [m_dataSize];
-	fread(m_data, sizeof(uint8_t), m_dataSize, fp);
+		m_data = m_file->getData() + dataOffset;
+	} else {
+		// read data chunk
+		uint8_t *data = new uint8_t [m_dataSize];
+		m_dataSize = (uint32_t)fread(data, sizeof(uint8_t), m_dataSize, fp);
+		m_data = data;
 
-	// done
-	fclose(fp);
+		// done
+		fclose(fp);
 
-	// do byte-swapping if necessary
-	if(m_bytesPerSample == 2) {
-		int16_t *data = (int16_t *)m_data;
-		for(unsigned int i = 0; i < m_dataSize / 2; i++)
-			data[i] = LittleToNativeInt16(data[i]);
+		// do byte-swapping if necessary
+		WavToNative(data, m_format, m_dataSize);
 	}
+
+	m_numSamples = m_dataSize / m_numChannels / m_bytesPerSample;
 }
 
 WavSound::~WavSound()
 {
-	delete [] m_data;
+	if(m_file)
+		delete m_file;
+	else
+		delete [] m_data;
 }
 
 unsigned char
@@ -153,30 +115,71 @@ WavSound::getNumSamples() const
 	return m_numSamples;
 }
 
+size_t
+WavSound::getDataSize() const
+{
+	return m_dataSize;
+}
+
 Sample
 WavSound::getSample(unsigned int index) const
 {
-	Sample sample;
+	index %= m_numSamples;
+
+	const uint8_t *data = m_data + (size_t)index * m_numChannels * m_bytesPerSample;
+	return Sample::fromFormat(data, m_format, m_numChannels, getChannelLayout());
+}
 
+void
+WavSound::getSamples(unsigned int index, Sample *samples, unsigned int numSamples) const
+{
 	index %= m_numSamples;
 
-	if(m_bytesPerSample == 2) {
-		int16_t *data = ((int16_t *)m_data) + (index * m_numChannels);
-		sample = Sample::fromInt16(data, m_numChannels);
-	} else if(m_bytesPerSample == 1) {
-		int8_t *data = ((int8_t *)m_data) + (index * m_numChannels);
-		sample = Sample::fromInt8(data, m_numChannels);
-	} else {
-		throw Exception("WavSound::getSample(): Unsupported number of bytes per sample (%u)", m_bytesPerSample);
+	while(numSamples != 0) {
+		// copy as many samples as possible before wrapping around
+		unsigned int count = m_numSamples - index;
+		if(count > numSamples)
+			count = numSamples;
+
+		const uint8_t *data = m_data + (size_t)index * m_numChannels * m_bytesPerSample;
+		Sample::fromFormat(data, m_format, m_numChannels, samples, count, getChannelLayout());
+
+		samples += count;
+		numSamples -= count;
+		index = 0;
 	}
+}
 
-	return sample;
+void
+WavSound::getPlanarSamples(unsigned int index, SampleBuffer &buffer, unsigned int offset, unsigned int numSamples) const
+{
+	index %= m_numSamples;
+
+	while(numSamples != 0) {
+		// copy as many samples as possible before wrapping around
+		unsigned int count = m_numSamples - index;
+		if(count > numSamples)
+			count = numSamples;
+
+		const uint8_t *data = m_data + (size_t)index * m_numChannels * m_bytesPerSample;
+		Sample::fromFormat(data, m_format, m_numChannels, buffer, offset, count);
+
+		offset += count;
+		numSamples -= count;
+		index = 0;
+	}
+}
+
+bool
+WavSound::isMapped() const
+{
+	return (m_file != NULL);
 }
 
 WavSoundPtr
-WavSound::create(const char *filename)
+WavSound::create(const char *filename, bool mapped)
 {
-	return WavSoundPtr(new WavSound(filename));
+	return WavSoundPtr(new WavSound(filename, mapped));
 }
 
 } // namespace DromeAudio
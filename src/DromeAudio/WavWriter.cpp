@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <DromeAudio/Endian.h>
+#include <DromeAudio/Exception.h>
+#include "Mix.h"
+#include "Wav.h"
+#include "WavWriter.h"
+
+namespace DromeAudio {
+
+// number of values converted at a time by write()
+static const unsigned int BLOCK_SIZE = 4096;
+
+// size of the stdio buffer, so that blocks are written
+// to the file in large pieces
+static const size_t FILE_BUFFER_SIZE = 256 * 1024;
+
+// the ds64 chunk written to RF64 files, which a JUNK chunk of
+// the same size reserves space for at the start of every file
+struct WavDs64Chunk {
+	uint32_t riff_size_low;
+	uint32_t riff_size_high;
+	uint32_t data_size_low;
+	uint32_t data_size_high;
+	uint32_t sample_count_low;
+	uint32_t sample_count_high;
+	uint32_t table_length;
+};
+
+static const long RIFF_HEADER_OFFSET = 0;
+static const long DS64_HEADER_OFFSET = 12;
+static const long FMT_HEADER_OFFSET = DS64_HEADER_OFFSET + sizeof(WavChunkHeader) + sizeof(WavDs64Chunk);
+static const long DATA_HEADER_OFFSET = FMT_HEADER_OFFSET + sizeof(WavChunkHeader) + sizeof(WavFmtChunk);
+static const long DATA_OFFSET = DATA_HEADER_OFFSET + sizeof(WavChunkHeader);
+
+static void
+writeChunkHeader(FILE *fp, const char *id, uint32_t size)
+{
+	WavChunkHeader hdr;
+	memcpy(hdr.chunk_id, id, 4);
+	hdr.chunk_size = NativeToLittleUInt32(size);
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+}
+
+/*
+ * WavWriter class
+ */
+WavWriter::WavWriter(const char *filename, unsigned int sampleRate, unsigned int numChannels, SampleFormat format, bool dither)
+{
+	if(format != SAMPLE_FORMAT_INT16 && format != SAMPLE_FORMAT_INT24 && format != SAMPLE_FORMAT_FLOAT32)
+		throw Exception("WavWriter::WavWriter(): Unsupported sample format (%d)", (int)format);
+
+	m_numChannels = numChannels;
+	m_format = format;
+	m_dataSize = 0;
+
+	m_dither = dither && (format != SAMPLE_FORMAT_FLOAT32);
+	m_ditherState = 1;
+
+	m_fp = fopen(filename, "wb");
+	if(!m_fp)
+		throw Exception("WavWriter::WavWriter(): Unable to open %s for writing", filename);
+	setvbuf(m_fp, NULL, _IOFBF, FILE_BUFFER_SIZE);
+
+	writeHeader(sampleRate);
+}
+
+WavWriter::~WavWriter()
+{
+	close();
+}
+
+void
+WavWriter::writeHeader(unsigned int sampleRate)
+{
+	const unsigned int bytesPerSample = SampleFormatGetSize(m_format);
+
+	// write riff header; the chunk sizes are
+	// written again once the data is done
+	writeChunkHeader(m_fp, "RIFF", (uint32_t)(DATA_OFFSET - 8));
+
+	// write riff type
+	char tmp[4];
+	tmp[0] = 'W'; tmp[1] = 'A'; tmp[2] = 'V'; tmp[3] = 'E';
+	fwrite(tmp, 4, 1, m_fp);
+
+	// reserve space for a ds64 chunk
+	WavDs64Chunk ds64;
+	memset(&ds64, 0, sizeof(ds64));
+	writeChunkHeader(m_fp, "JUNK", sizeof(ds64));
+	fwrite(&ds64, sizeof(ds64), 1, m_fp);
+
+	// write fmt chunk
+	writeChunkHeader(m_fp, "fmt ", sizeof(WavFmtChunk));
+
+	WavFmtChunk fmt;
+	fmt.type = NativeToLittleUInt16((m_format == SAMPLE_FORMAT_FLOAT32) ? WAV_FORMAT_IEEE_FLOAT : WAV_FORMAT_PCM);
+	fmt.channels = NativeToLittleUInt16((uint16_t)m_numChannels);
+	fmt.rate = NativeToLittleUInt32(sampleRate);
+	fmt.bytes_per_second = NativeToLittleUInt32(bytesPerSample * m_numChannels * sampleRate);
+	fmt.block_align = NativeToLittleUInt16((uint16_t)(bytesPerSample * m_numChannels));
+	fmt.bits_per_sample = NativeToLittleUInt16((uint16_t)(bytesPerSample * 8));
+	fwrite(&fmt, sizeof(fmt), 1, m_fp);
+
+	// write data header
+	writeChunkHeader(m_fp, "data", 0);
+}
+
+void
+WavWriter::write(const float *samples, unsigned int numSamples)
+{
+	if(!m_fp)
+		throw Exception("WavWriter::write(): File is closed");
+
+	float dithered[BLOCK_SIZE];
+	uint8_t buffer[BLOCK_SIZE * 4];
+	unsigned int bytesPerSample = SampleFormatGetSize(m_format);
+	unsigned int count = numSamples * m_numChannels;
+	bool bigEndian = (GetEndianness() == ENDIANNESS_BIG);
+
+	for(unsigned int offset = 0; offset < count; offset += BLOCK_SIZE) {
+		unsigned int n = count - offset;
+		if(n > BLOCK_SIZE)
+			n = BLOCK_SIZE;
+
+		const float *src = samples + offset;
+		if(m_dither) {
+			float lsb = (m_format == SAMPLE_FORMAT_INT24) ? (1.0f / 8388607.0f) : (1.0f / 32767.0f);
+			memcpy(dithered, src, n * sizeof(float));
+			MixAddTriangularNoise(dithered, n, lsb, m_ditherState);
+			src = dithered;
+		}
+
+		if(m_format == SAMPLE_FORMAT_INT16) {
+			int16_t *values = (int16_t *)buffer;
+			MixFloatToInt16(values, src, n);
+			if(bigEndian) {
+				for(unsigned int i = 0; i < n; i++)
+					values[i] = NativeToLittleInt16(values[i]);
+			}
+		} else if(m_format == SAMPLE_FORMAT_INT24) {
+			MixFloatToInt24(buffer, src, n);
+		} else {
+			float *values = (float *)buffer;
+			memcpy(values, src, n * sizeof(float));
+			if(bigEndian) {
+				for(unsigned int i = 0; i < n; i++)
+					values[i] = NativeToLittleFloat(values[i]);
+			}
+		}
+
+		if(fwrite(buffer, bytesPerSample, n, m_fp) != n)
+			throw Exception("WavWriter::write(): fwrite failed");
+	}
+
+	m_dataSize += (uint64_t)count * bytesPerSample;
+}
+
+void
+WavWriter::close()
+{
+	if(!m_fp)
+		return;
+
+	// chunks are padded to an even size
+	if(m_dataSize & 1)
+		fputc(0, m_fp);
+
+	uint64_t riffSize = (DATA_OFFSET - 8) + m_dataSize + (m_dataSize & 1);
+	if(riffSize <= 0xffffffff) {
+		// fill in the lengths of the riff and data chunks
+		fseek(m_fp, RIFF_HEADER_OFFSET, SEEK_SET);
+		writeChunkHeader(m_fp, "RIFF", (uint32_t)riffSize);
+		fseek(m_fp, DATA_HEADER_OFFSET, SEEK_SET);
+		writeChunkHeader(m_fp, "data", (uint32_t)m_dataSize);
+	} else {
+		// too large for a riff file, so turn it into an rf64 file,
+		// where the lengths are given by the ds64 chunk instead
+		uint64_t sampleCount = m_dataSize / (SampleFormatGetSize(m_format) * m_numChannels);
+
+		WavDs64Chunk ds64;
+		ds64.riff_size_low = NativeToLittleUInt32((uint32_t)riffSize);
+		ds64.riff_size_high = NativeToLittleUInt32((uint32_t)(riffSize >> 32));
+		ds64.data_size_low = NativeToLittleUInt32((uint32_t)m_dataSize);
+		ds64.data_size_high = NativeToLittleUInt32((uint32_t)(m_dataSize >> 32));
+		ds64.sample_count_low = NativeToLittleUInt32((uint32_t)sampleCount);
+		ds64.sample_count_high = NativeToLittleUInt32((uint32_t)(sampleCount >> 32));
+		ds64.table_length = 0;
+
+		fseek(m_fp, RIFF_HEADER_OFFSET, SEEK_SET);
+		writeChunkHeader(m_fp, "RF64", 0xffffffff);
+		fseek(m_fp, DS64_HEADER_OFFSET, SEEK_SET);
+		writeChunkHeader(m_fp, "ds64", sizeof(ds64));
+		fwrite(&ds64, sizeof(ds64), 1, m_fp);
+		fseek(m_fp, DATA_HEADER_OFFSET, SEEK_SET);
+		writeChunkHeader(m_fp, "data", 0xffffffff);
+	}
+
+	fclose(m_fp);
+	m_fp = NULL;
+}
+
+} // namespace DromeAudio
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2008-2012 Josh A. Beam
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DROMEAUDIO_WAVWRITER_H__
+#define __DROMEAUDIO_WAVWRITER_H__
+
+#include <cstdio>
+#include <stdint.h>
+#include <DromeAudio/SampleFormat.h>
+
+namespace DromeAudio {
+
+/*
+ * Writes 16-bit, 24-bit or floating point WAV files one block of
+ * samples at a time. The lengths in the RIFF and data chunk headers are
+ * filled in when the file is closed, so the number of samples doesn't
+ * need to be known up front. Files whose data passes 4 GB are written
+ * as RF64, using the space reserved for its ds64 chunk by a JUNK chunk
+ * at the start of the file.
+ */
+class WavWriter
+{
+	protected:
+		FILE *m_fp;
+		unsigned int m_numChannels;
+		SampleFormat m_format;
+		uint64_t m_dataSize;
+
+		bool m_dither;
+		uint32_t m_ditherState;
+
+		void writeHeader(unsigned int sampleRate);
+
+	public:
+		/**
+		 * @param format Format to write the samples in: SAMPLE_FORMAT_INT16, SAMPLE_FORMAT_INT24 or SAMPLE_FORMAT_FLOAT32.
+		 * @param dither True to add TPDF dither of 1 LSB before converting to an integer format.
+		 */
+		WavWriter(const char *filename, unsigned int sampleRate, unsigned int numChannels, SampleFormat format = SAMPLE_FORMAT_INT16, bool dither = false);
+		~WavWriter();
+
+		/**
+		 * Writes interleaved floating point samples. Integer formats saturate values outside of [-1, 1].
+		 * @param samples Interleaved samples, numSamples * numChannels floats in length.
+		 */
+		void write(const float *samples, unsigned int numSamples);
+
+		/**
+		 * Updates the chunk lengths and closes the file. Called by the destructor if it hasn't been already.
+		 */
+		void close();
+};
+
+} // namespace DromeAudio
+
+#endif /* __DROMEAUDIO_WAVWRITER_H__ */